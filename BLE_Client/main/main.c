@@ -1,6 +1,5 @@
 #include <stdio.h>
 #include <string.h>
-#include <inttypes.h>
 #include "nvs_flash.h"
 #include "esp_nimble_hci.h"
 #include "nimble/nimble_port.h"
@@ -9,19 +8,19 @@
 #include "host/ble_hs_adv.h"
 #include "host/util/util.h"
 #include "services/gap/ble_svc_gap.h"
+#include "binlog.h"
+#include "log_formats.h"
 
 // Forward declarations
 static void start_scan(void);
 static int gap_event_cb(struct ble_gap_event *event, void *arg);
-static void rescan_task(void *arg);
 static int discover_services(uint16_t conn_handle);
-static void print_uuid(const ble_uuid_any_t *uuid);
+static void log_uuid(uint16_t fmt, const ble_uuid_any_t *uuid);
 static const char *chr_props_to_str(uint8_t props);
 static int read_characteristic(uint16_t conn_handle, uint16_t val_handle);
 static int subscribe_to_notifications(uint16_t conn_handle, uint16_t val_handle, uint16_t ccc_handle);
 static int on_notify(uint16_t conn_handle, const struct ble_gatt_error *error,
                     struct ble_gatt_attr *attr, void *arg);
-static void periodic_read_task(void *arg);
 
 // Target device address to connect to
 static const uint8_t TARGET_ADDR[6] = {0xa6, 0x32, 0x0e, 0xe3, 0x85, 0xa0}; // a0:85:e3:0e:32:a6 in little-endian
@@ -31,47 +30,75 @@ static uint16_t conn_handle = BLE_HS_CONN_HANDLE_NONE;
 // Scan parameters
 static uint8_t own_addr_type;
 
-// Convert BLE address to string
-static char* addr_str(const void *addr)
-{
-    static char buf[6 * 2 + 5 + 1];
-    const uint8_t *u8p = addr;
-    
-    sprintf(buf, "%02x:%02x:%02x:%02x:%02x:%02x",
-            u8p[5], u8p[4], u8p[3], u8p[2], u8p[1], u8p[0]);
-    
-    return buf;
-}
+// The BLE callbacks below log through the binary log, so a slow console
+// never holds up the host task; see log_formats.h
+static const char *const log_formats[] = { CLIENT_LOG_FORMATS(BINLOG_FORMAT_STR) };
+
+// Scanning runs continuously. The controller's duplicate filter only
+// forgets a device when a scan starts, so a timer restarts the scan every
+// SCAN_DUP_RESET_MS to print each advertiser again. Pauses before
+// scanning again are timers too, so the host task never sleeps inside a
+// GAP event.
+#define SCAN_DUP_RESET_MS     10000
+#define SCAN_RESTART_DELAY_MS 1000
+
+static struct ble_npl_callout scan_dup_timer;
+static struct ble_npl_callout scan_restart_timer;
+static bool scan_active = false;
+
+// While connected the sensor is also read every PERIODIC_READ_MS, from a
+// callout on the host task like the scan timers
+#define PERIODIC_READ_MS     3000
+#define SENSOR_VALUE_HANDLE  0x0022
+
+static struct ble_npl_callout read_timer;
 
 // Print advertising data (simplified to show only name and MAC)
 static void print_adv_data(const struct ble_hs_adv_fields *fields, const uint8_t *addr)
 {
-    // Print MAC address
-    printf("MAC: %s ", addr_str(addr));
-    
-    // Print device name if available
+    // MAC address and device name if available (not NUL terminated)
     if (fields->name != NULL) {
-        printf(" | Name: %s", fields->name);
+        BINLOG_BLOB(LOG_ADV_REPORT, fields->name, fields->name_len, LOG_ADDR_ARGS(addr));
     } else {
-        printf(" | Name: (unknown)");
+        BINLOG_BLOB(LOG_ADV_REPORT, "(unknown)", 9, LOG_ADDR_ARGS(addr));
     }
-    
-    printf("\n");
+}
+
+// ==== Scan Timers ====
+// All run in the host task, like the GAP events
+static void scan_dup_reset_cb(struct ble_npl_event *ev)
+{
+    // A connection attempt has the radio; start_scan() rearms the timer
+    if (!scan_active) {
+        return;
+    }
+    ble_gap_disc_cancel();
+    scan_active = false;
+    start_scan();
+}
+
+static void scan_restart_cb(struct ble_npl_event *ev)
+{
+    start_scan();
+}
+
+// Scan again after SCAN_RESTART_DELAY_MS
+static void schedule_rescan(void)
+{
+    ble_npl_callout_reset(&scan_restart_timer, ble_npl_time_ms_to_ticks32(SCAN_RESTART_DELAY_MS));
 }
 
 // Function to connect to a BLE device
 static void connect_to_device(const ble_addr_t *addr) {
-    printf("Attempting to connect to %s...\n", addr_str(addr->val));
+    BINLOG(LOG_CONNECTING, LOG_ADDR_ARGS(addr->val));
     
-    // First, stop any ongoing scan
+    // First, stop any ongoing scan (returns once the controller has)
     int rc = ble_gap_disc_cancel();
     if (rc != 0 && rc != BLE_HS_EALREADY) {
-        printf("Error stopping scan: %d\n", rc);
+        BINLOG(LOG_SCAN_STOP_FAIL, rc);
         return;
     }
-    
-    // Small delay to ensure scan is fully stopped
-    vTaskDelay(pdMS_TO_TICKS(100));
+    scan_active = false;
     
     struct ble_gap_conn_params conn_params = {
         .scan_itvl = 0x60,
@@ -88,24 +115,12 @@ static void connect_to_device(const ble_addr_t *addr) {
     rc = ble_gap_connect(own_addr_type, addr, 30000, &conn_params, 
                         gap_event_cb, NULL);
     if (rc != 0) {
-        printf("Error: Failed to connect to device: %d. Will retry...\n", rc);
-        // Schedule a rescan after a delay using a static function
-        static TaskHandle_t rescan_task_handle = NULL;
-        if (rescan_task_handle == NULL) {  // Only create if not already running
-            xTaskCreatePinnedToCore(
-                rescan_task,
-                "rescan_task",
-                2048,
-                NULL,
-                5,
-                &rescan_task_handle,
-                0
-            );
-        }
+        BINLOG(LOG_CONNECT_FAIL, rc);
+        schedule_rescan();
         return;
     }
     
-    printf("Connection initiated...\n");
+    BINLOG(LOG_CONNECT_STARTED);
 }
 
 // Called when an advertisement is received
@@ -129,7 +144,7 @@ static int gap_event_cb(struct ble_gap_event *event, void *arg)
         
         // Check if this is our target device
         if (memcmp(event->disc.addr.val, TARGET_ADDR, 6) == 0 && !device_connected) {
-            printf("Target device found! Attempting to connect...\n");
+            BINLOG(LOG_TARGET_FOUND);
             connect_to_device(&event->disc.addr);
             // Don't set device_connected yet - wait for connection success
         }
@@ -139,53 +154,38 @@ static int gap_event_cb(struct ble_gap_event *event, void *arg)
         // A new connection was established or a connection attempt failed
         if (event->connect.status == 0) {
             // Connection successful
-            printf("Connection established. Connection handle: %d\n", event->connect.conn_handle);
+            BINLOG(LOG_CONNECTED, event->connect.conn_handle);
             conn_handle = event->connect.conn_handle;
             device_connected = true; // Only set this on successful connection
+            ble_npl_callout_reset(&read_timer, ble_npl_time_ms_to_ticks32(PERIODIC_READ_MS));
             
-            // Start service discovery
-            printf("Starting service discovery...\n");
-            int rc = discover_services(conn_handle);
-            if (rc != 0) {
-                printf("Failed to start service discovery: %d\n", rc);
-            }
+            // Start service discovery (logs its own failure)
+            discover_services(conn_handle);
         } else {
             // Connection attempt failed
-            printf("Error: Connection failed, status: %d\n", event->connect.status);
+            BINLOG(LOG_CONNECT_ERROR, event->connect.status);
             device_connected = false; // Allow reconnection attempt
             // Restart scanning after a short delay
-            vTaskDelay(pdMS_TO_TICKS(1000));
-            start_scan();
+            schedule_rescan();
         }
         break;
         
     case BLE_GAP_EVENT_DISCONNECT:
         // Handle disconnection
-        printf("Disconnected. Reason: %d\n", event->disconnect.reason);
+        BINLOG(LOG_DISCONNECTED, event->disconnect.reason);
         device_connected = false;
         conn_handle = BLE_HS_CONN_HANDLE_NONE;
         // Restart scanning after a short delay
-        vTaskDelay(pdMS_TO_TICKS(1000));
-        start_scan();
+        schedule_rescan();
         break;
         
     case BLE_GAP_EVENT_DISC_COMPLETE:
+        // Scanning runs until cancelled; if the stack ends it anyway,
+        // pick it straight back up
+        scan_active = false;
         if (!device_connected) {
-            printf("\nScan complete. Waiting before next scan...\n");
-            
-            // Add a delay before restarting scan
-            vTaskDelay(pdMS_TO_TICKS(2000));
-            
-            // Restart scanning with same parameters
-            struct ble_gap_disc_params disc_params = {
-                .itvl = 0x60,
-                .window = 0x30,
-                .filter_policy = 0,
-                .limited = 0,
-                .passive = 0,
-                .filter_duplicates = 1,
-            };
-            ble_gap_disc(own_addr_type, 3000, &disc_params, gap_event_cb, NULL);
+            BINLOG(LOG_SCAN_ENDED, event->disc_complete.reason);
+            start_scan();
         }
         break;
         
@@ -196,22 +196,22 @@ static int gap_event_cb(struct ble_gap_event *event, void *arg)
     return 0;
 }
 
-// Convert BLE UUID to string
-static void print_uuid(const ble_uuid_any_t *uuid) {
+// Log a BLE UUID. fmt is the first of four formats in a row: 16, 32 and
+// 128 bit, then unknown type (see log_formats.h)
+static void log_uuid(uint16_t fmt, const ble_uuid_any_t *uuid) {
     switch (uuid->u.type) {
         case BLE_UUID_TYPE_16:
-            printf("0x%04" PRIx16, BLE_UUID16(uuid)->value);
+            BINLOG(fmt, BLE_UUID16(uuid)->value);
             break;
         case BLE_UUID_TYPE_32:
-            printf("0x%08" PRIx32, BLE_UUID32(uuid)->value);
+            BINLOG(fmt + 1, BLE_UUID32(uuid)->value);
             break;
         case BLE_UUID_TYPE_128:
-            printf("0x%02" PRIx8 "%02" PRIx8 "...%02" PRIx8 "%02" PRIx8,
-                   uuid->u128.value[15], uuid->u128.value[14],
+            BINLOG(fmt + 2, uuid->u128.value[15], uuid->u128.value[14],
                    uuid->u128.value[1], uuid->u128.value[0]);
             break;
         default:
-            printf("(unknown type %d)", uuid->u.type);
+            BINLOG(fmt + 3, uuid->u.type);
             break;
     }
 }
@@ -244,38 +244,34 @@ static int on_notify(uint16_t conn_handle, const struct ble_gatt_error *error,
                    struct ble_gatt_attr *attr, void *arg) {
     if (error != NULL) {
         if (error->status != 0) {
-            printf("Notification error: %d\n", error->status);
+            BINLOG(LOG_NOTIFY_ERROR, error->status);
             return error->status;
         }
     }
 
     if (attr == NULL) {
-        printf("Notification received: NULL attribute\n");
+        BINLOG(LOG_NOTIFY_NULL);
         return 0;
     }
 
-    printf("Notification received (handle=0x%04x): ", attr->handle);
-    
     if (attr->om != NULL) {
-        // Print all bytes
-        for (int i = 0; i < attr->om->om_len && i < 32; i++) {  // Limit to first 32 bytes
-            printf("%02x ", attr->om->om_data[i]);
-        }
-        printf("(%d bytes)\n", attr->om->om_len);
+        // Dump the first 32 bytes
+        BINLOG_BLOB(LOG_NOTIFY_DATA, attr->om->om_data, attr->om->om_len < 32 ? attr->om->om_len : 32,
+                    attr->handle, attr->om->om_len);
         
         // Check if this is the 0x0022 handle and has at least 1 byte of data
-        if (attr->handle == 0x0022 && attr->om->om_len >= 1) {
+        if (attr->handle == SENSOR_VALUE_HANDLE && attr->om->om_len >= 1) {
             uint8_t first_byte = attr->om->om_data[0];
-            printf("First byte (decimal): %u\n", first_byte);
+            BINLOG(LOG_SENSOR_VALUE, first_byte);
             
             if (first_byte < 40) {
-                printf("ALCOHOL DETECTED! (Value: %u < 40)\n", first_byte);
+                BINLOG(LOG_ALCOHOL, first_byte);
             } else {
-                printf("No alcohol detected (Value: %u >= 40)\n", first_byte);
+                BINLOG(LOG_NO_ALCOHOL, first_byte);
             }
         }
     } else {
-        printf("No data\n");
+        BINLOG(LOG_NOTIFY_EMPTY, attr->handle);
     }
     
     return 0;
@@ -283,10 +279,10 @@ static int on_notify(uint16_t conn_handle, const struct ble_gatt_error *error,
 
 // Read characteristic value
 static int read_characteristic(uint16_t conn_handle, uint16_t val_handle) {
-    printf("Reading characteristic value from handle 0x%04x...\n", val_handle);
+    BINLOG(LOG_READING, val_handle);
     int rc = ble_gattc_read(conn_handle, val_handle, on_notify, NULL);
     if (rc != 0) {
-        printf("Failed to read characteristic: %d\n", rc);
+        BINLOG(LOG_READ_FAIL, rc);
     }
     return rc;
 }
@@ -294,13 +290,13 @@ static int read_characteristic(uint16_t conn_handle, uint16_t val_handle) {
 
 // Subscribe to notifications
 static int subscribe_to_notifications(uint16_t conn_handle, uint16_t val_handle, uint16_t ccc_handle) {
-    printf("Subscribing to notifications for handle 0x%04x (CCCD: 0x%04x)...\n", val_handle, ccc_handle);
+    BINLOG(LOG_SUBSCRIBING, val_handle, ccc_handle);
     
     // Write to CCCD to enable notifications (0x0001) or indications (0x0002)
     uint16_t cccd_val = 0x0001;  // 0x0001 for notifications, 0x0002 for indications
     int rc = ble_gattc_write_flat(conn_handle, ccc_handle, &cccd_val, sizeof(cccd_val), on_notify, NULL);
     if (rc != 0) {
-        printf("Failed to write to CCCD: %d\n", rc);
+        BINLOG(LOG_CCCD_FAIL, rc);
         return rc;
     }
     
@@ -313,27 +309,23 @@ static int disc_svc_chrs_cb(uint16_t conn_handle, const struct ble_gatt_error *e
     (void)arg;  // Unused parameter
     
     if (error->status == BLE_HS_EDONE) {
-        printf("  Characteristics discovery complete\n");
+        BINLOG(LOG_CHR_DONE);
         return 0;
     }
     
     if (error->status != 0) {
-        printf("  Characteristic discovery failed: %d\n", error->status);
+        BINLOG(LOG_CHR_ERROR, error->status);
         return error->status;
     }
     
-    printf("  Characteristic: handle=0x%04x, def_handle=0x%04x, val_handle=0x%04x, props=",
-           chr->val_handle - 1, chr->def_handle, chr->val_handle);
-    printf("%s\n", chr_props_to_str(chr->properties));
-    
-    printf("    UUID: ");
-    print_uuid((const ble_uuid_any_t *)&chr->uuid);
-    printf("\n");
+    const char *props = chr_props_to_str(chr->properties);
+    BINLOG_BLOB(LOG_CHR_FOUND, props, strlen(props),
+                chr->val_handle - 1, chr->def_handle, chr->val_handle);
+    log_uuid(LOG_CHR_UUID16, (const ble_uuid_any_t *)&chr->uuid);
     
     // Check if this is from the last service (0x4444...0000)
     if (chr->def_handle >= 0x0020) {
-        printf("\n=== Found target characteristic in last service ===\n");
-        printf("Handle: 0x%04x, Properties: %s\n", chr->val_handle, chr_props_to_str(chr->properties));
+        BINLOG_BLOB(LOG_CHR_TARGET, props, strlen(props), chr->val_handle);
         
         // If it supports READ, read its value
         if (chr->properties & BLE_GATT_CHR_PROP_READ) {
@@ -354,27 +346,23 @@ static int disc_svc_chrs_cb(uint16_t conn_handle, const struct ble_gatt_error *e
 static int disc_svc_cb(uint16_t conn_handle, const struct ble_gatt_error *error,
                       const struct ble_gatt_svc *service, void *arg) {
     if (error->status == BLE_HS_EDONE) {
-        printf("Service discovery complete\n");
+        BINLOG(LOG_SVC_DONE);
         return 0;
     }
     
     if (error->status != 0) {
-        printf("Service discovery failed: %d\n", error->status);
+        BINLOG(LOG_SVC_ERROR, error->status);
         return error->status;
     }
     
-    printf("\nService found: start_handle=0x%04x, end_handle=0x%04x\n",
-           service->start_handle, service->end_handle);
-    
-    printf("  UUID: ");
-    print_uuid((const ble_uuid_any_t *)&service->uuid);
-    printf("\n");
+    BINLOG(LOG_SVC_FOUND, service->start_handle, service->end_handle);
+    log_uuid(LOG_SVC_UUID16, (const ble_uuid_any_t *)&service->uuid);
     
     // Discover characteristics for this service
     int rc = ble_gattc_disc_all_chrs(conn_handle, service->start_handle, 
                                     service->end_handle, disc_svc_chrs_cb, NULL);
     if (rc != 0) {
-        printf("Failed to discover characteristics: %d\n", rc);
+        BINLOG(LOG_CHR_DISC_FAIL, rc);
         return rc;
     }
     
@@ -383,34 +371,26 @@ static int disc_svc_cb(uint16_t conn_handle, const struct ble_gatt_error *error,
 
 // Start service discovery
 static int discover_services(uint16_t conn_handle) {
-    printf("Discovering services...\n");
+    BINLOG(LOG_SVC_DISC_START);
     
     // Start discovering all services
     int rc = ble_gattc_disc_all_svcs(conn_handle, disc_svc_cb, NULL);
     if (rc != 0) {
-        printf("Failed to start service discovery: %d\n", rc);
+        BINLOG(LOG_SVC_DISC_FAIL, rc);
         return rc;
     }
     
     return 0;
 }
 
-// Task to handle rescan after delay
-static void rescan_task(void *arg) {
-    vTaskDelay(pdMS_TO_TICKS(1000));
-    start_scan();
-    vTaskDelete(NULL);
-}
-
-// Task to periodically read the characteristic
-static void periodic_read_task(void *arg) {
-    while (1) {
-        if (device_connected && conn_handle != BLE_HS_CONN_HANDLE_NONE) {
-            printf("\n[Periodic Read] ");
-            read_characteristic(conn_handle, 0x0022);  // Read handle 0x0022
-        }
-        vTaskDelay(3000 / portTICK_PERIOD_MS);  // 3 second delay
+// Read the sensor every PERIODIC_READ_MS until the connection drops
+static void read_timer_cb(struct ble_npl_event *ev)
+{
+    if (!device_connected || conn_handle == BLE_HS_CONN_HANDLE_NONE) {
+        return;
     }
+    read_characteristic(conn_handle, SENSOR_VALUE_HANDLE);
+    ble_npl_callout_reset(&read_timer, ble_npl_time_ms_to_ticks32(PERIODIC_READ_MS));
 }
 
 // Start BLE scanning
@@ -426,15 +406,22 @@ void start_scan(void)
         .filter_duplicates = 1,  // Filter duplicates to reduce output
     };
     
-    // Start scanning
-    int rc = ble_gap_disc(own_addr_type, 3000, &disc_params,  // Scan for 3 seconds
+    // Scan until a connection attempt cancels it
+    int rc = ble_gap_disc(own_addr_type, BLE_HS_FOREVER, &disc_params,
                          gap_event_cb, NULL);
     if (rc != 0) {
-        printf("Error starting scan: %d\n", rc);
+        BINLOG(LOG_SCAN_START_FAIL, rc);
+        if (rc != BLE_HS_EALREADY) {
+            schedule_rescan();
+        }
         return;
     }
+    scan_active = true;
     
-    printf("Scanning for BLE devices...\n");
+    // Clear the duplicate filter every SCAN_DUP_RESET_MS
+    ble_npl_callout_reset(&scan_dup_timer, ble_npl_time_ms_to_ticks32(SCAN_DUP_RESET_MS));
+    
+    BINLOG(LOG_SCAN_STARTED);
 }
 
 // Called when BLE host task starts
@@ -450,12 +437,12 @@ static void ble_host_task(void *param)
 // Application callback for BLE host sync
 static int ble_app_on_sync(void)
 {
-    printf("BLE: Host sync started\n");
+    BINLOG(LOG_HOST_SYNC);
     
     // Figure out address to use
     int rc = ble_hs_util_ensure_addr(0);
     if (rc != 0) {
-        printf("BLE: Failed to ensure address: %d\n", rc);
+        BINLOG(LOG_ADDR_FAIL, rc);
         return rc;
     }
     
@@ -463,14 +450,13 @@ static int ble_app_on_sync(void)
     uint8_t addr_val[6] = {0};
     rc = ble_hs_id_copy_addr(own_addr_type, addr_val, NULL);
     if (rc != 0) {
-        printf("BLE: Failed to copy address: %d\n", rc);
+        BINLOG(LOG_ADDR_COPY_FAIL, rc);
         return rc;
     }
     
-    printf("BLE: Scanner started, address: %s\n", addr_str(addr_val));
+    BINLOG(LOG_OWN_ADDR, LOG_ADDR_ARGS(addr_val));
     
     // Start scanning
-    printf("BLE: Starting scan...\n");
     start_scan();
     
     return 0;
@@ -479,7 +465,7 @@ static int ble_app_on_sync(void)
 // Application callback for BLE host reset
 static void ble_app_on_reset(int reason)
 {
-    printf("BLE reset: %d\n", reason);
+    BINLOG(LOG_HOST_RESET, reason);
 }
 
 // Application callbacks
@@ -504,9 +490,23 @@ void app_main(void)
     printf("App: Initializing BLE...\n");
     esp_nimble_hci_init();
     
+    // Console output of the BLE callbacks, from here on
+    static const binlog_config_t log_config = {
+        .formats = log_formats,
+        .format_count = LOG_FORMAT_COUNT,
+    };
+    if (binlog_start(&log_config) != ESP_OK) {
+        printf("App: Failed to start the log task\n");
+    }
+    
     printf("App: Initializing NimBLE port...\n");
     nimble_port_init();
     
+    // Timers, delivered through the host task's event queue
+    ble_npl_callout_init(&scan_dup_timer, nimble_port_get_dflt_eventq(), scan_dup_reset_cb, NULL);
+    ble_npl_callout_init(&scan_restart_timer, nimble_port_get_dflt_eventq(), scan_restart_cb, NULL);
+    ble_npl_callout_init(&read_timer, nimble_port_get_dflt_eventq(), read_timer_cb, NULL);
+    
     // Set the default device name
     printf("App: Setting device name...\n");
     ble_svc_gap_device_name_set("ESP32-BLE-Scanner");
@@ -532,9 +532,6 @@ void app_main(void)
     printf("App: Starting BLE host task...\n");
     nimble_port_freertos_init(ble_host_task);
     
-    // Create a task for periodic reads
-    xTaskCreate(periodic_read_task, "periodic_read", 4096, NULL, 5, NULL);
-    
     // Keep the main task alive
     while (1) {
         vTaskDelay(1000 / portTICK_PERIOD_MS);
@@ -1,121 +1,46 @@
 #include "display.h"
+#include "display_priv.h"
+#include "display_transport.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_log.h"
 #include "esp_err.h"
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "esp_rom_sys.h"
 #include <string.h>
 
 static const char *TAG = "ILI9341";
 
+// Glyph expansion buffer: one full glyph up to scale 4 (20x32 px), and at
+// least two scanlines of the widest glyph that still fits on screen.
+#define GLYPH_BUF_PIXELS (ILI9341_WIDTH * 2)
+
+// Bulk pixel streaming: queue_depth DMA buffers of max_transfer_bytes each
+// (by default two of 16 full lines, 10 KB in RGB565). While some are on
+// the wire the CPU prepares the next.
+
 // ==== Private Variables ====
-static spi_device_handle_t spi_device = NULL;
 static const ili9341_config_t *display_config = NULL;
 static bool is_initialized = false;
+static DMA_ATTR uint16_t glyph_buf[GLYPH_BUF_PIXELS];
+static uint16_t *dma_buf[ILI9341_MAX_QUEUE_DEPTH];
+static int dma_buf_count = 0;
+static size_t dma_chunk_pixels = 0;
 
-// ==== 5x8 ASCII Font Table (32-127) ====
-static const uint8_t font5x8[96][5] = {
-    // ASCII 32-127
-    {0x00,0x00,0x00,0x00,0x00}, // 32  ' '
-    {0x00,0x00,0x5F,0x00,0x00}, // 33  '!'
-    {0x00,0x07,0x00,0x07,0x00}, // 34  '"'
-    {0x14,0x7F,0x14,0x7F,0x14}, // 35  '#'
-    {0x24,0x2A,0x7F,0x2A,0x12}, // 36  '$'
-    {0x23,0x13,0x08,0x64,0x62}, // 37  '%'
-    {0x36,0x49,0x55,0x22,0x50}, // 38  '&'
-    {0x00,0x05,0x03,0x00,0x00}, // 39  '''
-    {0x00,0x1C,0x22,0x41,0x00}, // 40  '('
-    {0x00,0x41,0x22,0x1C,0x00}, // 41  ')'
-    {0x14,0x08,0x3E,0x08,0x14}, // 42  '*'
-    {0x08,0x08,0x3E,0x08,0x08}, // 43  '+'
-    {0x00,0x50,0x30,0x00,0x00}, // 44  ','
-    {0x08,0x08,0x08,0x08,0x08}, // 45  '-'
-    {0x00,0x60,0x60,0x00,0x00}, // 46  '.'
-    {0x20,0x10,0x08,0x04,0x02}, // 47  '/'
-    {0x3E,0x51,0x49,0x45,0x3E}, // 48  '0'
-    {0x00,0x42,0x7F,0x40,0x00}, // 49  '1'
-    {0x42,0x61,0x51,0x49,0x46}, // 50  '2'
-    {0x21,0x41,0x45,0x4B,0x31}, // 51  '3'
-    {0x18,0x14,0x12,0x7F,0x10}, // 52  '4'
-    {0x27,0x45,0x45,0x45,0x39}, // 53  '5'
-    {0x3C,0x4A,0x49,0x49,0x30}, // 54  '6'
-    {0x01,0x71,0x09,0x05,0x03}, // 55  '7'
-    {0x36,0x49,0x49,0x49,0x36}, // 56  '8'
-    {0x06,0x49,0x49,0x29,0x1E}, // 57  '9'
-    {0x00,0x36,0x36,0x00,0x00}, // 58  ':'
-    {0x00,0x56,0x36,0x00,0x00}, // 59  ';'
-    {0x08,0x14,0x22,0x41,0x00}, // 60  '<'
-    {0x14,0x14,0x14,0x14,0x14}, // 61  '='
-    {0x00,0x41,0x22,0x14,0x08}, // 62  '>'
-    {0x02,0x01,0x51,0x09,0x06}, // 63  '?'
-    {0x32,0x49,0x79,0x41,0x3E}, // 64  '@'
-    {0x7E,0x11,0x11,0x11,0x7E}, // 65  'A'
-    {0x7F,0x49,0x49,0x49,0x36}, // 66  'B'
-    {0x3E,0x41,0x41,0x41,0x22}, // 67  'C'
-    {0x7F,0x41,0x41,0x22,0x1C}, // 68  'D'
-    {0x7F,0x49,0x49,0x49,0x41}, // 69  'E'
-    {0x7F,0x09,0x09,0x09,0x01}, // 70  'F'
-    {0x3E,0x41,0x49,0x49,0x7A}, // 71  'G'
-    {0x7F,0x08,0x08,0x08,0x7F}, // 72  'H'
-    {0x00,0x41,0x7F,0x41,0x00}, // 73  'I'
-    {0x20,0x40,0x41,0x3F,0x01}, // 74  'J'
-    {0x7F,0x08,0x14,0x22,0x41}, // 75  'K'
-    {0x7F,0x40,0x40,0x40,0x40}, // 76  'L'
-    {0x7F,0x02,0x0C,0x02,0x7F}, // 77  'M'
-    {0x7F,0x04,0x08,0x10,0x7F}, // 78  'N'
-    {0x3E,0x41,0x41,0x41,0x3E}, // 79  'O'
-    {0x7F,0x09,0x09,0x09,0x06}, // 80  'P'
-    {0x3E,0x41,0x51,0x21,0x5E}, // 81  'Q'
-    {0x7F,0x09,0x19,0x29,0x46}, // 82  'R'
-    {0x46,0x49,0x49,0x49,0x31}, // 83  'S'
-    {0x01,0x01,0x7F,0x01,0x01}, // 84  'T'
-    {0x3F,0x40,0x40,0x40,0x3F}, // 85  'U'
-    {0x1F,0x20,0x40,0x20,0x1F}, // 86  'V'
-    {0x3F,0x40,0x38,0x40,0x3F}, // 87  'W'
-    {0x63,0x14,0x08,0x14,0x63}, // 88  'X'
-    {0x07,0x08,0x70,0x08,0x07}, // 89  'Y'
-    {0x61,0x51,0x49,0x45,0x43}, // 90  'Z'
-    {0x00,0x7F,0x41,0x41,0x00}, // 91  '['
-    {0x02,0x04,0x08,0x10,0x20}, // 92  '\'
-    {0x00,0x41,0x41,0x7F,0x00}, // 93  ']'
-    {0x04,0x02,0x01,0x02,0x04}, // 94  '^'
-    {0x40,0x40,0x40,0x40,0x40}, // 95  '_'
-    {0x00,0x01,0x02,0x04,0x00}, // 96  '`'
-    {0x20,0x54,0x54,0x54,0x78}, // 97  'a'
-    {0x7F,0x48,0x44,0x44,0x38}, // 98  'b'
-    {0x38,0x44,0x44,0x44,0x20}, // 99  'c'
-    {0x38,0x44,0x44,0x48,0x7F}, // 100 'd'
-    {0x38,0x54,0x54,0x54,0x18}, // 101 'e'
-    {0x08,0x7E,0x09,0x01,0x02}, // 102 'f'
-    {0x0C,0x52,0x52,0x52,0x3E}, // 103 'g'
-    {0x7F,0x08,0x04,0x04,0x78}, // 104 'h'
-    {0x00,0x44,0x7D,0x40,0x00}, // 105 'i'
-    {0x20,0x40,0x44,0x3D,0x00}, // 106 'j'
-    {0x7F,0x10,0x28,0x44,0x00}, // 107 'k'
-    {0x00,0x41,0x7F,0x40,0x00}, // 108 'l'
-    {0x7C,0x04,0x18,0x04,0x78}, // 109 'm'
-    {0x7C,0x08,0x04,0x04,0x78}, // 110 'n'
-    {0x38,0x44,0x44,0x44,0x38}, // 111 'o'
-    {0x7C,0x14,0x14,0x14,0x08}, // 112 'p'
-    {0x08,0x14,0x14,0x18,0x7C}, // 113 'q'
-    {0x7C,0x08,0x04,0x04,0x08}, // 114 'r'
-    {0x48,0x54,0x54,0x54,0x20}, // 115 's'
-    {0x04,0x3F,0x44,0x40,0x20}, // 116 't'
-    {0x3C,0x40,0x40,0x20,0x7C}, // 117 'u'
-    {0x1C,0x20,0x40,0x20,0x1C}, // 118 'v'
-    {0x3C,0x40,0x30,0x40,0x3C}, // 119 'w'
-    {0x44,0x28,0x10,0x28,0x44}, // 120 'x'
-    {0x0C,0x50,0x50,0x50,0x3C}, // 121 'y'
-    {0x44,0x64,0x54,0x4C,0x44}, // 122 'z'
-    {0x00,0x08,0x36,0x41,0x00}, // 123 '{'
-    {0x00,0x00,0x7F,0x00,0x00}, // 124 '|'
-    {0x00,0x41,0x36,0x08,0x00}, // 125 '}'
-    {0x10,0x08,0x08,0x10,0x08}, // 126 '~'
-    {0x00,0x00,0x00,0x00,0x00}  // 127 DEL
-};
+// Drawing bounds for the current MADCTL orientation
+static uint16_t screen_width = ILI9341_WIDTH;
+static uint16_t screen_height = ILI9341_HEIGHT;
+static uint8_t madctl_value = ILI9341_MADCTL_LANDSCAPE;
+
+static ili9341_boot_timing_t boot_timing;
+
+// Drawing calls skip everything outside this rectangle
+static ili9341_rect_t clip = { 0, 0, ILI9341_WIDTH, ILI9341_HEIGHT };
 
 // ==== Private Function Declarations ====
 
-static void ili9341_write_cmd(uint8_t cmd);
 static void ili9341_write_data(const uint8_t* data, int len);
 static void ili9341_reset(void);
 static void ili9341_hw_init(void);
@@ -125,47 +50,17 @@ void ili9341_text_scaled(const char *str, uint16_t x, uint16_t y, uint16_t color
 static inline void delay_ms(int ms);
 
 // ==== Private Functions ====
+// Rounds up: datasheet minimums must not become zero-tick delays
 static inline void delay_ms(int ms) {
-    vTaskDelay(ms / portTICK_PERIOD_MS);
+    vTaskDelay((ms + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS);
 }
 
-static esp_err_t ili9341_gpio_init(void) {
-    if (display_config == NULL) {
-        ESP_LOGE(TAG, "Display config not set");
-        return ESP_ERR_INVALID_STATE;
-    }
-
-    gpio_config_t io_conf = {
-        .pin_bit_mask = (1ULL << display_config->pin_dc) | 
-                       (1ULL << display_config->pin_rst) | 
-                       (1ULL << display_config->pin_cs),
-        .mode = GPIO_MODE_OUTPUT,
-        .pull_up_en = GPIO_PULLUP_DISABLE,
-        .pull_down_en = GPIO_PULLDOWN_DISABLE,
-        .intr_type = GPIO_INTR_DISABLE,
-    };
-    
-    // Add backlight pin if configured
-    if (display_config->pin_bckl >= 0) {
-        io_conf.pin_bit_mask |= (1ULL << display_config->pin_bckl);
+static void ili9341_free_dma_bufs(void) {
+    for (int i = 0; i < ILI9341_MAX_QUEUE_DEPTH; i++) {
+        heap_caps_free(dma_buf[i]);
+        dma_buf[i] = NULL;
     }
-    
-    esp_err_t ret = gpio_config(&io_conf);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "GPIO config failed: %s", esp_err_to_name(ret));
-        return ret;
-    }
-    
-    // Set initial pin states
-    gpio_set_level(display_config->pin_cs, 1);
-    gpio_set_level(display_config->pin_dc, 0);
-    gpio_set_level(display_config->pin_rst, 1);
-    
-    if (display_config->pin_bckl >= 0) {
-        gpio_set_level(display_config->pin_bckl, 1);
-    }
-    
-    return ESP_OK;
+    dma_buf_count = 0;
 }
 
 esp_err_t ili9341_init(const ili9341_config_t *config) {
@@ -176,52 +71,43 @@ esp_err_t ili9341_init(const ili9341_config_t *config) {
     // Store the config pointer
     display_config = config;
     
-    // Initialize GPIO
-    esp_err_t ret = ili9341_gpio_init();
+    // Control pins and bus (SPI on the target, a virtual panel on Linux)
+    esp_err_t ret = ili9341_transport_init(display_config);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "GPIO init failed");
+        ESP_LOGE(TAG, "Transport init failed");
+        display_config = NULL;
         return ret;
     }
     
-    // Initialize SPI
-    spi_bus_config_t buscfg = {
-        .miso_io_num = display_config->pin_miso,
-        .mosi_io_num = display_config->pin_mosi,
-        .sclk_io_num = display_config->pin_clk,
-        .quadwp_io_num = -1,
-        .quadhd_io_num = -1,
-        .max_transfer_sz = ILI9341_WIDTH * ILI9341_HEIGHT * 2 + 8
-    };
-    
-    // Initialize SPI bus
-    ret = spi_bus_initialize(display_config->spi_host, &buscfg, SPI_DMA_CH_AUTO);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "SPI bus init failed: %s", esp_err_to_name(ret));
-        return ret;
+    // Allocate the streaming buffers used for fills and bitmap blits
+    dma_chunk_pixels = ili9341_config_max_transfer(display_config) / ILI9341_PANEL_BPP;
+    for (int i = 0; i < ili9341_config_queue_depth(display_config); i++) {
+        dma_buf[i] = heap_caps_malloc(dma_chunk_pixels * ILI9341_PANEL_BPP, MALLOC_CAP_DMA);
+        if (dma_buf[i] == NULL) {
+            ESP_LOGE(TAG, "Failed to allocate DMA buffers");
+            ili9341_free_dma_bufs();
+            ili9341_transport_deinit();
+            display_config = NULL;
+            return ESP_ERR_NO_MEM;
+        }
+        dma_buf_count++;
     }
-
-    // Configure SPI device - Updated to match example
-    spi_device_interface_config_t devcfg = {
-        .clock_speed_hz = 40 * 1000 * 1000, // Set to 40MHz like example
-        .mode = 0,
-        .spics_io_num = -1, // CS handled manually
-        .queue_size = 7,
-        .pre_cb = NULL,
-        .post_cb = NULL
-    };
     
-    // Add SPI device
-    ret = spi_bus_add_device(display_config->spi_host, &devcfg, &spi_device);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "SPI device add failed: %s", esp_err_to_name(ret));
-        spi_bus_free(display_config->spi_host);
-        return ret;
-    }
+    ili9341_glyph_cache_setup(display_config->glyph_cache_bytes);
+    
+    screen_width = ILI9341_WIDTH;
+    screen_height = ILI9341_HEIGHT;
+    madctl_value = ILI9341_MADCTL_LANDSCAPE;
+    ili9341_set_clip(NULL);
     
     // Initialize display hardware
     ili9341_hw_init();
     is_initialized = true;
     
+#if defined(CONFIG_ILI9341_PERF_STATS) && CONFIG_ILI9341_PERF_DUMP_PERIOD_MS > 0
+    ili9341_perf_start_dump(CONFIG_ILI9341_PERF_DUMP_PERIOD_MS);
+#endif
+    
     ESP_LOGI(TAG, "Display initialized successfully");
     return ESP_OK;
 }
@@ -232,20 +118,12 @@ void ili9341_deinit(void) {
     }
     
     // Turn off display backlight if configured
-    if (display_config && display_config->pin_bckl >= 0) {
-        gpio_set_level(display_config->pin_bckl, 0);
-    }
-    
-    // Remove SPI device if it was added
-    if (spi_device) {
-        spi_bus_remove_device(spi_device);
-        spi_device = NULL;
-    }
+    ili9341_transport_set_backlight(0);
     
-    // Free SPI bus if it was initialized
-    if (display_config) {
-        spi_bus_free(display_config->spi_host);
-    }
+    ili9341_perf_start_dump(0);
+    ili9341_free_dma_bufs();
+    ili9341_glyph_cache_setup(0);
+    ili9341_transport_deinit();
     
     // Reset state
     is_initialized = false;
@@ -254,41 +132,111 @@ void ili9341_deinit(void) {
     ESP_LOGI(TAG, "Display deinitialized");
 }
 
-static void ili9341_write_cmd(uint8_t cmd) {
-    if (display_config == NULL) return;
-    gpio_set_level(display_config->pin_dc, 0);
-    gpio_set_level(display_config->pin_cs, 0);
-    spi_transaction_t t = { .length = 8, .tx_buffer = &cmd };
-    if (spi_device) {
-        ESP_ERROR_CHECK(spi_device_transmit(spi_device, &t));
+static void ili9341_write_data(const uint8_t* data, int len) {
+    if (display_config == NULL || data == NULL || len <= 0) return;
+    
+    ili9341_transport_select();
+    esp_err_t ret = ili9341_transport_write(ILI9341_DC_DATA, data, len);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "SPI transmit failed: %s", esp_err_to_name(ret));
     }
-    gpio_set_level(display_config->pin_cs, 1);
+    ili9341_transport_deselect();
 }
 
-static void ili9341_write_data(const uint8_t* data, int len) {
-    if (display_config == NULL || data == NULL || len <= 0) return;
+#if ILI9341_PANEL_BPP == 3
+// Byte-swapped RGB565 -> RGB666, one byte per channel with the colour in
+// the top 6 bits (low bits replicated). Runs backwards, so src may be the
+// start of dst.
+static void ili9341_rgb565_to_666(uint8_t *dst, const uint16_t *src, size_t count) {
+    for (size_t i = count; i-- > 0;) {
+        uint16_t v = ili9341_swap16(src[i]);
+        uint8_t *p = &dst[i * 3];
+        p[0] = ((v >> 8) & 0xF8) | ((v >> 13) & 0x04);
+        p[1] = (v >> 3) & 0xFC;
+        p[2] = ((v << 3) & 0xF8) | ((v >> 2) & 0x04);
+    }
+}
+#endif
+
+// Blocking write of byte-swapped RGB565 pixels to the current window.
+// RGB666 panels convert through the first streaming buffer, which is
+// idle outside ili9341_stream_pixels().
+static void ili9341_write_pixels(const uint16_t *pixels, size_t count) {
+#if ILI9341_PANEL_BPP == 3
+    while (count > 0) {
+        size_t n = (count > dma_chunk_pixels) ? dma_chunk_pixels : count;
+        ili9341_rgb565_to_666((uint8_t *)dma_buf[0], pixels, n);
+        ili9341_write_data((const uint8_t *)dma_buf[0], n * 3);
+        pixels += n;
+        count -= n;
+    }
+#else
+    ili9341_write_data((const uint8_t *)pixels, count * 2);
+#endif
+}
+
+// Stream pixel data to the current window through the DMA buffers. Each
+// chunk is queued without waiting, so filling the next buffer overlaps the
+// transfer of the previous ones; a buffer is only reused once its own
+// transaction has come back. Returns once everything is on the wire.
+void ili9341_stream_pixels(size_t total, ili9341_pixel_source_t source, void *arg) {
+    if (display_config == NULL || dma_buf[0] == NULL) {
+        return;
+    }
     
-    gpio_set_level(display_config->pin_dc, 1);
-    gpio_set_level(display_config->pin_cs, 0);
+    ili9341_transport_select();
     
-    spi_transaction_t t = { 
-        .length = len * 8, 
-        .tx_buffer = data 
-    };
+    int in_flight = 0;
+    int idx = 0;
+    esp_err_t ret;
+    
+    while (total > 0) {
+        size_t count = (total > dma_chunk_pixels) ? dma_chunk_pixels : total;
+        
+        // All buffers busy: wait for the oldest one, which is dma_buf[idx]
+        if (in_flight == dma_buf_count) {
+            ret = ili9341_transport_wait();
+            if (ret != ESP_OK) {
+                ESP_LOGE(TAG, "SPI result failed: %s", esp_err_to_name(ret));
+                break;
+            }
+            in_flight--;
+        }
+        
+        const uint16_t *chunk = source(dma_buf[idx], count, arg);
+#if ILI9341_PANEL_BPP == 3
+        ili9341_rgb565_to_666((uint8_t *)dma_buf[idx], chunk, count);
+        chunk = dma_buf[idx];
+#endif
+        
+        ret = ili9341_transport_queue(chunk, count * ILI9341_PANEL_BPP);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "SPI queue failed: %s", esp_err_to_name(ret));
+            break;
+        }
+        in_flight++;
+        idx = (idx + 1) % dma_buf_count;
+        total -= count;
+    }
     
-    if (spi_device) {
-        esp_err_t ret = spi_device_transmit(spi_device, &t);
+    // Drain whatever is still queued before releasing CS
+    while (in_flight > 0) {
+        ret = ili9341_transport_wait();
         if (ret != ESP_OK) {
-            ESP_LOGE(TAG, "SPI transmit failed: %s", esp_err_to_name(ret));
+            ESP_LOGE(TAG, "SPI result failed: %s", esp_err_to_name(ret));
+            break;
         }
+        in_flight--;
     }
     
-    gpio_set_level(display_config->pin_cs, 1);
+    ili9341_transport_deselect();
 }
 
 void ili9341_set_window(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
     if (display_config == NULL) return;
     
+    ILI9341_PERF_BEGIN(perf);
+    
     // Column address set
     uint8_t col_data[4] = {
         (x0 >> 8) & 0xFF,
@@ -305,320 +253,423 @@ void ili9341_set_window(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
         y1 & 0xFF
     };
     
-    // Send commands and data
-    ili9341_write_cmd(0x2A); // Column address set
-    ili9341_write_data(col_data, 4);
-    
-    ili9341_write_cmd(0x2B); // Page address set
-    ili9341_write_data(row_data, 4);
+    // CASET, PASET and RAMWR back to back under a single CS assertion
+    ili9341_transport_select();
+    esp_err_t ret = ili9341_transport_write_cmd(0x2A, col_data, 4);
+    if (ret == ESP_OK) {
+        ret = ili9341_transport_write_cmd(0x2B, row_data, 4);
+    }
+    if (ret == ESP_OK) {
+        ret = ili9341_transport_write_cmd(0x2C, NULL, 0);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "SPI transmit failed: %s", esp_err_to_name(ret));
+    }
+    ili9341_transport_deselect();
     
-    ili9341_write_cmd(0x2C); // Memory write
+    ILI9341_PERF_END(ILI9341_PERF_SET_WINDOW, perf);
 }
 
+// ==== Init Sequence ====
+// Streamed from flash as: command, parameter count (| INIT_DELAY when a
+// delay byte follows the parameters), parameters, [delay in ms].
+#define INIT_DELAY 0x80
+
+#if defined(CONFIG_ILI9341_PANEL_ST7789)
+static const uint8_t init_cmds[] = {
+    0x28, 0,                                    // Display off
+    0x36, 1, ILI9341_MADCTL_LANDSCAPE,          // Memory access control
+    0x3A, 1, ILI9341_PANEL_COLMOD,              // Pixel format
+    0xB2, 5, 0x0C, 0x0C, 0x00, 0x33, 0x33,      // Porch control
+    0xB7, 1, 0x35,                              // Gate control
+    0xBB, 1, 0x19,                              // VCOM setting
+    0xC0, 1, 0x2C,                              // LCM control
+    0xC2, 1, 0x01,                              // VDV and VRH command enable
+    0xC3, 1, 0x12,                              // VRH set
+    0xC4, 1, 0x20,                              // VDV set
+    0xC6, 1, 0x0F,                              // Frame rate: 60 Hz
+    0xD0, 2, 0xA4, 0xA1,                        // Power control 1
+    0xE0, 14, 0xD0, 0x04, 0x0D, 0x11, 0x13, 0x2B, 0x3F,
+              0x54, 0x4C, 0x18, 0x0D, 0x0B, 0x1F, 0x23,   // Positive gamma
+    0xE1, 14, 0xD0, 0x04, 0x0C, 0x11, 0x13, 0x2C, 0x3F,
+              0x44, 0x51, 0x2F, 0x1F, 0x1F, 0x20, 0x23,   // Negative gamma
+    0x21, 0,                                    // Inversion on: the glass is inverted
+    0x11, INIT_DELAY | 0, 5,                    // Sleep out, 5 ms before the next command
+};
+#elif defined(CONFIG_ILI9341_PANEL_ILI9488)
+static const uint8_t init_cmds[] = {
+    0x28, 0,                                    // Display off
+    0xE0, 15, 0x00, 0x03, 0x09, 0x08, 0x16, 0x0A, 0x3F, 0x78,
+              0x4C, 0x09, 0x0A, 0x08, 0x16, 0x1A, 0x0F,   // Positive gamma
+    0xE1, 15, 0x00, 0x16, 0x19, 0x03, 0x0F, 0x05, 0x32, 0x45,
+              0x46, 0x04, 0x0E, 0x0D, 0x35, 0x37, 0x0F,   // Negative gamma
+    0xC0, 2, 0x17, 0x15,                        // Power control 1
+    0xC1, 1, 0x41,                              // Power control 2
+    0xC5, 3, 0x00, 0x12, 0x80,                  // VCOM control
+    0x36, 1, ILI9341_MADCTL_LANDSCAPE,          // Memory access control
+    0x3A, 1, ILI9341_PANEL_COLMOD,              // Pixel format: 18-bit, the only SPI option
+    0xB0, 1, 0x00,                              // Interface mode control
+    0xB1, 1, 0xA0,                              // Frame rate control
+    0xB4, 1, 0x02,                              // Display inversion control: 2-dot
+    0xB6, 3, 0x02, 0x02, 0x3B,                  // Display function control
+    0xE9, 1, 0x00,                              // Set image function
+    0xF7, 4, 0xA9, 0x51, 0x2C, 0x82,            // Adjust control 3
+    0x11, INIT_DELAY | 0, 5,                    // Sleep out, 5 ms before the next command
+};
+#else // CONFIG_ILI9341_PANEL_ILI9341
+static const uint8_t init_cmds[] = {
+    0x28, 0,                                    // Display off
+    0xCF, 3, 0x00, 0x83, 0x30,                  // Power control B
+    0xED, 4, 0x64, 0x03, 0x12, 0x81,            // Power on sequence control
+    0xE8, 3, 0x85, 0x01, 0x79,                  // Driver timing control A
+    0xCB, 5, 0x39, 0x2C, 0x00, 0x34, 0x02,      // Power control A
+    0xF7, 1, 0x20,                              // Pump ratio control
+    0xEA, 2, 0x00, 0x00,                        // Driver timing control B
+    0xC0, 1, 0x26,                              // Power control 1
+    0xC1, 1, 0x11,                              // Power control 2
+    0xC5, 2, 0x35, 0x3E,                        // VCOM control 1
+    0xC7, 1, 0xBE,                              // VCOM control 2
+    0x36, 1, ILI9341_MADCTL_LANDSCAPE,          // Memory access control
+    0x3A, 1, ILI9341_PANEL_COLMOD,              // Pixel format: 16-bit color
+    0xB1, 2, 0x00, 0x1B,                        // Frame rate control
+    0xF2, 1, 0x08,                              // 3GAMMA disable
+    0x26, 1, 0x01,                              // Gamma set
+    0xE0, 15, 0x1F, 0x1A, 0x18, 0x0A, 0x0F, 0x06, 0x45, 0x87,
+              0x32, 0x0A, 0x07, 0x02, 0x07, 0x05, 0x00,   // Positive gamma
+    0xE1, 15, 0x00, 0x25, 0x27, 0x05, 0x10, 0x09, 0x3A, 0x78,
+              0x4D, 0x05, 0x18, 0x0D, 0x38, 0x3A, 0x1F,   // Negative gamma
+    0x11, INIT_DELAY | 0, 5,                    // Sleep out, 5 ms before the next command
+};
+#endif
+
+// Datasheet reset timing: RESX low for at least 10 us, then 5 ms before
+// the first command when the panel was in sleep-in (always true at boot)
+#define RESET_PULSE_US   10
+#define RESET_RECOVER_MS 5
+
 static void ili9341_reset(void) {
     if (display_config == NULL) return;
     
-    ESP_LOGI(TAG, "Starting display reset sequence");
+    ili9341_transport_set_reset(0);
+    esp_rom_delay_us(RESET_PULSE_US);
+    ili9341_transport_set_reset(1);
+    delay_ms(RESET_RECOVER_MS);
+}
+
+static void ili9341_send_init_table(const uint8_t *table, size_t size) {
+    size_t i = 0;
     
-    gpio_set_level(display_config->pin_rst, 1); 
-    delay_ms(100); // Increased delay
-    gpio_set_level(display_config->pin_rst, 0); 
-    delay_ms(100); // Increased delay
-    gpio_set_level(display_config->pin_rst, 1); 
-    delay_ms(200); // Increased delay
+    while (i + 1 < size) {
+        uint8_t cmd = table[i++];
+        uint8_t count = table[i] & ~INIT_DELAY;
+        bool has_delay = table[i++] & INIT_DELAY;
+        
+        ili9341_send_cmd(cmd, count ? &table[i] : NULL, count);
+        i += count;
+        
+        if (has_delay) {
+            delay_ms(table[i++]);
+        }
+    }
+}
+
+// ==== Clock Calibration ====
+// The SPI peripheral divides this source clock by an integer, so those are
+// the only clocks worth trying: 80, 40, 26.7, 20 MHz, ...
+#define CALIB_SRC_CLOCK_HZ (80 * 1000 * 1000)
+// Test burst per candidate clock, in streaming buffers
+#define CALIB_CHUNKS 4
+// A clock passes if its burst takes at most this much longer than its wire time
+#define CALIB_SLACK_PCT 25
+
+static const uint16_t *fill_source(uint16_t *dst, size_t count, void *arg);
+
+// Time a burst of a test pattern into GRAM at the current clock. The
+// display is still off and the clear that follows overwrites it.
+static int64_t ili9341_calib_burst(size_t pixels) {
+    static const uint16_t pattern = 0xA55A;
     
-    ESP_LOGI(TAG, "Display reset sequence complete");
+    ili9341_set_window(0, 0, ILI9341_WIDTH - 1, ILI9341_HEIGHT - 1);
+    int64_t start = esp_timer_get_time();
+    ili9341_stream_pixels(pixels, fill_source, (void *)&pattern);
+    return esp_timer_get_time() - start;
 }
 
-static void ili9341_hw_init(void) {
-    if (display_config == NULL) {
-        ESP_LOGE(TAG, "Display config not set in hw_init");
+// Try clocks from spi_clock_max_hz downwards and keep the first whose burst
+// is on time, i.e. the bus really moves data at that rate: the SPI driver
+// may refuse a clock outright, and a clock the pins or DMA can't keep up
+// with shows up as a burst slower than its wire time.
+static void ili9341_calibrate_clock(void) {
+    int base_hz = ili9341_config_clock_hz(display_config);
+    int max_hz = display_config->spi_clock_max_hz;
+    if (max_hz <= base_hz) {
         return;
     }
     
-    ESP_LOGI(TAG, "Starting display hardware initialization...");
+    size_t pixels = dma_chunk_pixels * CALIB_CHUNKS;
+    int div = (CALIB_SRC_CLOCK_HZ + max_hz - 1) / max_hz;
     
-    // Reset display
-    ESP_LOGI(TAG, "Performing display reset...");
-    ili9341_reset();
+    for (; CALIB_SRC_CLOCK_HZ / div > base_hz; div++) {
+        int hz;
+        if (ili9341_transport_set_clock(CALIB_SRC_CLOCK_HZ / div, &hz) != ESP_OK) {
+            continue;
+        }
+        
+        int64_t wire_us = (int64_t)pixels * ILI9341_PANEL_BPP * 8 * 1000000 / hz;
+        int64_t took_us = ili9341_calib_burst(pixels);
+        bool pass = took_us * 100 <= wire_us * (100 + CALIB_SLACK_PCT);
+        ESP_LOGI(TAG, "Calibration: %d kHz burst %lld us (wire %lld us) %s",
+                 hz / 1000, (long long)took_us, (long long)wire_us, pass ? "ok" : "too slow");
+        if (pass) {
+            return;
+        }
+    }
     
-    // Send initialization commands
-    const uint8_t *data;
-    uint8_t cmd;
-    
-    ESP_LOGI(TAG, "Sending initialization commands...");
-    
-    // Software reset
-    cmd = 0x01; 
-    ESP_LOGI(TAG, "Sending software reset command");
-    ili9341_write_cmd(cmd); 
-    delay_ms(100);
-    
-    // Display off
-    cmd = 0x28; 
-    ESP_LOGI(TAG, "Turning display off");
-    ili9341_write_cmd(cmd);
-    
-    // Power control B
-    cmd = 0xCF; 
-    ESP_LOGI(TAG, "Setting power control B");
-    ili9341_write_cmd(cmd);
-    data = (uint8_t[]){0x00, 0x83, 0x30}; 
-    ili9341_write_data(data, 3);
-    
-    // Power on sequence control
-    cmd = 0xED; 
-    ESP_LOGI(TAG, "Setting power on sequence");
-    ili9341_write_cmd(cmd);
-    data = (uint8_t[]){0x64, 0x03, 0x12, 0x81}; 
-    ili9341_write_data(data, 4);
-    
-    // Driver timing control A
-    cmd = 0xE8; 
-    ESP_LOGI(TAG, "Setting driver timing A");
-    ili9341_write_cmd(cmd);
-    data = (uint8_t[]){0x85, 0x01, 0x79}; 
-    ili9341_write_data(data, 3);
-    
-    // Power control A
-    cmd = 0xCB; 
-    ESP_LOGI(TAG, "Setting power control A");
-    ili9341_write_cmd(cmd);
-    data = (uint8_t[]){0x39, 0x2C, 0x00, 0x34, 0x02}; 
-    ili9341_write_data(data, 5);
-    
-    // Pump ratio control
-    cmd = 0xF7; 
-    ESP_LOGI(TAG, "Setting pump ratio");
-    ili9341_write_cmd(cmd);
-    data = (uint8_t[]){0x20}; 
-    ili9341_write_data(data, 1);
-    
-    // Driver timing control B
-    cmd = 0xEA; 
-    ESP_LOGI(TAG, "Setting driver timing B");
-    ili9341_write_cmd(cmd);
-    data = (uint8_t[]){0x00, 0x00}; 
-    ili9341_write_data(data, 2);
-    
-    // Power control 1
-    cmd = 0xC0; 
-    ESP_LOGI(TAG, "Setting power control 1");
-    ili9341_write_cmd(cmd);
-    data = (uint8_t[]){0x26}; 
-    ili9341_write_data(data, 1);
-    
-    // Power control 2
-    cmd = 0xC1; 
-    ESP_LOGI(TAG, "Setting power control 2");
-    ili9341_write_cmd(cmd);
-    data = (uint8_t[]){0x11}; 
-    ili9341_write_data(data, 1);
-    
-    // VCOM control 1
-    cmd = 0xC5; 
-    ESP_LOGI(TAG, "Setting VCOM control 1");
-    ili9341_write_cmd(cmd);
-    data = (uint8_t[]){0x35, 0x3E}; 
-    ili9341_write_data(data, 2);
-    
-    // VCOM control 2
-    cmd = 0xC7; 
-    ESP_LOGI(TAG, "Setting VCOM control 2");
-    ili9341_write_cmd(cmd);
-    data = (uint8_t[]){0xBE}; 
-    ili9341_write_data(data, 1);
-    
-    // Memory access control - Changed to match example
-    cmd = 0x36; 
-    ESP_LOGI(TAG, "Setting memory access control");
-    ili9341_write_cmd(cmd);
-    data = (uint8_t[]){0x28}; // Changed to 0x28 for landscape orientation
-    ili9341_write_data(data, 1);
-    
-    // Pixel format
-    cmd = 0x3A; 
-    ESP_LOGI(TAG, "Setting pixel format");
-    ili9341_write_cmd(cmd);
-    data = (uint8_t[]){0x55}; // 16-bit color
-    ili9341_write_data(data, 1);
-    
-    // Frame rate control
-    cmd = 0xB1; 
-    ESP_LOGI(TAG, "Setting frame rate");
-    ili9341_write_cmd(cmd);
-    data = (uint8_t[]){0x00, 0x1B}; 
-    ili9341_write_data(data, 2);
-    
-    // 3GAMMA DISABLE
-    cmd = 0xF2; 
-    ESP_LOGI(TAG, "Disabling 3GAMMA");
-    ili9341_write_cmd(cmd);
-    data = (uint8_t[]){0x08}; 
-    ili9341_write_data(data, 1);
-    
-    // Gamma set
-    cmd = 0x26; 
-    ESP_LOGI(TAG, "Setting gamma");
-    ili9341_write_cmd(cmd);
-    data = (uint8_t[]){0x01}; 
-    ili9341_write_data(data, 1);
-    
-    // Positive gamma correction
-    cmd = 0xE0; 
-    ESP_LOGI(TAG, "Setting positive gamma correction");
-    ili9341_write_cmd(cmd);
-    data = (uint8_t[]){0x1F, 0x1A, 0x18, 0x0A, 0x0F, 0x06, 0x45, 0x87, 
-                       0x32, 0x0A, 0x07, 0x02, 0x07, 0x05, 0x00};
-    ili9341_write_data(data, 15);
-    
-    // Negative gamma correction
-    cmd = 0xE1; 
-    ESP_LOGI(TAG, "Setting negative gamma correction");
-    ili9341_write_cmd(cmd);
-    data = (uint8_t[]){0x00, 0x25, 0x27, 0x05, 0x10, 0x09, 0x3A, 0x78, 
-                       0x4D, 0x05, 0x18, 0x0D, 0x38, 0x3A, 0x1F};
-    ili9341_write_data(data, 15);
-    
-    // Exit sleep mode
-    cmd = 0x11; 
-    ESP_LOGI(TAG, "Exiting sleep mode");
-    ili9341_write_cmd(cmd);
-    delay_ms(120);
-    
-    // Turn on display
-    cmd = 0x29; 
-    ESP_LOGI(TAG, "Turning display on");
-    ili9341_write_cmd(cmd);
-    
-    // Fill screen with black to ensure display is working
-    ESP_LOGI(TAG, "Filling screen with black");
-    ili9341_fill(0x0000);
-    
-    ESP_LOGI(TAG, "Display hardware initialization complete");
+    // Nothing faster held up: fall back to the configured clock
+    ili9341_transport_set_clock(base_hz, NULL);
 }
 
-static void ili9341_draw_char(char c, uint16_t x, uint16_t y, uint16_t color) {
-    if (display_config == NULL || c < 32 || c > 127) {
-        c = '?';  // Replace with question mark if invalid character or config
+static void ili9341_hw_init(void) {
+    if (display_config == NULL) {
+        ESP_LOGE(TAG, "Display config not set in hw_init");
+        return;
     }
     
-    const uint8_t *bitmap = font5x8[c-32];
-    ili9341_set_window(x, y, x+4, y+7);
+    int64_t start = esp_timer_get_time();
     
-    if (display_config == NULL) return;
+    // Hardware reset leaves every register at its default, so no SWRESET
+    ili9341_reset();
+    boot_timing.reset_us = esp_timer_get_time() - start;
     
-    gpio_set_level(display_config->pin_dc, 1);
-    gpio_set_level(display_config->pin_cs, 0);
+    ili9341_send_init_table(init_cmds, sizeof(init_cmds));
+    ili9341_power_reset();
+    boot_timing.config_us = esp_timer_get_time() - start;
     
-    uint8_t hi = color >> 8;
-    uint8_t lo = color & 0xFF;
-    uint8_t buf[2];
-    esp_err_t ret;
+    ili9341_calibrate_clock();
+    boot_timing.calib_us = esp_timer_get_time() - start;
     
-    for (int row = 0; row < 8; row++) {
-        for (int col = 0; col < 5; col++) {
-            if (bitmap[col] & (1 << row)) {
-                buf[0] = hi;
-                buf[1] = lo;
-            } else {
-                buf[0] = 0;
-                buf[1] = 0;
-            }
-            
-            spi_transaction_t t = {
-                .length = 16,
-                .tx_buffer = buf
-            };
-            
-            if (spi_device) {
-                ret = spi_device_transmit(spi_device, &t);
-                if (ret != ESP_OK) {
-                    ESP_LOGE(TAG, "SPI transmit failed: %s", esp_err_to_name(ret));
-                }
-            }
+    // Clear GRAM while the display is still off: no power-on garbage is
+    // ever shown, and the fill overlaps the post-sleep-out settling time
+    ili9341_fill(ILI9341_BLACK);
+    boot_timing.clear_us = esp_timer_get_time() - start;
+    
+    ili9341_send_cmd(0x29, NULL, 0); // Display on
+    boot_timing.total_us = esp_timer_get_time() - start;
+    
+    ESP_LOGI(TAG, "Panel ready in %lld us (reset %lld, config %lld, calib %lld, clear %lld) at %d kHz",
+             (long long)boot_timing.total_us, (long long)boot_timing.reset_us,
+             (long long)(boot_timing.config_us - boot_timing.reset_us),
+             (long long)(boot_timing.calib_us - boot_timing.config_us),
+             (long long)(boot_timing.clear_us - boot_timing.calib_us),
+             ili9341_transport_get_clock() / 1000);
+}
+
+static void ili9341_draw_char(char c, uint16_t x, uint16_t y, uint16_t color) {
+    ili9341_draw_char_scaled(c, x, y, color, 1);
+}
+
+// Send whatever has been expanded into glyph_buf so far as one transaction
+static void ili9341_glyph_flush(size_t *used) {
+    if (*used > 0) {
+        ili9341_write_pixels(glyph_buf, *used);
+        *used = 0;
+    }
+}
+
+// ==== Clipping ====
+// Intersect a rectangle in signed screen coordinates with the clip
+// rectangle. Everything outside is skipped before any SPI work.
+bool ili9341_clip_rect(int x, int y, int w, int h, ili9341_rect_t *out) {
+    int x0 = x > clip.x ? x : clip.x;
+    int y0 = y > clip.y ? y : clip.y;
+    int x1 = (x + w < clip.x + clip.w) ? x + w : clip.x + clip.w;
+    int y1 = (y + h < clip.y + clip.h) ? y + h : clip.y + clip.h;
+    
+    if (x1 <= x0 || y1 <= y0) {
+        return false;
+    }
+    *out = (ili9341_rect_t) { x0, y0, x1 - x0, y1 - y0 };
+    return true;
+}
+
+void ili9341_set_clip(const ili9341_rect_t *rect) {
+    clip = (ili9341_rect_t) { 0, 0, screen_width, screen_height };
+    if (rect != NULL) {
+        ili9341_rect_t screen = clip;
+        if (!ili9341_clip_rect(rect->x, rect->y, rect->w, rect->h, &clip)) {
+            clip = (ili9341_rect_t) { screen.x, screen.y, 0, 0 };
         }
     }
-    gpio_set_level(display_config->pin_cs, 1);
 }
 
-void ili9341_draw_char_scaled(char c, uint16_t x, uint16_t y, uint16_t color, uint8_t scale) {
-    if (display_config == NULL || scale == 0) {
-        return;
+// Draw only the visible part of a glyph that straddles the clip edge
+static void ili9341_draw_glyph_part(const uint8_t *rows, int x, int y, uint8_t scale,
+                                    const uint32_t pair[4], const ili9341_rect_t *vis) {
+    const int col0 = vis->x - x;
+    const int row0 = vis->y - y;
+    size_t used = 0;
+    
+    ili9341_set_window(vis->x, vis->y, vis->x + vis->w - 1, vis->y + vis->h - 1);
+    
+    for (int r = 0; r < vis->h; r++) {
+        if (used + vis->w > GLYPH_BUF_PIXELS) {
+            ili9341_glyph_flush(&used);
+        }
+        uint8_t mask = rows[(row0 + r) / scale];
+        for (int i = 0; i < vis->w; i++) {
+            glyph_buf[used++] = (uint16_t)pair[(mask >> ((col0 + i) / scale)) & 1];
+        }
     }
-    
+    ili9341_glyph_flush(&used);
+}
+
+static void ili9341_draw_glyph(char c, int x, int y, uint16_t color, uint8_t scale) {
     if (c < 32 || c > 127) {
         c = '?'; // Replace with question mark for invalid characters
     }
     
-    const uint8_t *bitmap = font5x8[c-32];
+    const uint8_t *rows = ili9341_font_rows(c);
+    const size_t width = 5 * scale;
+    const size_t height = 8 * scale;
+    
+    ili9341_rect_t vis;
+    if (!ili9341_clip_rect(x, y, width, height, &vis)) {
+        return; // Nothing visible: no window, no pixels
+    }
+    
+    const uint16_t fg = ili9341_swap16(color);
+    const uint16_t bg = 0;
+    size_t used = 0;
+    uint32_t pair[4];
+    
+    if (vis.w != width || vis.h != height) {
+        ili9341_font_pair_lut(pair, fg, bg);
+        ili9341_draw_glyph_part(rows, x, y, scale, pair, &vis);
+        return;
+    }
     
     // Set window for scaled character
-    ili9341_set_window(x, y, x + (5 * scale) - 1, y + (8 * scale) - 1);
+    ili9341_set_window(x, y, x + width - 1, y + height - 1);
     
-    gpio_set_level(display_config->pin_dc, 1);
-    gpio_set_level(display_config->pin_cs, 0);
+    // A cached glyph is already in wire format: one DMA transfer, no CPU work
+    const uint16_t *cached = ili9341_glyph_cache_lookup(c, scale, fg, bg);
+    if (cached != NULL) {
+        ili9341_write_pixels(cached, width * height);
+        return;
+    }
     
-    uint8_t hi = color >> 8;
-    uint8_t lo = color & 0xFF;
-    uint8_t buf[2];
-    esp_err_t ret;
+    ili9341_font_pair_lut(pair, fg, bg);
     
-    // Draw each row of the character
+    uint16_t *block = ili9341_glyph_cache_insert(c, scale, fg, bg);
+    if (block != NULL) {
+        for (int row = 0; row < 8; row++) {
+            uint16_t *line = &block[row * scale * width];
+            ili9341_font_expand_row(line, rows[row], ILI9341_FONT_WIDTH, scale, pair);
+            for (int row_repeat = 1; row_repeat < scale; row_repeat++) {
+                memcpy(&line[row_repeat * width], line, width * 2);
+            }
+        }
+        ili9341_write_pixels(block, width * height);
+        return;
+    }
+    
+    // Expand the glyph into glyph_buf one scanline at a time. Up to scale 4
+    // the whole glyph fits, so it goes out as a single DMA transaction;
+    // larger glyphs are sent in as few buffer-sized pieces as possible.
     for (int row = 0; row < 8; row++) {
-        // Repeat each row 'scale' times for vertical scaling
-        for (int row_repeat = 0; row_repeat < scale; row_repeat++) {
-            // Draw each column of the character
-            for (int col = 0; col < 5; col++) {
-                // Check if pixel should be on
-                bool pixel_on = bitmap[col] & (1 << row);
-                
-                // Repeat each pixel 'scale' times for horizontal scaling
-                for (int col_repeat = 0; col_repeat < scale; col_repeat++) {
-                    if (pixel_on) { 
-                        buf[0] = hi; 
-                        buf[1] = lo; 
-                    } else { 
-                        buf[0] = 0; 
-                        buf[1] = 0; 
-                    }
-                    
-                    if (spi_device) {
-                        spi_transaction_t t = { 
-                            .length = 16, 
-                            .tx_buffer = buf 
-                        };
-                        ret = spi_device_transmit(spi_device, &t);
-                        if (ret != ESP_OK) {
-                            ESP_LOGE(TAG, "SPI transmit failed: %s", esp_err_to_name(ret));
-                        }
-                    }
-                }
+        if (used + width > GLYPH_BUF_PIXELS) {
+            ili9341_glyph_flush(&used);
+        }
+        
+        uint16_t *line = &glyph_buf[used];
+        ili9341_font_expand_row(line, rows[row], ILI9341_FONT_WIDTH, scale, pair);
+        used += width;
+        
+        // Repeat the scanline 'scale' times for vertical scaling
+        for (int row_repeat = 1; row_repeat < scale; row_repeat++) {
+            if (used + width > GLYPH_BUF_PIXELS) {
+                ili9341_glyph_flush(&used);
+                memmove(glyph_buf, line, width * 2);
+                line = glyph_buf;
+                used = width;
+                continue;
             }
+            memcpy(&glyph_buf[used], line, width * 2);
+            used += width;
         }
     }
-    gpio_set_level(display_config->pin_cs, 1);
+    ili9341_glyph_flush(&used);
 }
 
-// ==== Draw Text String with Scale ====
-void ili9341_text_scaled(const char *str, uint16_t x, uint16_t y, uint16_t color, uint8_t scale) {
-    if (display_config == NULL || str == NULL || scale == 0) {
+void ili9341_draw_char_scaled(char c, uint16_t x, uint16_t y, uint16_t color, uint8_t scale) {
+    if (display_config == NULL || scale == 0) {
         return;
     }
+    ili9341_draw_glyph(c, x, y, color, scale);
+}
+
+// ==== Draw Text String with Scale ====
+static void ili9341_text_draw(const char *str, int x, int y, uint16_t color, uint8_t scale) {
+    const int char_width = 5 * scale + scale; // scaled font width + spacing
+    int current_x = x;
     
-    uint16_t char_width = 5 * scale + scale; // scaled font width + spacing
-    uint16_t current_x = x;
+    // Rows entirely above or below the clip rectangle cost nothing
+    if (y >= clip.y + clip.h || y + 8 * scale <= clip.y) {
+        return;
+    }
     
     while (*str) {
-        if (current_x > ILI9341_WIDTH) { // Prevent drawing outside screen
+        if (current_x >= clip.x + clip.w) { // Everything further right is clipped
             break;
         }
-        ili9341_draw_char_scaled(*str, current_x, y, color, scale);
+        if (current_x + 5 * scale > clip.x) {
+            ili9341_draw_glyph(*str, current_x, y, color, scale);
+        }
         current_x += char_width;
         str++;
     }
 }
 
+void ili9341_text_scaled(const char *str, uint16_t x, uint16_t y, uint16_t color, uint8_t scale) {
+    if (display_config == NULL || str == NULL || scale == 0) {
+        return;
+    }
+    ILI9341_PERF_BEGIN(perf);
+    ili9341_text_draw(str, x, y, color, scale);
+    ILI9341_PERF_END(ILI9341_PERF_TEXT, perf);
+}
+
+uint16_t ili9341_text_measure(const char *str, uint8_t scale) {
+    if (str == NULL || *str == '\0') {
+        return 0;
+    }
+    // Cells of 6 columns, minus the spacing after the last glyph
+    size_t width = strlen(str) * (ILI9341_FONT_WIDTH + ILI9341_FONT_SPACING) * scale
+                   - ILI9341_FONT_SPACING * scale;
+    return width > UINT16_MAX ? UINT16_MAX : width;
+}
+
+static int ili9341_align_x(const char *str, int x, ili9341_align_t align, uint8_t scale) {
+    switch (align) {
+    case ILI9341_ALIGN_CENTER:
+        return x - ili9341_text_measure(str, scale) / 2;
+    case ILI9341_ALIGN_RIGHT:
+        return x - ili9341_text_measure(str, scale);
+    default:
+        return x;
+    }
+}
+
+void ili9341_text_aligned(const char *str, uint16_t x, uint16_t y, ili9341_align_t align,
+                          uint16_t color, uint8_t scale) {
+    if (display_config == NULL || str == NULL || scale == 0) {
+        return;
+    }
+    ILI9341_PERF_BEGIN(perf);
+    ili9341_text_draw(str, ili9341_align_x(str, x, align, scale), y, color, scale);
+    ILI9341_PERF_END(ILI9341_PERF_TEXT, perf);
+}
+
 // ==== Convenience functions for common sizes ====
 void ili9341_text_small(const char *str, uint16_t x, uint16_t y, uint16_t color) {
     ili9341_text_scaled(str, x, y, color, 1); // 5x8 pixels
@@ -636,6 +687,21 @@ void ili9341_text_xlarge(const char *str, uint16_t x, uint16_t y, uint16_t color
     ili9341_text_scaled(str, x, y, color, 4); // 20x32 pixels
 }
 
+static const uint16_t *fill_source(uint16_t *dst, size_t count, void *arg) {
+    const uint16_t pixel = *(const uint16_t *)arg;
+    uint32_t word = ((uint32_t)pixel << 16) | pixel;
+    uint32_t *dst32 = (uint32_t *)dst;
+    
+    // Two pixels per store; only the last chunk of an odd total is odd
+    for (size_t i = 0; i < count / 2; i++) {
+        dst32[i] = word;
+    }
+    if (count & 1) {
+        dst[count - 1] = pixel;
+    }
+    return dst;
+}
+
 void ili9341_fill(uint16_t color) {
     if (display_config == NULL) {
         ESP_LOGE(TAG, "Display not initialized");
@@ -643,52 +709,233 @@ void ili9341_fill(uint16_t color) {
     }
 
     // Set the entire display area
-    ili9341_set_window(0, 0, ILI9341_WIDTH - 1, ILI9341_HEIGHT - 1);
+    ILI9341_PERF_BEGIN(perf);
+    ili9341_fill_rect(0, 0, screen_width, screen_height, color);
+    ILI9341_PERF_END(ILI9341_PERF_FILL, perf);
+}
+
+void ili9341_fill_rect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) {
+    ili9341_rect_t vis;
+    if (display_config == NULL || !ili9341_clip_rect(x, y, w, h, &vis)) {
+        return;
+    }
     
-    // Prepare the color data (2 bytes per pixel)
-    uint8_t color_hi = color >> 8;
-    uint8_t color_lo = color & 0xFF;
+    ILI9341_PERF_BEGIN(perf);
+    ili9341_set_window(vis.x, vis.y, vis.x + vis.w - 1, vis.y + vis.h - 1);
     
-    // Calculate the number of pixels to fill
-    uint32_t total_pixels = (uint32_t)ILI9341_WIDTH * ILI9341_HEIGHT;
+    uint16_t pixel = ili9341_swap16(color);
+    ili9341_stream_pixels((size_t)vis.w * vis.h, fill_source, &pixel);
+    ILI9341_PERF_END(ILI9341_PERF_FILL_RECT, perf);
+}
+
+// Opaque text is streamed scanline by scanline. Each font row is expanded
+// once into line[] and then repeated 'scale' times.
+typedef struct {
+    const char *str;
+    uint16_t width;          // Window width in pixels (clipped)
+    uint16_t x_off;          // String pixels clipped off on the left
+    uint16_t y_off;          // String rows clipped off at the top
+    uint8_t scale;
+    uint16_t fg;             // Byte swapped
+    uint16_t bg;             // Byte swapped
+    uint32_t pair[4];        // Pixel pairs for the expansion kernel
+    int font_row;            // Font row currently expanded in line[]
+    size_t pos;              // Next pixel of the window
+    uint16_t line[ILI9341_WIDTH];
+} text_stream_t;
+
+static void text_expand_row(text_stream_t *ts, int font_row) {
+    const int cols = ILI9341_FONT_WIDTH + ILI9341_FONT_SPACING;
+    const uint16_t cell = cols * ts->scale;
+    uint32_t px = ts->x_off;   // Position in the unclipped scanline
+    uint16_t x = 0;
+    
+    while (x < ts->width) {
+        const int within = px % cell;
+        uint8_t mask = ili9341_font_rows(ts->str[px / cell])[font_row];
+        
+        if (within == 0 && x + cell <= ts->width) {
+            // Whole cells, spacing column included, go through the fast kernel
+            ili9341_font_expand_row(&ts->line[x], mask, cols, ts->scale, ts->pair);
+            x += cell;
+            px += cell;
+        } else {
+            // Cells cut by the left or right clip edge
+            ts->line[x++] = (uint16_t)ts->pair[(mask >> (within / ts->scale)) & 1];
+            px++;
+        }
+    }
+    ts->font_row = font_row;
+}
+
+static const uint16_t *text_source(uint16_t *dst, size_t count, void *arg) {
+    text_stream_t *ts = (text_stream_t *)arg;
+    size_t done = 0;
+    
+    while (done < count) {
+        int row = ts->pos / ts->width + ts->y_off;
+        int col = ts->pos % ts->width;
+        size_t n = ts->width - col;
+        if (n > count - done) {
+            n = count - done;
+        }
+        
+        int font_row = row / ts->scale;
+        if (font_row != ts->font_row) {
+            text_expand_row(ts, font_row);
+        }
+        memcpy(&dst[done], &ts->line[col], n * 2);
+        done += n;
+        ts->pos += n;
+    }
+    return dst;
+}
+
+static void ili9341_text_bg_draw(const char *str, int x, int y, uint16_t fg, uint16_t bg, uint8_t scale) {
+    const size_t cell = (ILI9341_FONT_WIDTH + ILI9341_FONT_SPACING) * scale;
+    const size_t len = strlen(str);
     
-    // Fill in chunks to avoid large stack allocations
-    const uint16_t chunk_size = 64; // Number of pixels to process at once
-    uint8_t pixel_data[chunk_size * 2]; // 2 bytes per pixel
+    ili9341_rect_t vis;
+    if (len == 0 || !ili9341_clip_rect(x, y, len * cell, ILI9341_FONT_HEIGHT * scale, &vis)) {
+        return;
+    }
+    
+    // Static: line[] is too big for the callers' stacks
+    static text_stream_t ts;
+    ts = (text_stream_t) {
+        .str = str,
+        .width = vis.w,
+        .x_off = vis.x - x,
+        .y_off = vis.y - y,
+        .scale = scale,
+        .fg = ili9341_swap16(fg),
+        .bg = ili9341_swap16(bg),
+        .font_row = -1,
+        .pos = 0,
+    };
+    ili9341_font_pair_lut(ts.pair, ts.fg, ts.bg);
     
-    // Fill the pixel data buffer with the specified color
-    for (int i = 0; i < chunk_size; i++) {
-        pixel_data[i * 2] = color_hi;
-        pixel_data[i * 2 + 1] = color_lo;
+    ili9341_set_window(vis.x, vis.y, vis.x + vis.w - 1, vis.y + vis.h - 1);
+    ili9341_stream_pixels((size_t)vis.w * vis.h, text_source, &ts);
+}
+
+void ili9341_text_bg(const char *str, uint16_t x, uint16_t y, uint16_t fg, uint16_t bg, uint8_t scale) {
+    if (display_config == NULL || str == NULL || scale == 0) {
+        return;
+    }
+    ILI9341_PERF_BEGIN(perf);
+    ili9341_text_bg_draw(str, x, y, fg, bg, scale);
+    ILI9341_PERF_END(ILI9341_PERF_TEXT_BG, perf);
+}
+
+void ili9341_text_bg_aligned(const char *str, uint16_t x, uint16_t y, ili9341_align_t align,
+                             uint16_t fg, uint16_t bg, uint8_t scale) {
+    if (display_config == NULL || str == NULL || scale == 0) {
+        return;
     }
+    ILI9341_PERF_BEGIN(perf);
+    ili9341_text_bg_draw(str, ili9341_align_x(str, x, align, scale), y, fg, bg, scale);
+    ILI9341_PERF_END(ILI9341_PERF_TEXT_BG, perf);
+}
+
+static const uint16_t *bitmap_source(uint16_t *dst, size_t count, void *arg) {
+    const uint16_t **src = (const uint16_t **)arg;
     
-    // Send data in chunks
-    uint32_t pixels_remaining = total_pixels;
-    while (pixels_remaining > 0) {
-        uint16_t pixels_to_send = (pixels_remaining > chunk_size) ? chunk_size : pixels_remaining;
-        
-        // Set DC high for data
-        gpio_set_level(display_config->pin_dc, 1);
-        gpio_set_level(display_config->pin_cs, 0);
-        
-        // Send pixel data
-        if (spi_device) {
-            spi_transaction_t t = {
-                .length = pixels_to_send * 16, // 16 bits per pixel
-                .tx_buffer = pixel_data
-            };
-            
-            esp_err_t ret = spi_device_transmit(spi_device, &t);
-            if (ret != ESP_OK) {
-                ESP_LOGE(TAG, "SPI transmit failed: %s", esp_err_to_name(ret));
-                break;
-            }
-        }
-        
-        // Update remaining pixels
-        pixels_remaining -= pixels_to_send;
-        
-        // Deselect display
-        gpio_set_level(display_config->pin_cs, 1);
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = ili9341_swap16((*src)[i]);
+    }
+    *src += count;
+    return dst;
+}
+
+void ili9341_draw_bitmap(uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint16_t *pixels) {
+    if (display_config == NULL || pixels == NULL || w == 0 || h == 0) {
+        return;
+    }
+    
+    ILI9341_PERF_BEGIN(perf);
+    ili9341_set_window(x, y, x + w - 1, y + h - 1);
+    
+    const uint16_t *src = pixels;
+    ili9341_stream_pixels((size_t)w * h, bitmap_source, &src);
+    ILI9341_PERF_END(ILI9341_PERF_BITMAP, perf);
+}
+
+static const uint16_t *blit_source(uint16_t *dst, size_t count, void *arg) {
+    const uint16_t **src = (const uint16_t **)arg;
+    const uint16_t *chunk = *src;
+    
+    (void)dst;
+    *src += count;
+    return chunk;
+}
+
+void ili9341_blit(uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint16_t *pixels) {
+    if (display_config == NULL || pixels == NULL || w == 0 || h == 0) {
+        return;
+    }
+    
+    ILI9341_PERF_BEGIN(perf);
+    ili9341_set_window(x, y, x + w - 1, y + h - 1);
+    
+    const uint16_t *src = pixels;
+    ili9341_stream_pixels((size_t)w * h, blit_source, &src);
+    ILI9341_PERF_END(ILI9341_PERF_BITMAP, perf);
+}
+
+void ili9341_send_cmd(uint8_t cmd, const uint8_t *params, size_t len) {
+    if (display_config == NULL) return;
+    
+    ili9341_transport_select();
+    esp_err_t ret = ili9341_transport_write_cmd(cmd, params, len);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Command 0x%02x failed: %s", cmd, esp_err_to_name(ret));
+    }
+    ili9341_transport_deselect();
+}
+
+void ili9341_set_madctl(uint8_t madctl, uint16_t width, uint16_t height) {
+    ili9341_send_cmd(0x36, &madctl, 1);
+    madctl_value = madctl;
+    screen_width = width;
+    screen_height = height;
+    ili9341_set_clip(NULL);
+}
+
+bool ili9341_is_initialized(void) {
+    return is_initialized;
+}
+
+uint8_t ili9341_get_madctl(void) {
+    return madctl_value;
+}
+
+uint32_t ili9341_get_transaction_count(void) {
+    ili9341_bus_stats_t stats;
+    ili9341_transport_get_stats(&stats);
+    return stats.transactions;
+}
+
+void ili9341_reset_transaction_count(void) {
+    ili9341_transport_reset_stats();
+}
+
+void ili9341_get_boot_timing(ili9341_boot_timing_t *timing) {
+    if (timing != NULL) {
+        *timing = boot_timing;
     }
-}
\ No newline at end of file
+}
+
+int ili9341_get_spi_clock(void) {
+    return is_initialized ? ili9341_transport_get_clock() : 0;
+}
+
+void ili9341_get_bus_stats(ili9341_bus_stats_t *stats) {
+    if (stats != NULL) {
+        ili9341_transport_get_stats(stats);
+    }
+}
+
+void ili9341_reset_bus_stats(void) {
+    ili9341_transport_reset_stats();
+}
@@ -2,16 +2,30 @@
 #define DISPLAY_H
 
 #include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "sdkconfig.h"
+#include "esp_err.h"
+#include "display_panel.h"
+#if CONFIG_IDF_TARGET_LINUX
+// The Linux build drives a virtual panel; keep configs source compatible
+typedef enum { SPI1_HOST, SPI2_HOST, SPI3_HOST } spi_host_device_t;
+#else
 #include "driver/spi_master.h"
 #include "driver/gpio.h"
+#endif
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 // ==== Configuration Constants ====
-#define ILI9341_WIDTH  320
-#define ILI9341_HEIGHT 240
+// Landscape screen size of the panel selected in Kconfig
+#define ILI9341_WIDTH  ILI9341_PANEL_ROWS
+#define ILI9341_HEIGHT ILI9341_PANEL_COLS
+
+// Most glyph blocks the cache will hold, whatever its byte budget
+#define ILI9341_GLYPH_CACHE_MAX_ENTRIES 128
 
 // ==== Color Definitions ====
 #define ILI9341_BLACK   0x0000
@@ -24,6 +38,8 @@ extern "C" {
 #define ILI9341_MAGENTA 0xF81F
 
 // ==== Configuration Structure ====
+#define ILI9341_MAX_QUEUE_DEPTH 4
+
 typedef struct {
     // SPI Configuration
     spi_host_device_t spi_host;
@@ -37,10 +53,99 @@ typedef struct {
     int pin_rst;
     int pin_bckl;
     
-    // SPI Speed
+    // SPI Speed: spi_clock_speed_hz is used as is (0 = 40 MHz) unless
+    // spi_clock_max_hz is higher, in which case ili9341_init() picks the
+    // fastest clock in between that passes calibration
     int spi_clock_speed_hz;
+    int spi_clock_max_hz;
+    
+    // Largest single transfer and size of each streaming DMA buffer
+    // (0 = 16 lines, 10 KB; longer writes are split)
+    size_t max_transfer_bytes;
+    
+    // Streaming buffers, i.e. transfers in flight at once
+    // (0 = 2, at most ILI9341_MAX_QUEUE_DEPTH)
+    uint8_t queue_depth;
+    
+    // Let the SPI peripheral drive pin_cs instead of toggling it by hand
+    bool hw_cs;
+    
+    // Bytes of DMA memory for cached expanded glyphs (0 disables the cache)
+    size_t glyph_cache_bytes;
 } ili9341_config_t;
 
+// ==== Bus Counters ====
+typedef struct {
+    uint32_t transactions;   // Transfers issued (command, parameter and pixel)
+    uint64_t bytes;          // Bytes sent
+    uint32_t gpio_toggles;   // Software-driven level changes on DC/CS/RST/backlight
+    uint64_t wire_time_us;   // Time the bytes take on the wire at the clock each went out at
+} ili9341_bus_stats_t;
+
+// ==== Boot Timing ====
+// Microseconds from the start of panel bring-up in ili9341_init(), so
+// each field includes the ones before it
+typedef struct {
+    int64_t reset_us;        // Hardware reset and recovery done
+    int64_t config_us;       // Register table sent, sleep out settled
+    int64_t calib_us;        // SPI clock calibrated (same as config_us without calibration)
+    int64_t clear_us;        // GRAM cleared to black (display still off)
+    int64_t total_us;        // Display on: first pixels visible
+} ili9341_boot_timing_t;
+
+// ==== Power Modes ====
+// Flags for ili9341_set_power_mode(); idle and partial combine, sleep
+// overrides both while it lasts
+#define ILI9341_POWER_NORMAL  0x00
+#define ILI9341_POWER_IDLE    0x01   // 8 colours: only the MSB of each channel
+#define ILI9341_POWER_PARTIAL 0x02   // Only the scan lines of the partial area are driven
+#define ILI9341_POWER_SLEEP   0x04   // Panel and backlight off, GRAM kept
+
+// ==== Glyph Cache Counters ====
+typedef struct {
+    uint32_t hits;           // Glyphs sent straight from the cache
+    uint32_t misses;         // Glyphs that had to be expanded
+    uint32_t evictions;      // Entries dropped to stay within the budget
+    uint16_t entries;        // Glyph blocks currently cached
+    size_t bytes_used;       // Pixel memory held by the cache
+    size_t budget;           // Configured glyph_cache_bytes
+} ili9341_glyph_cache_stats_t;
+
+// ==== Geometry ====
+typedef struct {
+    uint16_t x;
+    uint16_t y;
+    uint16_t w;
+    uint16_t h;
+} ili9341_rect_t;
+
+// Horizontal anchor for the *_aligned text calls
+typedef enum {
+    ILI9341_ALIGN_LEFT,      // x is the left edge of the text
+    ILI9341_ALIGN_CENTER,    // x is the middle of the text
+    ILI9341_ALIGN_RIGHT,     // x is one past the right edge of the text
+} ili9341_align_t;
+
+// ==== Compressed Images ====
+//
+// Palette-indexed, run-length encoded images, produced at build time by
+// gen_image.py. The encoded stream is a sequence of packets covering the
+// image row by row (runs may cross rows):
+//
+//   0x80 | (n - 1), index        n copies of palette[index]   (n = 1..128)
+//   n - 1, index x n             n literal palette indices    (n = 1..128)
+//
+// Everything is const, so on the ESP32 it stays in memory-mapped flash and
+// is decoded straight into the DMA buffers.
+typedef struct {
+    uint16_t width;
+    uint16_t height;
+    uint16_t palette_len;
+    const uint16_t *palette;   // RGB565, already in panel (big-endian) byte order
+    const uint8_t *data;       // RLE packets
+    uint32_t data_len;         // Bytes in data
+} ili9341_image_t;
+
 // ==== Public Function Declarations ====
 
 /**
@@ -56,11 +161,68 @@ esp_err_t ili9341_init(const ili9341_config_t *config);
 void ili9341_deinit(void);
 
 /**
- * @brief Fill the entire screen with a color
+ * @brief Fill the entire screen (within the clip rectangle) with a color
  * @param color 16-bit RGB565 color value
  */
 void ili9341_fill(uint16_t color);
 
+/**
+ * @brief Fill a rectangle with a solid color
+ *
+ * Sent as one windowed burst through the same DMA path as ili9341_fill().
+ * The rectangle is clipped to the screen and the clip rectangle.
+ *
+ * @param x X coordinate of the top-left corner
+ * @param y Y coordinate of the top-left corner
+ * @param w Width in pixels
+ * @param h Height in pixels
+ * @param color 16-bit RGB565 color value
+ */
+void ili9341_fill_rect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color);
+
+/**
+ * @brief Draw a rectangular block of pixels
+ *
+ * Pixels are streamed through double-buffered DMA, so the source may live
+ * anywhere (including flash) and does not need to be DMA capable.
+ *
+ * @param x X coordinate of the top-left corner
+ * @param y Y coordinate of the top-left corner
+ * @param w Width in pixels
+ * @param h Height in pixels
+ * @param pixels w*h RGB565 values, row-major
+ */
+void ili9341_draw_bitmap(uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint16_t *pixels);
+
+/**
+ * @brief Draw a compressed image
+ *
+ * The image is decoded chunk by chunk into the DMA buffers while the
+ * previous chunk is on the wire; no full-size copy is ever made and
+ * nothing is allocated. Output is clipped to the screen and the clip
+ * rectangle. A truncated or corrupt stream is padded with black.
+ *
+ * @param img Image generated by gen_image.py
+ * @param x X coordinate of the top-left corner
+ * @param y Y coordinate of the top-left corner
+ */
+void ili9341_draw_image(const ili9341_image_t *img, uint16_t x, uint16_t y);
+
+/**
+ * @brief Send a block of pixels that is already in panel byte order
+ *
+ * Zero-copy variant of ili9341_draw_bitmap(): the buffer is handed to the
+ * SPI DMA directly, so it must be DMA capable and hold byte-swapped
+ * (big-endian) RGB565 values. Returns once the transfer has completed.
+ *
+ * @param x X coordinate of the top-left corner
+ * @param y Y coordinate of the top-left corner
+ * @param w Width in pixels
+ * @param h Height in pixels
+ * @param pixels w*h byte-swapped RGB565 values, row-major
+ */
+void ili9341_blit(uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint16_t *pixels);
+
 /**
  * @brief Set the drawing window (region of interest)
  * @param x0 Starting X coordinate
@@ -123,12 +285,134 @@ void ili9341_text_large(const char *str, uint16_t x, uint16_t y, uint16_t color)
  */
 void ili9341_text_xlarge(const char *str, uint16_t x, uint16_t y, uint16_t color);
 
+/**
+ * @brief Draw text with an opaque background
+ *
+ * Every character cell, including the spacing column, is painted in fg or
+ * bg, and the whole string goes out as one windowed burst. Drawing over a
+ * previous string of the same length replaces it without a separate clear.
+ * Output is clipped to the screen and the clip rectangle.
+ *
+ * @param str String to display
+ * @param x X coordinate
+ * @param y Y coordinate
+ * @param fg 16-bit RGB565 text color
+ * @param bg 16-bit RGB565 background color
+ * @param scale Size multiplier (1 = 5x8 glyphs in 6x8 cells)
+ */
+void ili9341_text_bg(const char *str, uint16_t x, uint16_t y, uint16_t fg, uint16_t bg, uint8_t scale);
+
+/**
+ * @brief Get the width of a string in pixels
+ *
+ * Covers the glyphs only, without the spacing column after the last one,
+ * so it can be used to centre or right-align text exactly.
+ *
+ * @param str String to measure
+ * @param scale Size multiplier
+ * @return Width in pixels; the height is always 8 * scale
+ */
+uint16_t ili9341_text_measure(const char *str, uint8_t scale);
+
+/**
+ * @brief Draw text anchored at x according to align
+ *
+ * Text that ends up partly off screen is clipped, not shifted.
+ *
+ * @param str String to display
+ * @param x Anchor X coordinate
+ * @param y Y coordinate
+ * @param align Which part of the text x refers to
+ * @param color 16-bit RGB565 color value
+ * @param scale Size multiplier
+ */
+void ili9341_text_aligned(const char *str, uint16_t x, uint16_t y, ili9341_align_t align,
+                          uint16_t color, uint8_t scale);
+
+/**
+ * @brief Opaque-background version of ili9341_text_aligned()
+ * @param str String to display
+ * @param x Anchor X coordinate
+ * @param y Y coordinate
+ * @param align Which part of the text x refers to
+ * @param fg 16-bit RGB565 text color
+ * @param bg 16-bit RGB565 background color
+ * @param scale Size multiplier
+ */
+void ili9341_text_bg_aligned(const char *str, uint16_t x, uint16_t y, ili9341_align_t align,
+                             uint16_t fg, uint16_t bg, uint8_t scale);
+
+/**
+ * @brief Restrict text and rectangle drawing to a rectangle
+ *
+ * Glyphs and rows outside the rectangle are skipped before any window is
+ * set, so clipped-away output costs no bus traffic. Glyphs cut by the
+ * edge send only their visible pixels. The rectangle is intersected with
+ * the screen and reset whenever the orientation changes.
+ *
+ * @param rect Clip rectangle, or NULL to clip to the whole screen
+ */
+void ili9341_set_clip(const ili9341_rect_t *rect);
+
 /**
  * @brief Set backlight state
+ *
+ * Switches between off and the level from ili9341_set_backlight_level().
+ * Has no visible effect while the panel sleeps.
+ *
  * @param state true to turn on, false to turn off
  */
 void ili9341_set_backlight(bool state);
 
+/**
+ * @brief Set the backlight dim level
+ *
+ * Dims through LEDC PWM with CONFIG_ILI9341_BCKL_PWM; otherwise any level
+ * above 0 is fully on.
+ *
+ * @param percent 0 to 100 (100 after init)
+ */
+void ili9341_set_backlight_level(uint8_t percent);
+
+/**
+ * @brief Switch panel power modes without re-running the init sequence
+ *
+ * Registers and GRAM survive every mode, so leaving one only takes the
+ * matching exit command: IDMOFF for idle, NORON for partial, and SLPOUT
+ * plus DISPON for sleep (with the datasheet's 5 ms wait in between).
+ * The 120 ms the controller needs between SLPOUT and SLPIN is enforced
+ * by waiting, so calling this in quick succession is safe but may block.
+ *
+ * The panel can only blank whole scan lines. In landscape these run
+ * across the screen's x axis, so the partial area keeps full columns:
+ * everything between the left and right edge of partial stays visible.
+ *
+ * Drawing works in every mode; while asleep it lands in GRAM and shows
+ * on resume.
+ *
+ * @param modes ILI9341_POWER_* flags, ILI9341_POWER_NORMAL to leave all
+ * @param partial Area to keep visible with ILI9341_POWER_PARTIAL (screen
+ *                coordinates, current orientation), otherwise ignored
+ * @return ESP_OK, ESP_ERR_INVALID_ARG if partial is missing or empty,
+ *         ESP_ERR_INVALID_STATE if not initialized
+ */
+esp_err_t ili9341_set_power_mode(uint8_t modes, const ili9341_rect_t *partial);
+
+/**
+ * @brief Get the current ILI9341_POWER_* flags
+ */
+uint8_t ili9341_get_power_mode(void);
+
+/**
+ * @brief Latency of the last return to ILI9341_POWER_NORMAL
+ *
+ * Measured from the ili9341_set_power_mode() call until the panel shows
+ * the image again (display on and backlight restored).
+ *
+ * @return Microseconds, 0 if the panel hasn't left normal mode yet
+ */
+uint32_t ili9341_get_resume_us(void);
+
 /**
  * @brief Convert RGB values to RGB565 color
  * @param r Red component (0-255)
@@ -137,6 +421,66 @@ void ili9341_set_backlight(bool state);
  * @return 16-bit RGB565 color value
  */
 uint16_t ili9341_color_rgb(uint8_t r, uint8_t g, uint8_t b);
+
+/**
+ * @brief Get the number of SPI transactions issued to the panel
+ * @return Transactions since init or the last reset
+ */
+uint32_t ili9341_get_transaction_count(void);
+
+/**
+ * @brief Reset the SPI transaction counter to zero
+ */
+void ili9341_reset_transaction_count(void);
+
+/**
+ * @brief Get the time spent in each phase of panel bring-up
+ * @param timing Receives the timestamps recorded by the last ili9341_init()
+ */
+void ili9341_get_boot_timing(ili9341_boot_timing_t *timing);
+
+/**
+ * @brief Get the SPI clock the bus actually runs at
+ *
+ * The configured or calibrated clock, rounded to what the SPI peripheral
+ * can generate.
+ *
+ * @return Clock in Hz, 0 if not initialized
+ */
+int ili9341_get_spi_clock(void);
+
+/**
+ * @brief Get bus counters since init or the last reset
+ * @param stats Receives the counters
+ */
+void ili9341_get_bus_stats(ili9341_bus_stats_t *stats);
+
+/**
+ * @brief Reset all bus counters (including the transaction count) to zero
+ */
+void ili9341_reset_bus_stats(void);
+
+/**
+ * @brief Get glyph cache counters
+ *
+ * Each character drawn with ili9341_text_*() is cached as its expanded
+ * RGB565 block, keyed by character, scale and colours. A hit sends the
+ * block to the panel as is; least recently used blocks are evicted once
+ * glyph_cache_bytes would be exceeded.
+ *
+ * @param stats Receives the counters
+ */
+void ili9341_glyph_cache_get_stats(ili9341_glyph_cache_stats_t *stats);
+
+/**
+ * @brief Reset the hit, miss and eviction counters
+ */
+void ili9341_glyph_cache_reset_stats(void);
+
+/**
+ * @brief Drop every cached glyph and free its memory
+ */
+void ili9341_glyph_cache_clear(void);
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,108 @@
+#include "display_console.h"
+#include "display.h"
+#include "display_priv.h"
+#include <string.h>
+
+// Portrait geometry; one text row per 8 GRAM lines
+#define CONSOLE_WIDTH  ILI9341_HEIGHT
+#define CONSOLE_HEIGHT ILI9341_WIDTH
+
+// The scroll area covers the whole panel, so the row ring must too, or
+// scrolling would bring GRAM lines the ring never writes into view
+_Static_assert(ILI9341_CONSOLE_ROWS * ILI9341_FONT_HEIGHT == CONSOLE_HEIGHT,
+               "console rows must fill the scroll area");
+_Static_assert(ILI9341_CONSOLE_COLS * (ILI9341_FONT_WIDTH + ILI9341_FONT_SPACING) <= CONSOLE_WIDTH,
+               "console columns wider than the screen");
+
+// ==== Private Variables ====
+static bool active = false;
+static uint16_t background = ILI9341_BLACK;
+static uint16_t rows_used = 0;   // Rows written since start, up to ILI9341_CONSOLE_ROWS
+static uint16_t top_row = 0;     // GRAM row shown at the top of the screen
+
+static void set_scroll_start(uint16_t line) {
+    uint8_t vsp[2] = { line >> 8, line & 0xFF };
+    ili9341_send_cmd(0x37, vsp, 2);
+}
+
+static void console_line(const char *text, size_t len, uint16_t color) {
+    uint16_t row;
+    bool scroll = false;
+
+    if (rows_used < ILI9341_CONSOLE_ROWS) {
+        row = rows_used++;
+    } else {
+        // Reuse the oldest row, then scroll it from the top to the bottom
+        row = top_row;
+        top_row = (top_row + 1) % ILI9341_CONSOLE_ROWS;
+        scroll = true;
+    }
+
+    // Pad to the full width so the old contents of the row are replaced
+    // in the same burst
+    char line[ILI9341_CONSOLE_COLS + 1];
+    memcpy(line, text, len);
+    memset(line + len, ' ', ILI9341_CONSOLE_COLS - len);
+    line[ILI9341_CONSOLE_COLS] = '\0';
+    ili9341_text_bg(line, 0, row * ILI9341_FONT_HEIGHT, color, background, 1);
+
+    if (scroll) {
+        set_scroll_start(top_row * ILI9341_FONT_HEIGHT);
+    }
+}
+
+void ili9341_console_start(uint16_t bg) {
+    background = bg;
+    rows_used = 0;
+    top_row = 0;
+
+    ili9341_set_madctl(ILI9341_MADCTL_PORTRAIT, CONSOLE_WIDTH, CONSOLE_HEIGHT);
+
+    // Whole panel is the scroll area: no fixed top or bottom band
+    uint8_t vscrdef[6] = {
+        0x00, 0x00,
+        CONSOLE_HEIGHT >> 8, CONSOLE_HEIGHT & 0xFF,
+        0x00, 0x00
+    };
+    ili9341_send_cmd(0x33, vscrdef, 6);
+    set_scroll_start(0);
+
+    ili9341_fill(bg);
+    active = true;
+}
+
+void ili9341_console_print(const char *text, uint16_t color) {
+    if (!active || text == NULL) {
+        return;
+    }
+
+    do {
+        size_t len = strcspn(text, "\n");
+        const char *next = text + len;
+
+        // Wrap long lines
+        while (len > ILI9341_CONSOLE_COLS) {
+            console_line(text, ILI9341_CONSOLE_COLS, color);
+            text += ILI9341_CONSOLE_COLS;
+            len -= ILI9341_CONSOLE_COLS;
+        }
+        console_line(text, len, color);
+
+        text = (*next == '\n') ? next + 1 : next;
+    } while (*text != '\0');
+}
+
+void ili9341_console_stop(uint16_t bg) {
+    if (!active) {
+        return;
+    }
+
+    set_scroll_start(0);
+    ili9341_set_madctl(ILI9341_MADCTL_LANDSCAPE, ILI9341_WIDTH, ILI9341_HEIGHT);
+    ili9341_fill(bg);
+    active = false;
+}
+
+bool ili9341_console_active(void) {
+    return active;
+}
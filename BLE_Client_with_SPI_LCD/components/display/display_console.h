@@ -0,0 +1,65 @@
+#ifndef DISPLAY_CONSOLE_H
+#define DISPLAY_CONSOLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "display_panel.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ==== Scrolling Console ====
+//
+// Turns the panel into a character terminal (40x40 on a 240x320 panel)
+// using the hardware vertical scroll. The panel only scrolls along its
+// native row axis, so the console switches to portrait. Once the
+// screen is full, each new line overwrites the oldest one in GRAM and the
+// scroll start address (0x37) is moved past it: one line render plus a
+// 2-byte register write, whatever is on screen. Nothing is ever redrawn.
+//
+// Draws straight to the panel, like the calls in display.h.
+
+// One 6x8 cell per character (5x8 font plus a column of spacing), over
+// the whole portrait screen: the scroll area is exactly the row ring
+#define ILI9341_CONSOLE_COLS (ILI9341_PANEL_COLS / 6)
+#define ILI9341_CONSOLE_ROWS (ILI9341_PANEL_ROWS / 8)
+
+/**
+ * @brief Switch to portrait, clear the screen and set up scrolling
+ * @param bg 16-bit RGB565 background color
+ */
+void ili9341_console_start(uint16_t bg);
+
+/**
+ * @brief Append text, scrolling as needed
+ *
+ * '\n' starts a new line and lines longer than ILI9341_CONSOLE_COLS wrap.
+ * Each call starts on a fresh line.
+ *
+ * @param text Text to append
+ * @param color 16-bit RGB565 text color
+ */
+void ili9341_console_print(const char *text, uint16_t color);
+
+/**
+ * @brief Leave console mode: landscape, no scroll offset, cleared screen
+ *
+ * Anything that remembers panel contents (strip renderer, widgets) must
+ * be invalidated afterwards.
+ *
+ * @param bg 16-bit RGB565 color to clear the screen with
+ */
+void ili9341_console_stop(uint16_t bg);
+
+/**
+ * @brief Check whether console mode is on
+ * @return true between ili9341_console_start() and ili9341_console_stop()
+ */
+bool ili9341_console_active(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DISPLAY_CONSOLE_H
@@ -0,0 +1,394 @@
+#include "display_fb.h"
+#include "display.h"
+#include "display_priv.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include <string.h>
+
+static const char *TAG = "ILI9341_FB";
+
+typedef enum {
+    FB_OP_FILL_RECT,
+    FB_OP_TEXT,
+    FB_OP_IMAGE,
+} fb_op_type_t;
+
+// One primitive of a frame. Ops are compared with memcmp(), so they are
+// always zeroed before being filled in.
+typedef struct {
+    uint8_t type;
+    uint8_t scale;
+    uint16_t color;
+    uint16_t x;
+    uint16_t y;
+    ili9341_rect_t bounds;  // Screen area touched, already clipped
+    const ili9341_image_t *image;
+    char text[ILI9341_FB_TEXT_MAX + 1];
+} fb_op_t;
+
+typedef struct {
+    fb_op_t ops[ILI9341_FB_MAX_OPS];
+    int count;
+} fb_frame_t;
+
+// ==== Private Variables ====
+static uint16_t *strip_buf = NULL;
+static uint16_t strip_rows = 0;
+static fb_frame_t frames[2];
+static fb_frame_t *cur = &frames[0];   // Frame being described
+static fb_frame_t *prev = &frames[1];  // Frame currently on the panel
+static bool full_redraw = true;
+static ili9341_rect_t dirty[ILI9341_FB_MAX_DIRTY];
+static int dirty_count = 0;
+
+// ==== Rectangle Helpers ====
+static inline bool rect_empty(const ili9341_rect_t *r) {
+    return r->w == 0 || r->h == 0;
+}
+
+static bool rect_intersect(const ili9341_rect_t *a, const ili9341_rect_t *b, ili9341_rect_t *out) {
+    int x0 = a->x > b->x ? a->x : b->x;
+    int y0 = a->y > b->y ? a->y : b->y;
+    int x1 = (a->x + a->w < b->x + b->w) ? a->x + a->w : b->x + b->w;
+    int y1 = (a->y + a->h < b->y + b->h) ? a->y + a->h : b->y + b->h;
+
+    if (x1 <= x0 || y1 <= y0) {
+        return false;
+    }
+    *out = (ili9341_rect_t) { x0, y0, x1 - x0, y1 - y0 };
+    return true;
+}
+
+static ili9341_rect_t rect_union(const ili9341_rect_t *a, const ili9341_rect_t *b) {
+    int x0 = a->x < b->x ? a->x : b->x;
+    int y0 = a->y < b->y ? a->y : b->y;
+    int x1 = (a->x + a->w > b->x + b->w) ? a->x + a->w : b->x + b->w;
+    int y1 = (a->y + a->h > b->y + b->h) ? a->y + a->h : b->y + b->h;
+
+    return (ili9341_rect_t) { x0, y0, x1 - x0, y1 - y0 };
+}
+
+static inline uint32_t rect_area(const ili9341_rect_t *r) {
+    return (uint32_t)r->w * r->h;
+}
+
+// Clip an arbitrary rectangle to the screen
+static ili9341_rect_t rect_clip_screen(int x, int y, int w, int h) {
+    static const ili9341_rect_t screen = { 0, 0, ILI9341_WIDTH, ILI9341_HEIGHT };
+    ili9341_rect_t r = { 0, 0, 0, 0 };
+
+    if (w <= 0 || h <= 0 || x >= ILI9341_WIDTH || y >= ILI9341_HEIGHT) {
+        return r;
+    }
+    ili9341_rect_t in = { x, y, w, h };
+    rect_intersect(&in, &screen, &r);
+    return r;
+}
+
+// Add a region to the dirty list. Overlapping regions are merged; when the
+// list is full the new region is merged into whichever entry grows least.
+// A merged region can reach entries it didn't touch before, so it is taken
+// out of the list and checked again until it overlaps none: entries stay
+// disjoint and the flush never sends a pixel twice.
+static void dirty_add(const ili9341_rect_t *r) {
+    if (rect_empty(r)) {
+        return;
+    }
+
+    ili9341_rect_t m = *r;
+    ili9341_rect_t overlap;
+    for (;;) {
+        int i = 0;
+        while (i < dirty_count && !rect_intersect(&dirty[i], &m, &overlap)) {
+            i++;
+        }
+
+        if (i == dirty_count) {
+            if (dirty_count < ILI9341_FB_MAX_DIRTY) {
+                dirty[dirty_count++] = m;
+                return;
+            }
+
+            uint32_t best_growth = UINT32_MAX;
+            for (int j = 0; j < dirty_count; j++) {
+                ili9341_rect_t u = rect_union(&dirty[j], &m);
+                uint32_t growth = rect_area(&u) - rect_area(&dirty[j]);
+                if (growth < best_growth) {
+                    best_growth = growth;
+                    i = j;
+                }
+            }
+        }
+
+        // Each pass takes one entry out, so this ends
+        m = rect_union(&dirty[i], &m);
+        dirty[i] = dirty[--dirty_count];
+    }
+}
+
+// ==== Frame Description ====
+static fb_op_t *op_alloc(void) {
+    if (cur->count >= ILI9341_FB_MAX_OPS) {
+        ESP_LOGW(TAG, "Frame full, primitive dropped");
+        return NULL;
+    }
+    fb_op_t *op = &cur->ops[cur->count++];
+    memset(op, 0, sizeof(*op));
+    return op;
+}
+
+esp_err_t ili9341_fb_init(uint16_t strip_height) {
+    if (strip_height == 0 || strip_height > ILI9341_HEIGHT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ili9341_fb_deinit();
+
+    strip_buf = heap_caps_malloc((size_t)ILI9341_WIDTH * strip_height * sizeof(uint16_t),
+                                 MALLOC_CAP_DMA);
+    if (strip_buf == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate %d-row strip buffer", strip_height);
+        return ESP_ERR_NO_MEM;
+    }
+    strip_rows = strip_height;
+
+    frames[0].count = 0;
+    frames[1].count = 0;
+    full_redraw = true;
+
+    ESP_LOGI(TAG, "Strip renderer ready (%dx%d, %d bytes)", ILI9341_WIDTH, strip_height,
+             (int)(ILI9341_WIDTH * strip_height * sizeof(uint16_t)));
+    return ESP_OK;
+}
+
+void ili9341_fb_deinit(void) {
+    heap_caps_free(strip_buf);
+    strip_buf = NULL;
+    strip_rows = 0;
+}
+
+void ili9341_fb_begin(void) {
+    cur->count = 0;
+}
+
+void ili9341_fb_fill(uint16_t color) {
+    ili9341_fb_fill_rect(0, 0, ILI9341_WIDTH, ILI9341_HEIGHT, color);
+}
+
+void ili9341_fb_fill_rect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) {
+    ili9341_rect_t bounds = rect_clip_screen(x, y, w, h);
+    if (rect_empty(&bounds)) {
+        return;
+    }
+
+    fb_op_t *op = op_alloc();
+    if (op == NULL) {
+        return;
+    }
+    op->type = FB_OP_FILL_RECT;
+    op->color = color;
+    op->x = x;
+    op->y = y;
+    op->bounds = bounds;
+}
+
+void ili9341_fb_text(const char *str, uint16_t x, uint16_t y, uint16_t color, uint8_t scale) {
+    if (str == NULL || *str == '\0' || scale == 0) {
+        return;
+    }
+
+    size_t len = strnlen(str, ILI9341_FB_TEXT_MAX);
+    int advance = (ILI9341_FONT_WIDTH + ILI9341_FONT_SPACING) * scale;
+    ili9341_rect_t bounds = rect_clip_screen(x, y,
+                                             (int)len * advance - ILI9341_FONT_SPACING * scale,
+                                             ILI9341_FONT_HEIGHT * scale);
+    if (rect_empty(&bounds)) {
+        return;
+    }
+
+    fb_op_t *op = op_alloc();
+    if (op == NULL) {
+        return;
+    }
+    op->type = FB_OP_TEXT;
+    op->scale = scale;
+    op->color = color;
+    op->x = x;
+    op->y = y;
+    op->bounds = bounds;
+    memcpy(op->text, str, len);
+}
+
+void ili9341_fb_image(const ili9341_image_t *img, uint16_t x, uint16_t y) {
+    if (img == NULL || img->data == NULL || img->palette == NULL) {
+        return;
+    }
+
+    ili9341_rect_t bounds = rect_clip_screen(x, y, img->width, img->height);
+    if (rect_empty(&bounds)) {
+        return;
+    }
+
+    fb_op_t *op = op_alloc();
+    if (op == NULL) {
+        return;
+    }
+    op->type = FB_OP_IMAGE;
+    op->x = x;
+    op->y = y;
+    op->bounds = bounds;
+    op->image = img;
+}
+
+void ili9341_fb_invalidate(void) {
+    full_redraw = true;
+}
+
+// ==== Rasterization ====
+// The strip buffer is used with the stride of the area being drawn, so a
+// dirty region narrower than the screen is still one contiguous blit.
+
+static void raster_fill(const fb_op_t *op, const ili9341_rect_t *area, uint16_t *buf) {
+    ili9341_rect_t r;
+    if (!rect_intersect(&op->bounds, area, &r)) {
+        return;
+    }
+
+    uint16_t pixel = ili9341_swap16(op->color);
+    for (int y = r.y; y < r.y + r.h; y++) {
+        uint16_t *dst = buf + (y - area->y) * area->w + (r.x - area->x);
+        for (int x = 0; x < r.w; x++) {
+            dst[x] = pixel;
+        }
+    }
+}
+
+static void raster_text(const fb_op_t *op, const ili9341_rect_t *area, uint16_t *buf) {
+    ili9341_rect_t r;
+    if (!rect_intersect(&op->bounds, area, &r)) {
+        return;
+    }
+
+    const int scale = op->scale;
+    const int advance = (ILI9341_FONT_WIDTH + ILI9341_FONT_SPACING) * scale;
+    const uint16_t pixel = ili9341_swap16(op->color);
+
+    for (int i = 0; op->text[i] != '\0'; i++) {
+        ili9341_rect_t cell = {
+            op->x + i * advance, op->y,
+            ILI9341_FONT_WIDTH * scale, ILI9341_FONT_HEIGHT * scale
+        };
+        ili9341_rect_t vis;
+        if (!rect_intersect(&cell, &r, &vis)) {
+            continue;
+        }
+
+        const uint8_t *bitmap = ili9341_font_glyph(op->text[i]);
+        for (int y = vis.y; y < vis.y + vis.h; y++) {
+            const uint8_t row_bit = 1 << ((y - cell.y) / scale);
+            uint16_t *dst = buf + (y - area->y) * area->w + (vis.x - area->x);
+            for (int x = vis.x; x < vis.x + vis.w; x++, dst++) {
+                if (bitmap[(x - cell.x) / scale] & row_bit) {
+                    *dst = pixel;
+                }
+            }
+        }
+    }
+}
+
+// Decode the rows of the image that fall in the strip straight from the
+// compressed stream; rows above the strip are skipped, not decoded
+static void raster_image(const fb_op_t *op, const ili9341_rect_t *area, uint16_t *buf) {
+    ili9341_rect_t r;
+    if (!rect_intersect(&op->bounds, area, &r)) {
+        return;
+    }
+
+    const ili9341_image_t *img = op->image;
+    ili9341_image_reader_t reader;
+    ili9341_image_reader_init(&reader, img);
+    ili9341_image_skip(&reader, (uint32_t)(r.y - op->y) * img->width + (r.x - op->x));
+
+    for (int y = r.y; y < r.y + r.h; y++) {
+        uint16_t *dst = buf + (y - area->y) * area->w + (r.x - area->x);
+        ili9341_image_read(&reader, dst, r.w);
+        ili9341_image_skip(&reader, img->width - r.w);
+    }
+}
+
+// Render every primitive of the current frame that touches a dirty region
+// and send it, strip_rows rows at a time
+static size_t flush_region(const ili9341_rect_t *region) {
+    size_t sent = 0;
+    int max_rows = (int)((size_t)ILI9341_WIDTH * strip_rows / region->w);
+
+    for (int y = region->y; y < region->y + region->h; y += max_rows) {
+        int rows = region->y + region->h - y;
+        if (rows > max_rows) {
+            rows = max_rows;
+        }
+        ili9341_rect_t area = { region->x, y, region->w, rows };
+
+        // Nothing in the frame covers this area: it reads as black
+        memset(strip_buf, 0, (size_t)area.w * area.h * sizeof(uint16_t));
+
+        for (int i = 0; i < cur->count; i++) {
+            const fb_op_t *op = &cur->ops[i];
+            if (op->type == FB_OP_FILL_RECT) {
+                raster_fill(op, &area, strip_buf);
+            } else if (op->type == FB_OP_IMAGE) {
+                raster_image(op, &area, strip_buf);
+            } else {
+                raster_text(op, &area, strip_buf);
+            }
+        }
+
+        ili9341_blit(area.x, area.y, area.w, area.h, strip_buf);
+        sent += (size_t)area.w * area.h;
+    }
+    return sent;
+}
+
+size_t ili9341_fb_flush(void) {
+    if (strip_buf == NULL) {
+        ESP_LOGE(TAG, "Renderer not initialized");
+        return 0;
+    }
+
+    dirty_count = 0;
+    if (full_redraw) {
+        dirty[0] = (ili9341_rect_t) { 0, 0, ILI9341_WIDTH, ILI9341_HEIGHT };
+        dirty_count = 1;
+        full_redraw = false;
+    } else {
+        // Ops are compared by position: anything that changed, appeared or
+        // disappeared dirties both its old and its new footprint
+        int n = cur->count > prev->count ? cur->count : prev->count;
+        for (int i = 0; i < n; i++) {
+            bool in_cur = i < cur->count;
+            bool in_prev = i < prev->count;
+            if (in_cur && in_prev && memcmp(&cur->ops[i], &prev->ops[i], sizeof(fb_op_t)) == 0) {
+                continue;
+            }
+            if (in_cur) {
+                dirty_add(&cur->ops[i].bounds);
+            }
+            if (in_prev) {
+                dirty_add(&prev->ops[i].bounds);
+            }
+        }
+    }
+
+    size_t sent = 0;
+    for (int i = 0; i < dirty_count; i++) {
+        sent += flush_region(&dirty[i]);
+    }
+
+    // The frame just sent becomes the reference for the next one
+    fb_frame_t *tmp = prev;
+    prev = cur;
+    cur = tmp;
+    memcpy(cur, prev, sizeof(*cur));
+
+    return sent;
+}
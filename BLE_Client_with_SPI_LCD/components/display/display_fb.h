@@ -0,0 +1,112 @@
+#ifndef DISPLAY_FB_H
+#define DISPLAY_FB_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "display.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ==== Strip-Buffered Renderer ====
+//
+// Instead of streaming every primitive straight to the panel, a frame is
+// described as a short list of primitives between ili9341_fb_begin() and
+// ili9341_fb_flush(). On flush the list is compared with the previous
+// frame; only the regions that changed are rasterized, a strip of rows at
+// a time, into a RAM buffer and sent through DMA. Every changed pixel goes
+// out once, so there is no fill-then-text flicker.
+
+// Maximum number of primitives in one frame
+#define ILI9341_FB_MAX_OPS   16
+
+// Longest string a text primitive keeps (longer strings are truncated)
+#define ILI9341_FB_TEXT_MAX  40
+
+// Maximum number of separate dirty rectangles tracked per flush
+#define ILI9341_FB_MAX_DIRTY 8
+
+/**
+ * @brief Allocate the strip buffer and enable the renderer
+ *
+ * The strip buffer holds ILI9341_WIDTH x strip_height RGB565 pixels, e.g.
+ * 25 KB for 40 rows. Taller strips need fewer flush transactions, shorter
+ * ones less RAM. The first flush redraws the whole screen.
+ *
+ * @param strip_height Rows per strip (1 to ILI9341_HEIGHT)
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the buffer can't be allocated
+ */
+esp_err_t ili9341_fb_init(uint16_t strip_height);
+
+/**
+ * @brief Free the strip buffer
+ */
+void ili9341_fb_deinit(void);
+
+/**
+ * @brief Start describing a new frame
+ *
+ * Discards the primitives of the frame being built; the previously flushed
+ * frame is kept for comparison.
+ */
+void ili9341_fb_begin(void);
+
+/**
+ * @brief Add a full-screen fill to the frame
+ * @param color 16-bit RGB565 color value
+ */
+void ili9341_fb_fill(uint16_t color);
+
+/**
+ * @brief Add a solid rectangle to the frame
+ * @param x X coordinate
+ * @param y Y coordinate
+ * @param w Width in pixels
+ * @param h Height in pixels
+ * @param color 16-bit RGB565 color value
+ */
+void ili9341_fb_fill_rect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color);
+
+/**
+ * @brief Add a string to the frame (transparent background)
+ * @param str String to display
+ * @param x X coordinate
+ * @param y Y coordinate
+ * @param color 16-bit RGB565 color value
+ * @param scale Font scale (1 = 5x8 pixels per character)
+ */
+void ili9341_fb_text(const char *str, uint16_t x, uint16_t y, uint16_t color, uint8_t scale);
+
+/**
+ * @brief Add a compressed image to the frame
+ *
+ * Only the pointer is kept, so the image must stay valid (const data in
+ * flash, as generated by gen_image.py). Each strip decodes just the rows
+ * it covers.
+ *
+ * @param img Image to draw
+ * @param x X coordinate of the top-left corner
+ * @param y Y coordinate of the top-left corner
+ */
+void ili9341_fb_image(const ili9341_image_t *img, uint16_t x, uint16_t y);
+
+/**
+ * @brief Force the next flush to redraw the whole screen
+ *
+ * Needed after anything has drawn to the panel behind the renderer's back.
+ */
+void ili9341_fb_invalidate(void);
+
+/**
+ * @brief Send the regions that differ from the previously flushed frame
+ * @return Number of pixels sent to the panel
+ */
+size_t ili9341_fb_flush(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DISPLAY_FB_H
@@ -0,0 +1,60 @@
+#include "display_priv.h"
+#include "font5x8.h"
+#include "font5x8_rows.h"   // Generated at build time by gen_font_rows.py
+
+static inline int glyph_index(char c) {
+    if (c < 32 || c > 127) {
+        c = '?';
+    }
+    return c - 32;
+}
+
+const uint8_t *ili9341_font_glyph(char c) {
+    return font5x8[glyph_index(c)];
+}
+
+const uint8_t *ili9341_font_rows(char c) {
+    return font5x8_rows[glyph_index(c)];
+}
+
+void ili9341_font_pair_lut(uint32_t pair[4], uint16_t fg, uint16_t bg) {
+    // Index bit 0 = first pixel in memory (low half-word), bit 1 = second
+    pair[0] = ((uint32_t)bg << 16) | bg;
+    pair[1] = ((uint32_t)bg << 16) | fg;
+    pair[2] = ((uint32_t)fg << 16) | bg;
+    pair[3] = ((uint32_t)fg << 16) | fg;
+}
+
+void ili9341_font_expand_row(uint16_t *dst, uint8_t mask, int cols, uint8_t scale,
+                             const uint32_t pair[4]) {
+    int n = cols * scale;
+
+    if (scale > ILI9341_FONT_LUT_SCALES) {
+        // Beyond the tables: one column at a time
+        for (int col = 0; col < cols; col++) {
+            uint16_t pixel = (uint16_t)pair[(mask >> col) & 1];
+            for (int i = 0; i < scale; i++) {
+                *dst++ = pixel;
+            }
+        }
+        return;
+    }
+
+    uint64_t bits = font_scaled_masks[scale - 1][mask & 0x3F];
+
+    // Word stores need a 4-byte aligned destination
+    if (((uintptr_t)dst & 2) && n > 0) {
+        *dst++ = (uint16_t)pair[bits & 1];
+        bits >>= 1;
+        n--;
+    }
+
+    uint32_t *dst32 = (uint32_t *)dst;
+    for (; n >= 2; n -= 2) {
+        *dst32++ = pair[bits & 3];
+        bits >>= 2;
+    }
+    if (n) {
+        *(uint16_t *)dst32 = (uint16_t)pair[bits & 1];
+    }
+}
@@ -0,0 +1,205 @@
+#include "display.h"
+#include "display_priv.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include <string.h>
+
+static const char *TAG = "ILI9341_GCACHE";
+
+// Entries and index are fixed size; the pixel blocks are what the byte
+// budget limits. Buckets must be a power of two.
+#define CACHE_NO_ENTRY -1
+#define CACHE_BUCKETS  (ILI9341_GLYPH_CACHE_MAX_ENTRIES * 2)
+
+typedef struct {
+    uint64_t key;
+    uint16_t *pixels;      // Expanded glyph, byte swapped, DMA capable
+    uint32_t bytes;
+    int16_t hash_next;     // Next entry in the same bucket
+    int16_t lru_prev;      // Towards most recently used
+    int16_t lru_next;      // Towards least recently used
+} cache_entry_t;
+
+// ==== Private Variables ====
+static cache_entry_t entries[ILI9341_GLYPH_CACHE_MAX_ENTRIES];
+static int16_t buckets[CACHE_BUCKETS];
+static int16_t free_head = CACHE_NO_ENTRY;
+static int16_t lru_head = CACHE_NO_ENTRY;   // Most recently used
+static int16_t lru_tail = CACHE_NO_ENTRY;   // Eviction candidate
+static size_t budget = 0;
+static size_t bytes_used = 0;
+static uint16_t entry_count = 0;
+static uint32_t hits = 0;
+static uint32_t misses = 0;
+static uint32_t evictions = 0;
+
+static inline uint64_t make_key(char c, uint8_t scale, uint16_t fg, uint16_t bg) {
+    return ((uint64_t)(uint8_t)c << 40) | ((uint64_t)scale << 32) |
+           ((uint64_t)fg << 16) | bg;
+}
+
+static inline int bucket_of(uint64_t key) {
+    // Fibonacci hashing spreads the packed key over the table
+    return (int)((key * 0x9E3779B97F4A7C15ULL) >> 32) & (CACHE_BUCKETS - 1);
+}
+
+static void lru_unlink(int16_t i) {
+    cache_entry_t *e = &entries[i];
+
+    if (e->lru_prev != CACHE_NO_ENTRY) {
+        entries[e->lru_prev].lru_next = e->lru_next;
+    } else {
+        lru_head = e->lru_next;
+    }
+    if (e->lru_next != CACHE_NO_ENTRY) {
+        entries[e->lru_next].lru_prev = e->lru_prev;
+    } else {
+        lru_tail = e->lru_prev;
+    }
+}
+
+static void lru_push_front(int16_t i) {
+    cache_entry_t *e = &entries[i];
+
+    e->lru_prev = CACHE_NO_ENTRY;
+    e->lru_next = lru_head;
+    if (lru_head != CACHE_NO_ENTRY) {
+        entries[lru_head].lru_prev = i;
+    }
+    lru_head = i;
+    if (lru_tail == CACHE_NO_ENTRY) {
+        lru_tail = i;
+    }
+}
+
+static void hash_unlink(int16_t i) {
+    int16_t *link = &buckets[bucket_of(entries[i].key)];
+
+    while (*link != CACHE_NO_ENTRY) {
+        if (*link == i) {
+            *link = entries[i].hash_next;
+            return;
+        }
+        link = &entries[*link].hash_next;
+    }
+}
+
+static void evict(int16_t i) {
+    cache_entry_t *e = &entries[i];
+
+    hash_unlink(i);
+    lru_unlink(i);
+    heap_caps_free(e->pixels);
+    bytes_used -= e->bytes;
+    entry_count--;
+    e->pixels = NULL;
+    e->hash_next = free_head;
+    free_head = i;
+}
+
+static void reset_index(void) {
+    for (int i = 0; i < CACHE_BUCKETS; i++) {
+        buckets[i] = CACHE_NO_ENTRY;
+    }
+    for (int i = 0; i < ILI9341_GLYPH_CACHE_MAX_ENTRIES; i++) {
+        entries[i].pixels = NULL;
+        entries[i].hash_next = (i + 1 < ILI9341_GLYPH_CACHE_MAX_ENTRIES) ? i + 1 : CACHE_NO_ENTRY;
+    }
+    free_head = 0;
+    lru_head = CACHE_NO_ENTRY;
+    lru_tail = CACHE_NO_ENTRY;
+    bytes_used = 0;
+    entry_count = 0;
+}
+
+// ==== Component-Internal Interface ====
+void ili9341_glyph_cache_setup(size_t budget_bytes) {
+    ili9341_glyph_cache_clear();
+    reset_index();
+    budget = budget_bytes;
+    ili9341_glyph_cache_reset_stats();
+    if (budget > 0) {
+        ESP_LOGI(TAG, "Glyph cache enabled, %u byte budget", (unsigned)budget);
+    }
+}
+
+const uint16_t *ili9341_glyph_cache_lookup(char c, uint8_t scale, uint16_t fg, uint16_t bg) {
+    if (budget == 0) {
+        return NULL;
+    }
+
+    uint64_t key = make_key(c, scale, fg, bg);
+    for (int16_t i = buckets[bucket_of(key)]; i != CACHE_NO_ENTRY; i = entries[i].hash_next) {
+        if (entries[i].key == key) {
+            hits++;
+            if (lru_head != i) {
+                lru_unlink(i);
+                lru_push_front(i);
+            }
+            return entries[i].pixels;
+        }
+    }
+
+    misses++;
+    return NULL;
+}
+
+uint16_t *ili9341_glyph_cache_insert(char c, uint8_t scale, uint16_t fg, uint16_t bg) {
+    const size_t bytes = (size_t)ILI9341_FONT_WIDTH * ILI9341_FONT_HEIGHT * scale * scale * 2;
+
+    // Glyphs larger than the whole budget are never cached
+    if (budget == 0 || bytes > budget) {
+        return NULL;
+    }
+
+    while (lru_tail != CACHE_NO_ENTRY &&
+           (free_head == CACHE_NO_ENTRY || bytes_used + bytes > budget)) {
+        evict(lru_tail);
+        evictions++;
+    }
+
+    uint16_t *pixels = heap_caps_malloc(bytes, MALLOC_CAP_DMA);
+    if (pixels == NULL) {
+        return NULL;
+    }
+
+    int16_t i = free_head;
+    cache_entry_t *e = &entries[i];
+    free_head = e->hash_next;
+
+    e->key = make_key(c, scale, fg, bg);
+    e->pixels = pixels;
+    e->bytes = bytes;
+    e->hash_next = buckets[bucket_of(e->key)];
+    buckets[bucket_of(e->key)] = i;
+    lru_push_front(i);
+    bytes_used += bytes;
+    entry_count++;
+
+    return pixels;
+}
+
+// ==== Public Functions ====
+void ili9341_glyph_cache_clear(void) {
+    while (lru_tail != CACHE_NO_ENTRY) {
+        evict(lru_tail);
+    }
+}
+
+void ili9341_glyph_cache_get_stats(ili9341_glyph_cache_stats_t *stats) {
+    if (stats == NULL) {
+        return;
+    }
+    stats->hits = hits;
+    stats->misses = misses;
+    stats->evictions = evictions;
+    stats->entries = entry_count;
+    stats->bytes_used = bytes_used;
+    stats->budget = budget;
+}
+
+void ili9341_glyph_cache_reset_stats(void) {
+    hits = 0;
+    misses = 0;
+    evictions = 0;
+}
@@ -0,0 +1,128 @@
+#include "display.h"
+#include "display_priv.h"
+
+// ==== RLE Reader ====
+static inline uint16_t palette_color(const ili9341_image_reader_t *r, uint8_t index) {
+    return index < r->palette_len ? r->palette[index] : 0;
+}
+
+static bool next_packet(ili9341_image_reader_t *r) {
+    if (r->end - r->p < 2) {
+        return false;
+    }
+
+    uint8_t c = *r->p++;
+    r->run = (c & 0x7F) + 1;
+    r->literal = !(c & 0x80);
+    if (!r->literal) {
+        r->value = palette_color(r, *r->p++);
+    } else if (r->end - r->p < r->run) {
+        return false;
+    }
+    return true;
+}
+
+void ili9341_image_reader_init(ili9341_image_reader_t *r, const ili9341_image_t *img) {
+    *r = (ili9341_image_reader_t) {
+        .palette = img->palette,
+        .palette_len = img->palette_len,
+        .p = img->data,
+        .end = img->data + img->data_len,
+    };
+}
+
+bool ili9341_image_read(ili9341_image_reader_t *r, uint16_t *dst, size_t n) {
+    while (n > 0) {
+        if (r->run == 0 && !next_packet(r)) {
+            // Short stream: pad rather than send stale buffer contents
+            while (n-- > 0) {
+                *dst++ = 0;
+            }
+            return false;
+        }
+
+        size_t k = (n < r->run) ? n : r->run;
+        if (r->literal) {
+            for (size_t i = 0; i < k; i++) {
+                dst[i] = palette_color(r, r->p[i]);
+            }
+            r->p += k;
+        } else {
+            for (size_t i = 0; i < k; i++) {
+                dst[i] = r->value;
+            }
+        }
+        r->run -= k;
+        dst += k;
+        n -= k;
+    }
+    return true;
+}
+
+bool ili9341_image_skip(ili9341_image_reader_t *r, uint32_t n) {
+    while (n > 0) {
+        if (r->run == 0 && !next_packet(r)) {
+            return false;
+        }
+        uint32_t k = (n < r->run) ? n : r->run;
+        if (r->literal) {
+            r->p += k;
+        }
+        r->run -= k;
+        n -= k;
+    }
+    return true;
+}
+
+// ==== Direct Drawing ====
+typedef struct {
+    ili9341_image_reader_t reader;
+    uint16_t vis_w;           // Visible pixels per row
+    uint16_t skip;            // Image pixels between two visible row segments
+    uint16_t col;             // Position within the visible row segment
+} image_stream_t;
+
+static const uint16_t *image_source(uint16_t *dst, size_t count, void *arg) {
+    image_stream_t *s = (image_stream_t *)arg;
+    uint16_t *out = dst;
+
+    while (count > 0) {
+        size_t k = s->vis_w - s->col;
+        if (k > count) {
+            k = count;
+        }
+        ili9341_image_read(&s->reader, out, k);
+        out += k;
+        count -= k;
+        s->col += k;
+
+        if (s->col == s->vis_w) {
+            s->col = 0;
+            ili9341_image_skip(&s->reader, s->skip);
+        }
+    }
+    return dst;
+}
+
+void ili9341_draw_image(const ili9341_image_t *img, uint16_t x, uint16_t y) {
+    ili9341_rect_t vis;
+    if (img == NULL || img->data == NULL || img->palette == NULL ||
+        !ili9341_clip_rect(x, y, img->width, img->height, &vis)) {
+        return;
+    }
+
+    image_stream_t s = {
+        .vis_w = vis.w,
+        .skip = img->width - vis.w,
+    };
+    ili9341_image_reader_init(&s.reader, img);
+
+    ILI9341_PERF_BEGIN(perf);
+
+    // Start at the first visible pixel
+    ili9341_image_skip(&s.reader, (uint32_t)(vis.y - y) * img->width + (vis.x - x));
+
+    ili9341_set_window(vis.x, vis.y, vis.x + vis.w - 1, vis.y + vis.h - 1);
+    ili9341_stream_pixels((size_t)vis.w * vis.h, image_source, &s);
+    ILI9341_PERF_END(ILI9341_PERF_IMAGE, perf);
+}
@@ -0,0 +1,60 @@
+#ifndef DISPLAY_PANEL_H
+#define DISPLAY_PANEL_H
+
+#include "sdkconfig.h"
+
+// ==== Panel Traits ====
+//
+// The controller is chosen at build time (Kconfig "Panel controller") and
+// everything that differs between them is a constant here, so geometry
+// and pixel format fold into the drawing loops and the unused paths are
+// never compiled. The drawing API stays RGB565 and keeps its ili9341_
+// names whatever the panel.
+//
+// ILI9341_PANEL_COLS / ROWS   Native (portrait) GRAM size; ROWS is the
+//                             scan direction
+// ILI9341_PANEL_BPP           Bytes per pixel on the wire: 2 for RGB565,
+//                             3 for RGB666 (the ILI9488 has no 16-bit mode
+//                             over SPI)
+// ILI9341_PANEL_COLMOD        Pixel format (0x3A) parameter
+// ILI9341_PANEL_MADCTL_*      Landscape and portrait orientation, with the
+//                             panel's colour order bit
+// ILI9341_PANEL_INVERTED      Panel glass is inverted, so init turns
+//                             inversion on to show true colours
+
+#if defined(CONFIG_ILI9341_PANEL_ST7789)
+
+#define ILI9341_PANEL_NAME             "ST7789"
+#define ILI9341_PANEL_COLS             240
+#define ILI9341_PANEL_ROWS             320
+#define ILI9341_PANEL_BPP              2
+#define ILI9341_PANEL_COLMOD           0x55
+#define ILI9341_PANEL_MADCTL_LANDSCAPE 0x20
+#define ILI9341_PANEL_MADCTL_PORTRAIT  0x40
+#define ILI9341_PANEL_INVERTED         1
+
+#elif defined(CONFIG_ILI9341_PANEL_ILI9488)
+
+#define ILI9341_PANEL_NAME             "ILI9488"
+#define ILI9341_PANEL_COLS             320
+#define ILI9341_PANEL_ROWS             480
+#define ILI9341_PANEL_BPP              3
+#define ILI9341_PANEL_COLMOD           0x66
+#define ILI9341_PANEL_MADCTL_LANDSCAPE 0x28
+#define ILI9341_PANEL_MADCTL_PORTRAIT  0x48
+#define ILI9341_PANEL_INVERTED         0
+
+#else // CONFIG_ILI9341_PANEL_ILI9341
+
+#define ILI9341_PANEL_NAME             "ILI9341"
+#define ILI9341_PANEL_COLS             240
+#define ILI9341_PANEL_ROWS             320
+#define ILI9341_PANEL_BPP              2
+#define ILI9341_PANEL_COLMOD           0x55
+#define ILI9341_PANEL_MADCTL_LANDSCAPE 0x28
+#define ILI9341_PANEL_MADCTL_PORTRAIT  0x48
+#define ILI9341_PANEL_INVERTED         0
+
+#endif
+
+#endif // DISPLAY_PANEL_H
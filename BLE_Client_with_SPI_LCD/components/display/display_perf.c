@@ -0,0 +1,152 @@
+#include "display_perf.h"
+#include "display_priv.h"
+#include "display_transport.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <string.h>
+
+static const char *names[ILI9341_PERF_PRIM_COUNT] = {
+    [ILI9341_PERF_FILL] = "fill",
+    [ILI9341_PERF_FILL_RECT] = "fill_rect",
+    [ILI9341_PERF_TEXT] = "text",
+    [ILI9341_PERF_TEXT_BG] = "text_bg",
+    [ILI9341_PERF_SET_WINDOW] = "set_window",
+    [ILI9341_PERF_BITMAP] = "bitmap",
+    [ILI9341_PERF_IMAGE] = "image",
+};
+
+const char *ili9341_perf_name(ili9341_perf_prim_t prim) {
+    return (prim < ILI9341_PERF_PRIM_COUNT) ? names[prim] : "?";
+}
+
+#ifdef CONFIG_ILI9341_PERF_STATS
+
+static const char *TAG = "ILI9341_PERF";
+
+// ==== Private Variables ====
+static ili9341_perf_stats_t stats[ILI9341_PERF_PRIM_COUNT];
+static esp_timer_handle_t dump_timer = NULL;
+
+// ==== Hooks ====
+void ili9341_perf_begin(ili9341_perf_scope_t *scope) {
+    ili9341_bus_stats_t bus;
+    ili9341_transport_get_stats(&bus);
+    scope->transactions = bus.transactions;
+    scope->bytes = bus.bytes;
+    scope->start_us = esp_timer_get_time();
+}
+
+void ili9341_perf_end(ili9341_perf_prim_t prim, const ili9341_perf_scope_t *scope) {
+    uint32_t us = (uint32_t)(esp_timer_get_time() - scope->start_us);
+    ili9341_bus_stats_t bus;
+    ili9341_transport_get_stats(&bus);
+
+    ili9341_perf_stats_t *s = &stats[prim];
+    s->calls++;
+    s->total_us += us;
+    if (us > s->max_us) {
+        s->max_us = us;
+    }
+
+    // Bus counters reset in between: count what came after the reset
+    s->transactions += (bus.transactions >= scope->transactions) ?
+                       bus.transactions - scope->transactions : bus.transactions;
+    s->bytes += (bus.bytes >= scope->bytes) ? bus.bytes - scope->bytes : bus.bytes;
+
+    int bucket = 31 - __builtin_clz(us | 1);
+    if (bucket >= ILI9341_PERF_BUCKETS) {
+        bucket = ILI9341_PERF_BUCKETS - 1;
+    }
+    s->hist[bucket]++;
+}
+
+// ==== Queries ====
+esp_err_t ili9341_perf_get(ili9341_perf_prim_t prim, ili9341_perf_stats_t *out) {
+    if (prim >= ILI9341_PERF_PRIM_COUNT || out == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *out = stats[prim];
+    return ESP_OK;
+}
+
+void ili9341_perf_reset(void) {
+    memset(stats, 0, sizeof(stats));
+}
+
+// Upper edge of the bucket holding the given fraction of calls
+static uint32_t percentile_us(const ili9341_perf_stats_t *s, uint32_t permille) {
+    uint32_t target = ((uint64_t)s->calls * permille + 999) / 1000;
+    uint32_t seen = 0;
+
+    for (int i = 0; i < ILI9341_PERF_BUCKETS - 1; i++) {
+        seen += s->hist[i];
+        if (seen >= target) {
+            return 2u << i;
+        }
+    }
+    return s->max_us;
+}
+
+void ili9341_perf_dump(void) {
+    ESP_LOGI(TAG, "%-10s %8s %8s %8s %8s %8s %8s %10s", "primitive", "calls", "avg us",
+             "max us", "p50 us", "p99 us", "trans", "bytes");
+
+    for (int i = 0; i < ILI9341_PERF_PRIM_COUNT; i++) {
+        const ili9341_perf_stats_t *s = &stats[i];
+        if (s->calls == 0) {
+            continue;
+        }
+        ESP_LOGI(TAG, "%-10s %8lu %8lu %8lu %8lu %8lu %8lu %10llu", names[i],
+                 (unsigned long)s->calls,
+                 (unsigned long)(s->total_us / s->calls),
+                 (unsigned long)s->max_us,
+                 (unsigned long)percentile_us(s, 500),
+                 (unsigned long)percentile_us(s, 990),
+                 (unsigned long)s->transactions,
+                 (unsigned long long)s->bytes);
+    }
+}
+
+static void dump_timer_cb(void *arg) {
+    ili9341_perf_dump();
+}
+
+esp_err_t ili9341_perf_start_dump(uint32_t period_ms) {
+    if (dump_timer != NULL) {
+        esp_timer_stop(dump_timer);
+        esp_timer_delete(dump_timer);
+        dump_timer = NULL;
+    }
+    if (period_ms == 0) {
+        return ESP_OK;
+    }
+
+    const esp_timer_create_args_t args = {
+        .callback = dump_timer_cb,
+        .name = "ili9341_perf",
+    };
+    esp_err_t ret = esp_timer_create(&args, &dump_timer);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create dump timer: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    return esp_timer_start_periodic(dump_timer, (uint64_t)period_ms * 1000);
+}
+
+#else // !CONFIG_ILI9341_PERF_STATS
+
+esp_err_t ili9341_perf_get(ili9341_perf_prim_t prim, ili9341_perf_stats_t *out) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+void ili9341_perf_reset(void) {
+}
+
+void ili9341_perf_dump(void) {
+}
+
+esp_err_t ili9341_perf_start_dump(uint32_t period_ms) {
+    return (period_ms == 0) ? ESP_OK : ESP_ERR_NOT_SUPPORTED;
+}
+
+#endif // CONFIG_ILI9341_PERF_STATS
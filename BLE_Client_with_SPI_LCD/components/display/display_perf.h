@@ -0,0 +1,86 @@
+#ifndef DISPLAY_PERF_H
+#define DISPLAY_PERF_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ==== Performance Statistics ====
+//
+// With CONFIG_ILI9341_PERF_STATS enabled, every drawing primitive records
+// its call count, the bus transactions and bytes it caused and a
+// histogram of its latency (esp_timer, call to return). Nested calls are
+// counted in both: ili9341_fill() also shows up under fill_rect and
+// set_window. Without the option the hooks compile to nothing and the
+// functions below return ESP_ERR_NOT_SUPPORTED or do nothing.
+//
+// Counters are updated by whichever task draws (the render task, once it
+// runs) and read without locking, so a dump taken mid-frame may be off
+// by one call.
+
+typedef enum {
+    ILI9341_PERF_FILL,
+    ILI9341_PERF_FILL_RECT,
+    ILI9341_PERF_TEXT,          // ili9341_text_* with transparent background
+    ILI9341_PERF_TEXT_BG,
+    ILI9341_PERF_SET_WINDOW,
+    ILI9341_PERF_BITMAP,        // ili9341_draw_bitmap() and ili9341_blit()
+    ILI9341_PERF_IMAGE,
+    ILI9341_PERF_PRIM_COUNT,
+} ili9341_perf_prim_t;
+
+// Latency buckets: bucket 0 is under 2 us, bucket n covers [2^n, 2^(n+1))
+// us and the last one everything from 2^15 us (32.8 ms) up
+#define ILI9341_PERF_BUCKETS 16
+
+typedef struct {
+    uint32_t calls;
+    uint32_t transactions;
+    uint64_t bytes;
+    uint64_t total_us;
+    uint32_t max_us;
+    uint32_t hist[ILI9341_PERF_BUCKETS];
+} ili9341_perf_stats_t;
+
+/**
+ * @brief Read the counters of one primitive
+ * @param prim Primitive
+ * @param stats Filled with the counters since init or the last reset
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, or ESP_ERR_NOT_SUPPORTED if the
+ *         statistics are compiled out
+ */
+esp_err_t ili9341_perf_get(ili9341_perf_prim_t prim, ili9341_perf_stats_t *stats);
+
+/**
+ * @brief Zero all counters
+ */
+void ili9341_perf_reset(void);
+
+/**
+ * @brief Log one line per primitive that has been called
+ *
+ * Shows calls, average and maximum latency, the 50th and 99th percentile
+ * (upper edge of the histogram bucket), transactions and bytes.
+ */
+void ili9341_perf_dump(void);
+
+/**
+ * @brief Log the statistics periodically from an esp_timer
+ * @param period_ms Dump period; 0 stops dumping
+ * @return ESP_OK, ESP_ERR_NOT_SUPPORTED if compiled out, or the esp_timer error
+ */
+esp_err_t ili9341_perf_start_dump(uint32_t period_ms);
+
+/**
+ * @brief Name of a primitive as used in the dump
+ */
+const char *ili9341_perf_name(ili9341_perf_prim_t prim);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DISPLAY_PERF_H
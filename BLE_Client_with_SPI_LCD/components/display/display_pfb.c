@@ -0,0 +1,293 @@
+#include "display_pfb.h"
+#include "display.h"
+#include "display_priv.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include <string.h>
+
+static const char *TAG = "ILI9341_PFB";
+
+// Pixels are packed leftmost-first from the low bits of each byte, so a
+// whole byte indexes the expansion table directly
+static const uint16_t default_palette[] = {
+    ILI9341_BLACK, ILI9341_WHITE, ILI9341_RED, ILI9341_GREEN,
+    ILI9341_BLUE, ILI9341_YELLOW, ILI9341_CYAN, ILI9341_MAGENTA,
+};
+
+// ==== Private Variables ====
+static uint8_t *buf = NULL;
+static uint8_t bpp = 0;
+static uint8_t ppb = 0;                     // Pixels per byte
+static uint8_t mask = 0;                    // Bits of one pixel
+static uint16_t stride = 0;                 // Bytes per row
+static uint16_t palette[ILI9341_PFB_MAX_COLORS];
+static uint16_t swapped[ILI9341_PFB_MAX_COLORS];  // Palette in panel byte order
+static uint32_t expand_lut[256][2];         // Byte -> its 2 or 4 pixels, as words
+static bool dirty_valid = false;
+static ili9341_rect_t dirty;
+
+// ==== Dirty Tracking ====
+static void mark_dirty(int x0, int y0, int x1, int y1) {
+    if (dirty_valid) {
+        int dx1 = dirty.x + dirty.w;
+        int dy1 = dirty.y + dirty.h;
+        x0 = x0 < dirty.x ? x0 : dirty.x;
+        y0 = y0 < dirty.y ? y0 : dirty.y;
+        x1 = x1 > dx1 ? x1 : dx1;
+        y1 = y1 > dy1 ? y1 : dy1;
+    }
+    dirty = (ili9341_rect_t) { x0, y0, x1 - x0, y1 - y0 };
+    dirty_valid = true;
+}
+
+void ili9341_pfb_invalidate(void) {
+    mark_dirty(0, 0, ILI9341_WIDTH, ILI9341_HEIGHT);
+}
+
+// ==== Palette ====
+static void build_lut(void) {
+    for (int i = 0; i < ILI9341_PFB_MAX_COLORS; i++) {
+        swapped[i] = ili9341_swap16(palette[i]);
+    }
+
+    for (int b = 0; b < 256; b++) {
+        uint16_t px[4] = { 0 };
+        for (int i = 0; i < ppb; i++) {
+            px[i] = swapped[(b >> (i * bpp)) & mask];
+        }
+        // Low half-word = first pixel in memory
+        expand_lut[b][0] = ((uint32_t)px[1] << 16) | px[0];
+        expand_lut[b][1] = (ppb == 4) ? ((uint32_t)px[3] << 16) | px[2] : 0;
+    }
+}
+
+void ili9341_pfb_set_palette(const uint16_t *colors, size_t count) {
+    if (buf == NULL || colors == NULL) {
+        return;
+    }
+    if (count > (size_t)(1 << bpp)) {
+        count = 1 << bpp;
+    }
+    memcpy(palette, colors, count * sizeof(uint16_t));
+    build_lut();
+    ili9341_pfb_invalidate();
+}
+
+uint8_t ili9341_pfb_index(uint16_t color) {
+    for (int i = 0; i < (1 << bpp); i++) {
+        if (palette[i] == color) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+// ==== Setup ====
+esp_err_t ili9341_pfb_init(uint8_t bits) {
+    if (bits != 2 && bits != 4) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ili9341_pfb_deinit();
+
+    // Plain internal RAM: the buffer is never handed to the DMA itself
+    size_t size = (size_t)ILI9341_WIDTH * ILI9341_HEIGHT * bits / 8;
+    buf = heap_caps_malloc(size, MALLOC_CAP_8BIT);
+    if (buf == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate %d-bpp framebuffer", bits);
+        return ESP_ERR_NO_MEM;
+    }
+
+    bpp = bits;
+    ppb = 8 / bits;
+    mask = (1 << bits) - 1;
+    stride = ILI9341_WIDTH / ppb;
+
+    memset(palette, 0, sizeof(palette));
+    size_t n = sizeof(default_palette) / sizeof(default_palette[0]);
+    memcpy(palette, default_palette, (n < (size_t)(1 << bpp) ? n : (size_t)(1 << bpp)) * sizeof(uint16_t));
+    build_lut();
+
+    memset(buf, 0, size);
+    ili9341_pfb_invalidate();
+
+    ESP_LOGI(TAG, "Palette framebuffer ready (%d bpp, %d bytes)", bits, (int)size);
+    return ESP_OK;
+}
+
+void ili9341_pfb_deinit(void) {
+    heap_caps_free(buf);
+    buf = NULL;
+    dirty_valid = false;
+}
+
+// ==== Drawing ====
+static inline void set_pixel(uint8_t *row, int x, uint8_t index) {
+    uint8_t *p = &row[x / ppb];
+    int shift = (x % ppb) * bpp;
+    *p = (*p & ~(mask << shift)) | (index << shift);
+}
+
+// Fill [x0, x1) of one row: odd pixels one by one, whole bytes with memset
+static void fill_span(uint8_t *row, int x0, int x1, uint8_t index) {
+    while (x0 < x1 && x0 % ppb) {
+        set_pixel(row, x0++, index);
+    }
+    int bytes = (x1 - x0) / ppb;
+    if (bytes > 0) {
+        memset(&row[x0 / ppb], (bpp == 4) ? index * 0x11 : index * 0x55, bytes);
+        x0 += bytes * ppb;
+    }
+    while (x0 < x1) {
+        set_pixel(row, x0++, index);
+    }
+}
+
+// Fill a rectangle given as [x0, x1) x [y0, y1), clipped to the screen
+static bool fill_clipped(int x0, int y0, int x1, int y1, uint8_t index) {
+    x0 = x0 < 0 ? 0 : x0;
+    y0 = y0 < 0 ? 0 : y0;
+    x1 = x1 > ILI9341_WIDTH ? ILI9341_WIDTH : x1;
+    y1 = y1 > ILI9341_HEIGHT ? ILI9341_HEIGHT : y1;
+    if (x1 <= x0 || y1 <= y0) {
+        return false;
+    }
+
+    for (int y = y0; y < y1; y++) {
+        fill_span(&buf[y * stride], x0, x1, index & mask);
+    }
+    return true;
+}
+
+void ili9341_pfb_clear(uint8_t index) {
+    if (buf == NULL) {
+        return;
+    }
+    fill_clipped(0, 0, ILI9341_WIDTH, ILI9341_HEIGHT, index);
+    ili9341_pfb_invalidate();
+}
+
+void ili9341_pfb_fill_rect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint8_t index) {
+    if (buf == NULL) {
+        return;
+    }
+    if (fill_clipped(x, y, x + w, y + h, index)) {
+        mark_dirty(x, y, x + w > ILI9341_WIDTH ? ILI9341_WIDTH : x + w,
+                   y + h > ILI9341_HEIGHT ? ILI9341_HEIGHT : y + h);
+    }
+}
+
+void ili9341_pfb_text(const char *str, uint16_t x, uint16_t y, uint8_t index, uint8_t scale) {
+    if (buf == NULL || str == NULL || *str == '\0' || scale == 0 ||
+        x >= ILI9341_WIDTH || y >= ILI9341_HEIGHT) {
+        return;
+    }
+
+    const int advance = (ILI9341_FONT_WIDTH + ILI9341_FONT_SPACING) * scale;
+    int cx = x;
+
+    for (; *str != '\0' && cx < ILI9341_WIDTH; str++, cx += advance) {
+        const uint8_t *rows = ili9341_font_rows(*str);
+        for (int row = 0; row < ILI9341_FONT_HEIGHT; row++) {
+            int py = y + row * scale;
+            // Each run of lit columns is one rectangle
+            for (int col = 0; col < ILI9341_FONT_WIDTH; col++) {
+                if (!(rows[row] & (1 << col))) {
+                    continue;
+                }
+                int start = col;
+                while (col + 1 < ILI9341_FONT_WIDTH && (rows[row] & (1 << (col + 1)))) {
+                    col++;
+                }
+                fill_clipped(cx + start * scale, py, cx + (col + 1) * scale, py + scale, index);
+            }
+        }
+    }
+
+    int x1 = cx - ILI9341_FONT_SPACING * scale;
+    mark_dirty(x, y, x1 > ILI9341_WIDTH ? ILI9341_WIDTH : x1,
+               y + ILI9341_FONT_HEIGHT * scale > ILI9341_HEIGHT ? ILI9341_HEIGHT : y + ILI9341_FONT_HEIGHT * scale);
+}
+
+// ==== Flush ====
+typedef struct {
+    ili9341_rect_t area;
+    int row;                  // Row within the area
+    int col;                  // Column within the area
+} pfb_stream_t;
+
+static inline uint16_t get_pixel(const uint8_t *row, int x) {
+    return swapped[(row[x / ppb] >> ((x % ppb) * bpp)) & mask];
+}
+
+// Expand n pixels of one row starting at x. Whole bytes go through the
+// table as 32-bit stores; only unaligned edges are done pixel by pixel.
+static void expand_span(uint16_t *dst, const uint8_t *row, int x, int n) {
+    while (n > 0 && (x % ppb || ((uintptr_t)dst & 3))) {
+        *dst++ = get_pixel(row, x++);
+        n--;
+    }
+    if (((uintptr_t)dst & 3) == 0) {
+        const uint8_t *src = &row[x / ppb];
+        uint32_t *dst32 = (uint32_t *)dst;
+        if (ppb == 2) {
+            for (; n >= 2; n -= 2, x += 2) {
+                *dst32++ = expand_lut[*src++][0];
+            }
+        } else {
+            for (; n >= 4; n -= 4, x += 4) {
+                const uint32_t *px = expand_lut[*src++];
+                *dst32++ = px[0];
+                *dst32++ = px[1];
+            }
+        }
+        dst = (uint16_t *)dst32;
+    }
+    while (n-- > 0) {
+        *dst++ = get_pixel(row, x++);
+    }
+}
+
+static const uint16_t *pfb_source(uint16_t *dst, size_t count, void *arg) {
+    pfb_stream_t *s = (pfb_stream_t *)arg;
+    uint16_t *out = dst;
+
+    while (count > 0) {
+        int n = s->area.w - s->col;
+        if ((size_t)n > count) {
+            n = count;
+        }
+        expand_span(out, &buf[(s->area.y + s->row) * stride], s->area.x + s->col, n);
+        out += n;
+        count -= n;
+        s->col += n;
+        if (s->col == s->area.w) {
+            s->col = 0;
+            s->row++;
+        }
+    }
+    return dst;
+}
+
+size_t ili9341_pfb_flush(void) {
+    if (buf == NULL) {
+        ESP_LOGE(TAG, "Framebuffer not initialized");
+        return 0;
+    }
+    if (!dirty_valid) {
+        return 0;
+    }
+
+    // Widen to 4-pixel columns so rows expand as whole bytes into aligned words
+    int x0 = dirty.x & ~3;
+    int x1 = (dirty.x + dirty.w + 3) & ~3;
+    pfb_stream_t s = {
+        .area = { x0, dirty.y, x1 - x0, dirty.h },
+    };
+    dirty_valid = false;
+
+    ili9341_set_window(s.area.x, s.area.y, s.area.x + s.area.w - 1, s.area.y + s.area.h - 1);
+    size_t total = (size_t)s.area.w * s.area.h;
+    ili9341_stream_pixels(total, pfb_source, &s);
+    return total;
+}
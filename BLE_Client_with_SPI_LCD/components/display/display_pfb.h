@@ -0,0 +1,102 @@
+#ifndef DISPLAY_PFB_H
+#define DISPLAY_PFB_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ==== Palette Framebuffer ====
+//
+// A full-screen off-screen buffer that stores palette indices instead of
+// RGB565: 4 bits per pixel (16 colours, 38 KB) or 2 bits per pixel
+// (4 colours, 19 KB), against 150 KB for RGB565. Frames are composed in
+// the buffer and only reach the panel on ili9341_pfb_flush(), which
+// expands the changed area to RGB565 through lookup tables straight into
+// the driver's DMA buffers, so there is never any flicker.
+//
+// Drawing calls take palette indices, not colours; ili9341_pfb_index()
+// maps a colour to its index. The default palette starts with BLACK,
+// WHITE, RED, GREEN, BLUE, YELLOW, CYAN and MAGENTA from display.h (the
+// first four in 2-bpp mode).
+
+#define ILI9341_PFB_MAX_COLORS 16
+
+/**
+ * @brief Allocate the buffer, load the default palette and clear to index 0
+ * @param bpp Bits per pixel, 2 or 4
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for other depths,
+ *         ESP_ERR_NO_MEM if the buffer can't be allocated
+ */
+esp_err_t ili9341_pfb_init(uint8_t bpp);
+
+/**
+ * @brief Free the buffer
+ */
+void ili9341_pfb_deinit(void);
+
+/**
+ * @brief Replace the palette
+ *
+ * Marks the whole screen dirty, since every pixel may change colour.
+ *
+ * @param colors RGB565 colours, index 0 first
+ * @param count Number of colours (at most 2^bpp; the rest keep their value)
+ */
+void ili9341_pfb_set_palette(const uint16_t *colors, size_t count);
+
+/**
+ * @brief Find the palette index of a colour
+ * @param color 16-bit RGB565 color value
+ * @return Index of the first exact match, or 0 if the colour isn't in the palette
+ */
+uint8_t ili9341_pfb_index(uint16_t color);
+
+/**
+ * @brief Fill the whole buffer with one palette entry
+ */
+void ili9341_pfb_clear(uint8_t index);
+
+/**
+ * @brief Fill a rectangle (clipped to the screen)
+ * @param x X coordinate
+ * @param y Y coordinate
+ * @param w Width in pixels
+ * @param h Height in pixels
+ * @param index Palette index
+ */
+void ili9341_pfb_fill_rect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint8_t index);
+
+/**
+ * @brief Draw a string with a transparent background (clipped to the screen)
+ * @param str String to display
+ * @param x X coordinate
+ * @param y Y coordinate
+ * @param index Palette index of the text
+ * @param scale Font scale (1 = 5x8 pixels per character)
+ */
+void ili9341_pfb_text(const char *str, uint16_t x, uint16_t y, uint8_t index, uint8_t scale);
+
+/**
+ * @brief Force the next flush to send the whole screen
+ */
+void ili9341_pfb_invalidate(void);
+
+/**
+ * @brief Send the area drawn since the last flush
+ *
+ * Everything drawn since the previous flush is covered by one bounding
+ * rectangle, which goes out as a single windowed burst.
+ *
+ * @return Number of pixels sent to the panel
+ */
+size_t ili9341_pfb_flush(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DISPLAY_PFB_H
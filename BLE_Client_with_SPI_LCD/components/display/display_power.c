@@ -0,0 +1,159 @@
+#include "display.h"
+#include "display_priv.h"
+#include "display_transport.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_rom_sys.h"
+
+static const char *TAG = "ILI9341_PWR";
+
+// Datasheet waits: 5 ms after SLPIN or SLPOUT before the next command,
+// 120 ms after SLPOUT before SLPIN
+#define SLEEP_CMD_WAIT_US 5000
+#define SLEEP_OUT_HOLD_US 120000
+
+// Native scan lines (GRAM rows) and the MADCTL bits that move them
+#define SCAN_LINES ILI9341_PANEL_ROWS
+#define MADCTL_MY  0x80
+#define MADCTL_MV  0x20
+
+// ==== Private Variables ====
+static uint8_t power_modes = ILI9341_POWER_NORMAL;
+static int64_t sleep_cmd_us = 0;      // When the last SLPIN / SLPOUT went out
+static bool sleep_cmd_out = true;     // ... and which one it was
+static uint8_t backlight_level = 100;
+static bool backlight_on = true;
+static uint32_t resume_us = 0;
+
+// ==== Helpers ====
+// Sleep for whole ticks, then spin for the rest, so short datasheet waits
+// aren't rounded up to a full tick
+static void wait_until(int64_t t) {
+    int64_t left = t - esp_timer_get_time();
+    if (left <= 0) {
+        return;
+    }
+    if (left >= portTICK_PERIOD_MS * 1000) {
+        vTaskDelay(left / (portTICK_PERIOD_MS * 1000));
+        left = t - esp_timer_get_time();
+    }
+    if (left > 0) {
+        esp_rom_delay_us(left);
+    }
+}
+
+static void sleep_cmd(bool out) {
+    wait_until(sleep_cmd_us + (!out && sleep_cmd_out ? SLEEP_OUT_HOLD_US : SLEEP_CMD_WAIT_US));
+    ili9341_send_cmd(out ? 0x11 : 0x10, NULL, 0);
+    sleep_cmd_us = esp_timer_get_time();
+    sleep_cmd_out = out;
+}
+
+static void apply_backlight(void) {
+    bool lit = backlight_on && !(power_modes & ILI9341_POWER_SLEEP);
+    ili9341_transport_set_backlight(lit ? backlight_level : 0);
+}
+
+// Scan lines crossing a screen rectangle: along x with row/column
+// exchange (landscape), along y otherwise
+static bool partial_lines(const ili9341_rect_t *r, uint16_t *first, uint16_t *last) {
+    uint8_t madctl = ili9341_get_madctl();
+    int a = (madctl & MADCTL_MV) ? r->x : r->y;
+    int len = (madctl & MADCTL_MV) ? r->w : r->h;
+
+    if (len <= 0 || a < 0 || a + len > SCAN_LINES) {
+        return false;
+    }
+    int b = a + len - 1;
+    if (madctl & MADCTL_MY) {
+        int t = SCAN_LINES - 1 - b;
+        b = SCAN_LINES - 1 - a;
+        a = t;
+    }
+    *first = a;
+    *last = b;
+    return true;
+}
+
+// ==== Backlight ====
+void ili9341_set_backlight(bool state) {
+    backlight_on = state;
+    apply_backlight();
+}
+
+void ili9341_set_backlight_level(uint8_t percent) {
+    backlight_level = (percent > 100) ? 100 : percent;
+    apply_backlight();
+}
+
+// ==== Power Modes ====
+void ili9341_power_reset(void) {
+    power_modes = ILI9341_POWER_NORMAL;
+    sleep_cmd_us = esp_timer_get_time();
+    sleep_cmd_out = true;
+    apply_backlight();
+}
+
+esp_err_t ili9341_set_power_mode(uint8_t modes, const ili9341_rect_t *partial) {
+    if (!ili9341_is_initialized()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uint16_t first = 0, last = 0;
+    if ((modes & ILI9341_POWER_PARTIAL) &&
+        (partial == NULL || !partial_lines(partial, &first, &last))) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int64_t start = esp_timer_get_time();
+    uint8_t old = power_modes;
+    bool entering_sleep = (modes & ILI9341_POWER_SLEEP) && !(old & ILI9341_POWER_SLEEP);
+    bool leaving_sleep = !(modes & ILI9341_POWER_SLEEP) && (old & ILI9341_POWER_SLEEP);
+
+    // Dark before the panel goes off, so nothing fades out on screen
+    if (entering_sleep) {
+        power_modes |= ILI9341_POWER_SLEEP;
+        apply_backlight();
+        ili9341_send_cmd(0x28, NULL, 0); // Display off
+        sleep_cmd(false);
+    } else if (leaving_sleep) {
+        sleep_cmd(true);
+        wait_until(sleep_cmd_us + SLEEP_CMD_WAIT_US);
+    }
+
+    if ((modes ^ old) & ILI9341_POWER_IDLE) {
+        ili9341_send_cmd((modes & ILI9341_POWER_IDLE) ? 0x39 : 0x38, NULL, 0);
+    }
+
+    if (modes & ILI9341_POWER_PARTIAL) {
+        uint8_t area[4] = { first >> 8, first & 0xFF, last >> 8, last & 0xFF };
+        ili9341_send_cmd(0x30, area, sizeof(area)); // Partial area
+        if (!(old & ILI9341_POWER_PARTIAL)) {
+            ili9341_send_cmd(0x12, NULL, 0);       // Partial mode on
+        }
+    } else if (old & ILI9341_POWER_PARTIAL) {
+        ili9341_send_cmd(0x13, NULL, 0);           // Normal display mode on
+    }
+
+    power_modes = modes;
+    if (leaving_sleep) {
+        ili9341_send_cmd(0x29, NULL, 0); // Display on
+        apply_backlight();
+    }
+
+    if (old != ILI9341_POWER_NORMAL && modes == ILI9341_POWER_NORMAL) {
+        resume_us = (uint32_t)(esp_timer_get_time() - start);
+        ESP_LOGI(TAG, "Resumed from 0x%02x in %lu us", old, (unsigned long)resume_us);
+    }
+    return ESP_OK;
+}
+
+uint8_t ili9341_get_power_mode(void) {
+    return power_modes;
+}
+
+uint32_t ili9341_get_resume_us(void) {
+    return resume_us;
+}
@@ -0,0 +1,192 @@
+#ifndef DISPLAY_PRIV_H
+#define DISPLAY_PRIV_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "sdkconfig.h"
+#include "display.h"
+#include "display_perf.h"
+
+// Internal helpers shared by the display component's source files.
+// Not part of the public API.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Glyph metrics of the built-in 5x8 font, before scaling
+#define ILI9341_FONT_WIDTH   5
+#define ILI9341_FONT_HEIGHT  8
+#define ILI9341_FONT_SPACING 1
+
+/**
+ * @brief Get the column bitmap of a character in the 5x8 font
+ * @param c Character; anything outside 32-127 maps to '?'
+ * @return 5 column bytes, bit n set means row n is lit
+ */
+const uint8_t *ili9341_font_glyph(char c);
+
+/**
+ * @brief Get the row bitmap of a character (row-major, generated at build time)
+ * @param c Character; anything outside 32-127 maps to '?'
+ * @return 8 row bytes, bit c set means column c is lit
+ */
+const uint8_t *ili9341_font_rows(char c);
+
+/**
+ * @brief Build the pixel-pair table used by ili9341_font_expand_row()
+ * @param pair Receives the 4 words for each two-pixel on/off combination
+ * @param fg Foreground, already byte swapped
+ * @param bg Background, already byte swapped
+ */
+void ili9341_font_pair_lut(uint32_t pair[4], uint16_t fg, uint16_t bg);
+
+/**
+ * @brief Expand one font row into cols*scale pixels
+ *
+ * The column mask is widened through a per-scale lookup table and written
+ * two pixels per 32-bit store.
+ *
+ * @param dst Destination (2-byte aligned)
+ * @param mask Row bits from ili9341_font_rows(); bit 5 is the spacing column
+ * @param cols Columns to expand (5 for the glyph, 6 with spacing)
+ * @param scale Horizontal scale
+ * @param pair Table from ili9341_font_pair_lut()
+ */
+void ili9341_font_expand_row(uint16_t *dst, uint8_t mask, int cols, uint8_t scale,
+                             const uint32_t pair[4]);
+
+// MADCTL values: landscape (row/column exchange) as set up by init, and
+// native portrait, whose rows run along the hardware scroll direction
+#define ILI9341_MADCTL_LANDSCAPE ILI9341_PANEL_MADCTL_LANDSCAPE
+#define ILI9341_MADCTL_PORTRAIT  ILI9341_PANEL_MADCTL_PORTRAIT
+
+/**
+ * @brief Send a command and its parameters in one CS assertion
+ */
+void ili9341_send_cmd(uint8_t cmd, const uint8_t *params, size_t len);
+
+/**
+ * @brief Whether ili9341_init() has completed
+ */
+bool ili9341_is_initialized(void);
+
+/**
+ * @brief Get the MADCTL parameter last sent
+ */
+uint8_t ili9341_get_madctl(void);
+
+/**
+ * @brief Forget power modes after the init sequence: awake, normal
+ *        display, backlight at its level, SLPOUT just sent
+ */
+void ili9341_power_reset(void);
+
+/**
+ * @brief Change the memory access order and the bounds used for clipping
+ * @param madctl MADCTL (0x36) parameter
+ * @param width Screen width in the new orientation
+ * @param height Screen height in the new orientation
+ */
+void ili9341_set_madctl(uint8_t madctl, uint16_t width, uint16_t height);
+
+// Produces the next count pixels (already byte swapped) of a stream. The
+// source either fills the DMA scratch buffer and returns it, or returns a
+// pointer into DMA-capable memory of its own to be sent without copying.
+typedef const uint16_t *(*ili9341_pixel_source_t)(uint16_t *scratch, size_t count, void *arg);
+
+/**
+ * @brief Stream pixels to the current window through the DMA buffers
+ * @param total Number of pixels in the window
+ * @param source Called for each chunk of at most one DMA buffer
+ * @param arg Passed to source
+ */
+void ili9341_stream_pixels(size_t total, ili9341_pixel_source_t source, void *arg);
+
+/**
+ * @brief Intersect a rectangle in signed coordinates with the clip rectangle
+ * @param out Receives the visible part
+ * @return false if nothing is visible
+ */
+bool ili9341_clip_rect(int x, int y, int w, int h, ili9341_rect_t *out);
+
+// Sequential decoder for an ili9341_image_t. Only the packet being decoded
+// is tracked; pixels are read from the (flash) stream on demand.
+typedef struct {
+    const uint16_t *palette;
+    uint16_t palette_len;
+    const uint8_t *p;         // Next unread byte of the stream
+    const uint8_t *end;
+    uint16_t run;             // Pixels left in the current packet
+    bool literal;             // Current packet holds one index per pixel
+    uint16_t value;           // Colour of a repeat packet
+} ili9341_image_reader_t;
+
+/**
+ * @brief Start decoding an image from its first pixel
+ */
+void ili9341_image_reader_init(ili9341_image_reader_t *r, const ili9341_image_t *img);
+
+/**
+ * @brief Decode the next n pixels, byte swapped, into dst
+ * @return false if the stream ended early; the missing pixels are black
+ */
+bool ili9341_image_read(ili9341_image_reader_t *r, uint16_t *dst, size_t n);
+
+/**
+ * @brief Move past n pixels without producing them
+ * @return false if the stream ended early
+ */
+bool ili9341_image_skip(ili9341_image_reader_t *r, uint32_t n);
+
+/**
+ * @brief Empty the glyph cache and set its byte budget (0 disables it)
+ */
+void ili9341_glyph_cache_setup(size_t budget_bytes);
+
+/**
+ * @brief Find an expanded glyph block
+ *
+ * Counts a hit or a miss and marks a found entry as most recently used.
+ *
+ * @return Byte-swapped, DMA-capable 5*scale x 8*scale block, or NULL
+ */
+const uint16_t *ili9341_glyph_cache_lookup(char c, uint8_t scale, uint16_t fg, uint16_t bg);
+
+/**
+ * @brief Make room for a glyph block, evicting as needed
+ * @return Block for the caller to fill in, or NULL if it can't be cached
+ */
+uint16_t *ili9341_glyph_cache_insert(char c, uint8_t scale, uint16_t fg, uint16_t bg);
+
+// ==== Performance Hooks ====
+// Wrap a primitive in ILI9341_PERF_BEGIN(scope) ... ILI9341_PERF_END(prim,
+// scope). Without CONFIG_ILI9341_PERF_STATS both expand to nothing.
+#ifdef CONFIG_ILI9341_PERF_STATS
+typedef struct {
+    int64_t start_us;
+    uint32_t transactions;
+    uint64_t bytes;
+} ili9341_perf_scope_t;
+
+void ili9341_perf_begin(ili9341_perf_scope_t *scope);
+void ili9341_perf_end(ili9341_perf_prim_t prim, const ili9341_perf_scope_t *scope);
+
+#define ILI9341_PERF_BEGIN(scope)     ili9341_perf_scope_t scope; ili9341_perf_begin(&scope)
+#define ILI9341_PERF_END(prim, scope) ili9341_perf_end(prim, &scope)
+#else
+#define ILI9341_PERF_BEGIN(scope)     do { } while (0)
+#define ILI9341_PERF_END(prim, scope) do { } while (0)
+#endif
+
+// RGB565 values go out MSB first; swap once so buffers can be sent as-is
+static inline uint16_t ili9341_swap16(uint16_t v) {
+    return (uint16_t)((v << 8) | (v >> 8));
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DISPLAY_PRIV_H
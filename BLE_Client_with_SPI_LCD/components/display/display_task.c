@@ -0,0 +1,393 @@
+#include "display_task.h"
+#include "display.h"
+#include "display_fb.h"
+#include "display_widget.h"
+#include "display_console.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+#include <string.h>
+
+static const char *TAG = "ILI9341_TASK";
+
+typedef struct {
+    bool visible;
+    uint8_t scale;
+    uint16_t x;
+    uint16_t y;
+    uint16_t color;
+    char text[ILI9341_TASK_TEXT_MAX + 1];
+} display_line_t;
+
+typedef struct {
+    const ili9341_image_t *image;  // NULL when the slot is empty
+    uint16_t x;
+    uint16_t y;
+} display_image_t;
+
+typedef struct {
+    bool visible;            // Wanted on screen
+    uint8_t digits;
+    uint8_t scale;
+    uint16_t x;
+    uint16_t y;
+    uint16_t color;
+    int32_t value;
+} display_value_t;
+
+// Everything the screen should show. Posting overwrites it under
+// state_lock, so a burst of updates folds into the latest state and
+// nothing is ever dropped; the render task takes a copy to draw from.
+typedef struct {
+    display_line_t lines[ILI9341_TASK_MAX_LINES];
+    display_value_t values[ILI9341_TASK_MAX_VALUES];
+    display_image_t images[ILI9341_TASK_MAX_IMAGES];
+    bool console;
+    bool power_pending;      // Switch power modes once the frame is drawn
+    uint8_t power_modes;
+    ili9341_rect_t power_area;
+    bool backlight_pending;
+    uint8_t backlight;
+} display_state_t;
+
+typedef struct {
+    uint16_t color;
+    char text[ILI9341_TASK_TEXT_MAX + 1];
+} console_line_t;
+
+// ==== Private Variables ====
+static TaskHandle_t render_handle = NULL;
+static QueueHandle_t console_queue = NULL;  // Console lines, printed in order
+static portMUX_TYPE state_lock = portMUX_INITIALIZER_UNLOCKED;
+static display_state_t posted;              // Guarded by state_lock
+
+// Owned by the render task
+static display_state_t state;               // Copy being drawn
+static ili9341_value_t value_widgets[ILI9341_TASK_MAX_VALUES];
+static bool value_shown[ILI9341_TASK_MAX_VALUES];
+
+// Bring the value widgets in line with state before a frame
+static void update_values(void) {
+    for (int i = 0; i < ILI9341_TASK_MAX_VALUES; i++) {
+        const display_value_t *v = &state.values[i];
+        ili9341_label_t *label = &value_widgets[i].label;
+        if (!v->visible) {
+            continue;
+        }
+        // Moving or restyling the widget means erasing and starting over
+        if (value_shown[i] && (label->x != v->x || label->y != v->y || label->cells != v->digits ||
+                               label->fg != v->color || label->scale != v->scale)) {
+            ili9341_label_set(label, "");
+            value_shown[i] = false;
+        }
+        if (!value_shown[i]) {
+            ili9341_value_init(&value_widgets[i], v->x, v->y, v->digits, v->color,
+                               ILI9341_BLACK, v->scale);
+        }
+    }
+}
+
+static void render_frame(void) {
+    if (ili9341_console_active()) {
+        return;
+    }
+
+    ili9341_fb_begin();
+    ili9341_fb_fill(ILI9341_BLACK);
+    for (int i = 0; i < ILI9341_TASK_MAX_IMAGES; i++) {
+        const display_image_t *img = &state.images[i];
+        if (img->image != NULL) {
+            ili9341_fb_image(img->image, img->x, img->y);
+        }
+    }
+    for (int i = 0; i < ILI9341_TASK_MAX_LINES; i++) {
+        const display_line_t *line = &state.lines[i];
+        if (line->visible) {
+            ili9341_fb_text(line->text, line->x, line->y, line->color, line->scale);
+        }
+    }
+    size_t sent = ili9341_fb_flush();
+
+    for (int i = 0; i < ILI9341_TASK_MAX_VALUES; i++) {
+        ili9341_value_t *widget = &value_widgets[i];
+        // The flush may have painted over a widget; redraw it in full
+        if (sent > 0) {
+            ili9341_label_invalidate(&widget->label);
+        }
+        if (state.values[i].visible) {
+            ili9341_value_set(widget, state.values[i].value);
+            value_shown[i] = true;
+        } else if (value_shown[i]) {
+            ili9341_label_set(&widget->label, "");
+            value_shown[i] = false;
+        }
+    }
+}
+
+static void render_task(void *arg) {
+    console_line_t line;
+
+    while (1) {
+        // Every post since the last frame is folded into one wake-up
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        taskENTER_CRITICAL(&state_lock);
+        state = posted;
+        posted.power_pending = false;
+        posted.backlight_pending = false;
+        taskEXIT_CRITICAL(&state_lock);
+
+        if (state.console && !ili9341_console_active()) {
+            ili9341_console_start(ILI9341_BLACK);
+            for (int i = 0; i < ILI9341_TASK_MAX_VALUES; i++) {
+                value_shown[i] = false;
+            }
+        }
+        while (xQueueReceive(console_queue, &line, 0) == pdTRUE) {
+            if (ili9341_console_active()) {
+                ili9341_console_print(line.text, line.color);
+            }
+        }
+        if (!state.console && ili9341_console_active()) {
+            ili9341_console_stop(ILI9341_BLACK);
+            ili9341_fb_invalidate();
+        }
+
+        if (state.backlight_pending) {
+            ili9341_set_backlight_level(state.backlight);
+        }
+
+        update_values();
+        render_frame();
+
+        if (state.power_pending) {
+            ili9341_set_power_mode(state.power_modes, &state.power_area);
+        }
+    }
+}
+
+// Posting changes `posted` between post_begin() and post_end(). The lock
+// only covers copying a few bytes, so this is safe from any task.
+static bool post_begin(void) {
+    if (render_handle == NULL) {
+        return false;
+    }
+    taskENTER_CRITICAL(&state_lock);
+    return true;
+}
+
+static bool post_end(void) {
+    taskEXIT_CRITICAL(&state_lock);
+    xTaskNotifyGive(render_handle);
+    return true;
+}
+
+esp_err_t ili9341_task_start(void) {
+    if (render_handle != NULL) {
+        return ESP_OK; // Already running
+    }
+
+    console_queue = xQueueCreate(ILI9341_TASK_CONSOLE_QUEUE_LEN, sizeof(console_line_t));
+    if (console_queue == NULL) {
+        ESP_LOGE(TAG, "Failed to create console queue");
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (xTaskCreate(render_task, "display", ILI9341_TASK_STACK_SIZE, NULL,
+                    ILI9341_TASK_PRIORITY, &render_handle) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create render task");
+        vQueueDelete(console_queue);
+        console_queue = NULL;
+        render_handle = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    return ESP_OK;
+}
+
+bool ili9341_task_set_line(uint8_t slot, const char *text, uint16_t x, uint16_t y,
+                           uint16_t color, uint8_t scale) {
+    if (slot >= ILI9341_TASK_MAX_LINES || text == NULL) {
+        return false;
+    }
+
+    display_line_t line = {
+        .visible = true,
+        .scale = scale,
+        .x = x,
+        .y = y,
+        .color = color,
+    };
+    memcpy(line.text, text, strnlen(text, ILI9341_TASK_TEXT_MAX));  // line is zeroed
+    if (!post_begin()) {
+        return false;
+    }
+    posted.lines[slot] = line;
+    return post_end();
+}
+
+bool ili9341_task_set_line_aligned(uint8_t slot, const char *text, uint16_t x, uint16_t y,
+                                   ili9341_align_t align, uint16_t color, uint8_t scale) {
+    if (text == NULL) {
+        return false;
+    }
+
+    // Measure what will actually be drawn
+    char shown[ILI9341_TASK_TEXT_MAX + 1];
+    size_t len = strnlen(text, ILI9341_TASK_TEXT_MAX);
+    memcpy(shown, text, len);
+    shown[len] = '\0';
+
+    uint16_t width = ili9341_text_measure(shown, scale ? scale : 1);
+    if (align == ILI9341_ALIGN_CENTER) {
+        width /= 2;
+    } else if (align == ILI9341_ALIGN_LEFT) {
+        width = 0;
+    }
+    return ili9341_task_set_line(slot, shown, x > width ? x - width : 0, y, color, scale);
+}
+
+bool ili9341_task_clear_line(uint8_t slot) {
+    if (slot >= ILI9341_TASK_MAX_LINES) {
+        return false;
+    }
+
+    if (!post_begin()) {
+        return false;
+    }
+    posted.lines[slot].visible = false;
+    return post_end();
+}
+
+bool ili9341_task_set_value(uint8_t slot, int32_t value, uint16_t x, uint16_t y,
+                            uint8_t digits, uint16_t color, uint8_t scale) {
+    if (slot >= ILI9341_TASK_MAX_VALUES || digits == 0) {
+        return false;
+    }
+
+    display_value_t v = {
+        .visible = true,
+        .digits = digits,
+        .scale = scale,
+        .x = x,
+        .y = y,
+        .color = color,
+        .value = value,
+    };
+    if (!post_begin()) {
+        return false;
+    }
+    posted.values[slot] = v;
+    return post_end();
+}
+
+bool ili9341_task_clear_value(uint8_t slot) {
+    if (slot >= ILI9341_TASK_MAX_VALUES) {
+        return false;
+    }
+
+    if (!post_begin()) {
+        return false;
+    }
+    posted.values[slot].visible = false;
+    return post_end();
+}
+
+bool ili9341_task_set_image(uint8_t slot, const ili9341_image_t *img, uint16_t x, uint16_t y) {
+    if (slot >= ILI9341_TASK_MAX_IMAGES || img == NULL) {
+        return false;
+    }
+
+    display_image_t image = { img, x, y };
+    if (!post_begin()) {
+        return false;
+    }
+    posted.images[slot] = image;
+    return post_end();
+}
+
+bool ili9341_task_clear_image(uint8_t slot) {
+    if (slot >= ILI9341_TASK_MAX_IMAGES) {
+        return false;
+    }
+
+    if (!post_begin()) {
+        return false;
+    }
+    posted.images[slot].image = NULL;
+    return post_end();
+}
+
+bool ili9341_task_console_start(void) {
+    if (!post_begin()) {
+        return false;
+    }
+    posted.console = true;
+    return post_end();
+}
+
+bool ili9341_task_console_print(const char *text, uint16_t color) {
+    if (text == NULL || render_handle == NULL) {
+        return false;
+    }
+
+    console_line_t line = { .color = color };
+    memcpy(line.text, text, strnlen(text, ILI9341_TASK_TEXT_MAX));  // line is zeroed
+    if (xQueueSend(console_queue, &line, 0) != pdTRUE) {
+        return false;
+    }
+    xTaskNotifyGive(render_handle);
+    return true;
+}
+
+bool ili9341_task_console_stop(void) {
+    if (!post_begin()) {
+        return false;
+    }
+    posted.console = false;
+    return post_end();
+}
+
+bool ili9341_task_clear_all(void) {
+    if (!post_begin()) {
+        return false;
+    }
+    for (int i = 0; i < ILI9341_TASK_MAX_LINES; i++) {
+        posted.lines[i].visible = false;
+    }
+    for (int i = 0; i < ILI9341_TASK_MAX_VALUES; i++) {
+        posted.values[i].visible = false;
+    }
+    for (int i = 0; i < ILI9341_TASK_MAX_IMAGES; i++) {
+        posted.images[i].image = NULL;
+    }
+    return post_end();
+}
+
+bool ili9341_task_set_power(uint8_t modes, const ili9341_rect_t *partial) {
+    if ((modes & ILI9341_POWER_PARTIAL) && partial == NULL) {
+        return false;
+    }
+
+    ili9341_rect_t area = { 0, 0, 0, 0 };
+    if (partial != NULL) {
+        area = *partial;
+    }
+    if (!post_begin()) {
+        return false;
+    }
+    posted.power_pending = true;
+    posted.power_modes = modes;
+    posted.power_area = area;
+    return post_end();
+}
+
+bool ili9341_task_set_backlight(uint8_t percent) {
+    if (!post_begin()) {
+        return false;
+    }
+    posted.backlight_pending = true;
+    posted.backlight = percent;
+    return post_end();
+}
@@ -0,0 +1,190 @@
+#ifndef DISPLAY_TASK_H
+#define DISPLAY_TASK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "display.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ==== Display Render Task ====
+//
+// Once started, the render task is the only code that touches the panel.
+// Other tasks (BLE callbacks in particular) post updates that only
+// overwrite a description of the screen, under a lock held for a few
+// bytes' copy, and wake the task. Posting never blocks, never logs and
+// never loses an update: however many arrive before the task runs, it
+// draws one frame of the latest state through the strip renderer, so
+// superseded updates cost nothing and unchanged screens send no pixels.
+//
+// Image slots hold compressed icons (see ili9341_draw_image()); they are
+// part of the frame, drawn under the text lines.
+//
+// Numeric value slots are retained widgets drawn after the frame: a new
+// reading only resends the digits that changed. They must not overlap the
+// text lines.
+//
+// In console mode (see display_console.h) lines and values are still
+// tracked but not drawn; stopping the console redraws the frame in full.
+
+#define ILI9341_TASK_MAX_LINES         4
+#define ILI9341_TASK_MAX_VALUES        2
+#define ILI9341_TASK_MAX_IMAGES        2
+#define ILI9341_TASK_TEXT_MAX          40
+#define ILI9341_TASK_CONSOLE_QUEUE_LEN 16
+#define ILI9341_TASK_STACK_SIZE        3072
+#define ILI9341_TASK_PRIORITY          4
+
+/**
+ * @brief Start the render task
+ *
+ * ili9341_init() and ili9341_fb_init() must have succeeded first. From
+ * here on, draw only through the ili9341_task_* functions.
+ *
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the console queue or task can't be created
+ */
+esp_err_t ili9341_task_start(void);
+
+/**
+ * @brief Show a line of text
+ *
+ * Replaces whatever the slot showed before. Never blocks.
+ *
+ * @param slot Line slot (0 to ILI9341_TASK_MAX_LINES - 1); later slots draw on top
+ * @param text String to display (copied, truncated to ILI9341_TASK_TEXT_MAX)
+ * @param x X coordinate
+ * @param y Y coordinate
+ * @param color 16-bit RGB565 color value
+ * @param scale Font scale (1 = 5x8 pixels per character)
+ * @return true if posted, false if the slot is invalid or the task isn't running
+ */
+bool ili9341_task_set_line(uint8_t slot, const char *text, uint16_t x, uint16_t y,
+                           uint16_t color, uint8_t scale);
+
+/**
+ * @brief Show a line of text anchored at x
+ *
+ * Like ili9341_task_set_line(), with the left edge worked out from the
+ * measured width of the (truncated) text. Text wider than the space left
+ * of the anchor starts at x = 0.
+ *
+ * @param slot Line slot (0 to ILI9341_TASK_MAX_LINES - 1)
+ * @param text String to display
+ * @param x Anchor X coordinate, e.g. ILI9341_WIDTH / 2 to centre
+ * @param y Y coordinate
+ * @param align Which part of the text x refers to
+ * @param color 16-bit RGB565 color value
+ * @param scale Font scale
+ * @return true if posted, false if the slot is invalid or the task isn't running
+ */
+bool ili9341_task_set_line_aligned(uint8_t slot, const char *text, uint16_t x, uint16_t y,
+                                   ili9341_align_t align, uint16_t color, uint8_t scale);
+
+/**
+ * @brief Remove a line of text
+ * @param slot Line slot
+ * @return true if posted, false if the slot is invalid or the task isn't running
+ */
+bool ili9341_task_clear_line(uint8_t slot);
+
+/**
+ * @brief Remove all lines, leaving a blank screen
+ * @return true if posted, false if the task isn't running
+ */
+bool ili9341_task_clear_all(void);
+
+/**
+ * @brief Show a number, or update the one already in the slot
+ *
+ * Only the digits that differ from what is on screen are redrawn, so this
+ * is cheap enough for live sensor readings. Never blocks.
+ *
+ * @param slot Value slot (0 to ILI9341_TASK_MAX_VALUES - 1)
+ * @param value Number to display
+ * @param x X coordinate
+ * @param y Y coordinate
+ * @param digits Width in character cells, right aligned
+ * @param color 16-bit RGB565 color value (drawn on black)
+ * @param scale Font scale
+ * @return true if posted, false if the slot is invalid or the task isn't running
+ */
+bool ili9341_task_set_value(uint8_t slot, int32_t value, uint16_t x, uint16_t y,
+                            uint8_t digits, uint16_t color, uint8_t scale);
+
+/**
+ * @brief Remove a number from the screen
+ * @param slot Value slot
+ * @return true if posted, false if the slot is invalid or the task isn't running
+ */
+bool ili9341_task_clear_value(uint8_t slot);
+
+/**
+ * @brief Show an image, or move the one already in the slot
+ * @param slot Image slot (0 to ILI9341_TASK_MAX_IMAGES - 1)
+ * @param img Image to draw; only the pointer is kept, so it must stay
+ *            valid (const data generated by gen_image.py)
+ * @param x X coordinate of the top-left corner
+ * @param y Y coordinate of the top-left corner
+ * @return true if posted, false if the slot is invalid or the task isn't running
+ */
+bool ili9341_task_set_image(uint8_t slot, const ili9341_image_t *img, uint16_t x, uint16_t y);
+
+/**
+ * @brief Remove an image from the screen
+ * @param slot Image slot
+ * @return true if posted, false if the slot is invalid or the task isn't running
+ */
+bool ili9341_task_clear_image(uint8_t slot);
+
+/**
+ * @brief Change panel power modes (see ili9341_set_power_mode())
+ *
+ * Takes effect after the frame for any updates posted before it has been
+ * drawn, so waking up shows the new content rather than the old one.
+ *
+ * @param modes ILI9341_POWER_* flags
+ * @param partial Area to keep visible with ILI9341_POWER_PARTIAL (copied)
+ * @return true if posted, false if partial is missing or the task isn't running
+ */
+bool ili9341_task_set_power(uint8_t modes, const ili9341_rect_t *partial);
+
+/**
+ * @brief Set the backlight dim level (see ili9341_set_backlight_level())
+ * @param percent 0 to 100
+ * @return true if posted, false if the task isn't running
+ */
+bool ili9341_task_set_backlight(uint8_t percent);
+
+/**
+ * @brief Switch the screen to the scrolling console
+ * @return true if posted, false if the task isn't running
+ */
+bool ili9341_task_console_start(void);
+
+/**
+ * @brief Append a line to the console (ignored unless the console is on)
+ *
+ * Lines are printed in order, so unlike the other updates they are
+ * queued rather than coalesced; with ILI9341_TASK_CONSOLE_QUEUE_LEN
+ * lines waiting, further lines are dropped.
+ *
+ * @param text Line to append (copied, truncated to ILI9341_TASK_TEXT_MAX)
+ * @param color 16-bit RGB565 color value
+ * @return true if queued, false if the queue is full or the task isn't running
+ */
+bool ili9341_task_console_print(const char *text, uint16_t color);
+
+/**
+ * @brief Leave the console and go back to the lines and values
+ * @return true if posted, false if the task isn't running
+ */
+bool ili9341_task_console_stop(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DISPLAY_TASK_H
@@ -0,0 +1,164 @@
+#ifndef DISPLAY_TRANSPORT_H
+#define DISPLAY_TRANSPORT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "display.h"
+
+// ==== Panel Transport ====
+//
+// Everything display.c sends to the panel goes through these functions.
+// Exactly one implementation is linked, chosen by the build for the
+// target: display_transport_spi.c drives the ESP SPI master,
+// display_transport_linux.c feeds an in-memory virtual panel.
+//
+// Internal to the display component.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Transport-level DC values
+#define ILI9341_DC_CMD  false
+#define ILI9341_DC_DATA true
+
+// Defaults for the zero fields of ili9341_config_t
+#define ILI9341_DEFAULT_CLOCK_HZ     (40 * 1000 * 1000)
+#define ILI9341_DEFAULT_MAX_TRANSFER (ILI9341_WIDTH * 16 * ILI9341_PANEL_BPP)
+#define ILI9341_DEFAULT_QUEUE_DEPTH  2
+#define ILI9341_MIN_TRANSFER         (32 * ILI9341_PANEL_BPP)
+
+static inline int ili9341_config_clock_hz(const ili9341_config_t *config) {
+    return config->spi_clock_speed_hz > 0 ? config->spi_clock_speed_hz : ILI9341_DEFAULT_CLOCK_HZ;
+}
+
+// Always whole pixels in the panel's wire format
+static inline size_t ili9341_config_max_transfer(const ili9341_config_t *config) {
+    size_t bytes = config->max_transfer_bytes;
+    if (bytes == 0) {
+        return ILI9341_DEFAULT_MAX_TRANSFER;
+    }
+    return (bytes < ILI9341_MIN_TRANSFER) ? ILI9341_MIN_TRANSFER :
+           bytes - bytes % ILI9341_PANEL_BPP;
+}
+
+static inline int ili9341_config_queue_depth(const ili9341_config_t *config) {
+    if (config->queue_depth == 0) {
+        return ILI9341_DEFAULT_QUEUE_DEPTH;
+    }
+    return (config->queue_depth > ILI9341_MAX_QUEUE_DEPTH) ? ILI9341_MAX_QUEUE_DEPTH : config->queue_depth;
+}
+
+/**
+ * @brief Set up control pins and the bus for the configured panel
+ * @param config Display configuration (must outlive the transport)
+ * @return ESP_OK on success, error code on failure
+ */
+esp_err_t ili9341_transport_init(const ili9341_config_t *config);
+
+/**
+ * @brief Release the bus and device
+ */
+void ili9341_transport_deinit(void);
+
+/**
+ * @brief Assert / release CS around a group of transfers
+ *
+ * Only does anything when CS is driven by hand; with hardware CS every
+ * transfer is framed by the peripheral.
+ */
+void ili9341_transport_select(void);
+void ili9341_transport_deselect(void);
+
+/**
+ * @brief Change the bus clock
+ *
+ * No transfer may be outstanding. On failure the previous clock stays.
+ *
+ * @param hz Requested clock
+ * @param actual_hz Receives the clock the bus really runs at (may be NULL)
+ * @return ESP_OK on success, error code if the clock can't be used
+ */
+esp_err_t ili9341_transport_set_clock(int hz, int *actual_hz);
+
+/**
+ * @brief Get the clock the bus runs at
+ */
+int ili9341_transport_get_clock(void);
+
+/**
+ * @brief Blocking write of one command or data phase
+ *
+ * Writes longer than the configured maximum transfer go out in pieces.
+ *
+ * @param dc ILI9341_DC_CMD or ILI9341_DC_DATA
+ * @param data Bytes to send
+ * @param len Number of bytes
+ * @return ESP_OK on success
+ */
+esp_err_t ili9341_transport_write(bool dc, const void *data, size_t len);
+
+/**
+ * @brief Blocking write of a command byte followed by its parameters
+ *
+ * Parameters of up to four bytes use pre-built descriptors and skip DMA.
+ *
+ * @param cmd Command byte
+ * @param params Parameter bytes (may be NULL when len is 0)
+ * @param len Number of parameter bytes
+ * @return ESP_OK on success
+ */
+esp_err_t ili9341_transport_write_cmd(uint8_t cmd, const uint8_t *params, size_t len);
+
+/**
+ * @brief Queue a data phase without waiting for it
+ *
+ * The buffer must stay valid and untouched until the matching
+ * ili9341_transport_wait() returns. At most ili9341_config_queue_depth()
+ * transfers may be outstanding.
+ *
+ * @param data DMA-capable bytes to send
+ * @param len Number of bytes, at most ili9341_config_max_transfer()
+ * @return ESP_OK if queued
+ */
+esp_err_t ili9341_transport_queue(const void *data, size_t len);
+
+/**
+ * @brief Wait for the oldest queued transfer to complete
+ * @return ESP_OK on success
+ */
+esp_err_t ili9341_transport_wait(void);
+
+/**
+ * @brief Drive the panel reset line
+ * @param level 1 = released, 0 = held in reset
+ */
+void ili9341_transport_set_reset(int level);
+
+/**
+ * @brief Drive the backlight pin, if one is configured
+ *
+ * With CONFIG_ILI9341_BCKL_PWM the level is an LEDC duty cycle; otherwise
+ * the pin is switched on for any level above 0.
+ *
+ * @param percent 0 = off, 100 = fully on
+ */
+void ili9341_transport_set_backlight(uint8_t percent);
+
+/**
+ * @brief Read bus counters
+ * @param stats Filled with the counters since init or the last reset
+ */
+void ili9341_transport_get_stats(ili9341_bus_stats_t *stats);
+
+/**
+ * @brief Zero the bus counters
+ */
+void ili9341_transport_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DISPLAY_TRANSPORT_H
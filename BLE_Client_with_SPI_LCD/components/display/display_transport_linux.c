@@ -0,0 +1,525 @@
+#include "display_transport.h"
+#include "display_virtual.h"
+#include "display_panel.h"
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "ILI9341_VIRT";
+
+// Native GRAM geometry (portrait) of the configured controller
+#define GRAM_COLS ILI9341_PANEL_COLS
+#define GRAM_ROWS ILI9341_PANEL_ROWS
+
+// MADCTL bits
+#define MADCTL_MY 0x80
+#define MADCTL_MX 0x40
+#define MADCTL_MV 0x20
+
+// Parameter bytes expected by the commands the model understands
+#define MAX_PARAMS 16
+
+// Datasheet waits after SLPIN / SLPOUT: 5 ms before any command, and
+// 120 ms after SLPOUT before SLPIN
+#define SLEEP_CMD_WAIT_US 5000
+#define SLEEP_OUT_HOLD_US 120000
+
+// ==== Private Variables ====
+static const ili9341_config_t *display_config = NULL;
+static uint16_t gram[GRAM_ROWS][GRAM_COLS];
+
+// Modelled bus: clock and limits from the config, plus an optional rate
+// cap that makes transfers take real time (see ili9341_virtual_set_bus_limit)
+static int clock_hz = 0;
+static size_t max_transfer = 0;
+static int queue_depth = 0;
+static int bus_limit_hz = 0;
+static int64_t bus_free_us = 0;
+static uint8_t backlight = 100;
+
+static struct {
+    uint8_t cmd;                // Command whose parameters are being received
+    uint8_t params[MAX_PARAMS];
+    int param_count;
+    uint16_t col_start, col_end;
+    uint16_t page_start, page_end;
+    uint16_t cur_col, cur_page; // RAMWR cursor
+    uint8_t pixel_bytes[3];     // Start of a pixel split across writes
+    int pixel_fill;
+    uint8_t madctl;
+    uint8_t colmod;
+    bool sleeping;
+    bool display_on;
+    bool idle;
+    bool partial;
+    bool inverted;
+    uint16_t ptl_start, ptl_end; // Partial area, in GRAM rows
+    uint16_t tfa, vsa, bfa;     // Vertical scroll definition
+    uint16_t vsp;               // Vertical scroll start address
+    int dc;
+    int outstanding;            // Queued transfers not yet waited for
+    int64_t sleep_cmd_us;       // When the last SLPIN / SLPOUT arrived
+    bool sleep_cmd_out;         // ... and which one it was
+} panel;
+
+static uint32_t timing_violations = 0;
+
+// Bus counters
+static uint32_t transaction_count = 0;
+static uint64_t byte_count = 0;
+static uint64_t wire_ns = 0;
+static uint32_t gpio_toggles = 0;
+
+// Power-on / reset defaults from the datasheet
+static void panel_reset(void) {
+    panel.cmd = 0x00;
+    panel.param_count = 0;
+    panel.col_start = 0;
+    panel.col_end = GRAM_COLS - 1;
+    panel.page_start = 0;
+    panel.page_end = GRAM_ROWS - 1;
+    panel.cur_col = 0;
+    panel.cur_page = 0;
+    panel.pixel_fill = 0;
+    panel.madctl = 0x00;
+    panel.colmod = 0x66;
+    panel.sleeping = true;
+    panel.display_on = false;
+    panel.idle = false;
+    panel.partial = false;
+    panel.ptl_start = 0;
+    panel.ptl_end = GRAM_ROWS - 1;
+    panel.inverted = false;
+    panel.tfa = 0;
+    panel.vsa = GRAM_ROWS;
+    panel.bfa = 0;
+    panel.vsp = 0;
+}
+
+// Logical (column, page) address in the current MADCTL -> GRAM row/column
+static bool panel_map(int c, int p, int *row, int *col) {
+    int x = c;
+    int y = p;
+
+    if (panel.madctl & MADCTL_MV) {
+        x = p;
+        y = c;
+    }
+    if (panel.madctl & MADCTL_MX) {
+        x = GRAM_COLS - 1 - x;
+    }
+    if (panel.madctl & MADCTL_MY) {
+        y = GRAM_ROWS - 1 - y;
+    }
+    if (x < 0 || x >= GRAM_COLS || y < 0 || y >= GRAM_ROWS) {
+        return false;
+    }
+    *row = y;
+    *col = x;
+    return true;
+}
+
+static void panel_write_pixel(uint16_t value) {
+    int row, col;
+
+    if (panel_map(panel.cur_col, panel.cur_page, &row, &col)) {
+        gram[row][col] = value;
+    }
+
+    // Column first, then page, wrapping inside the window
+    if (panel.cur_col >= panel.col_end) {
+        panel.cur_col = panel.col_start;
+        panel.cur_page = (panel.cur_page >= panel.page_end) ? panel.page_start : panel.cur_page + 1;
+    } else {
+        panel.cur_col++;
+    }
+}
+
+// Commands sent too soon after SLPIN / SLPOUT are counted, not rejected:
+// the real controller's behaviour then is undefined
+static void panel_check_sleep_timing(uint8_t cmd) {
+    int64_t since = esp_timer_get_time() - panel.sleep_cmd_us;
+
+    if (panel.sleep_cmd_us != 0 && since < SLEEP_CMD_WAIT_US) {
+        ESP_LOGW(TAG, "Command 0x%02x %lld us after sleep %s", cmd, (long long)since,
+                 panel.sleep_cmd_out ? "out" : "in");
+        timing_violations++;
+    } else if (cmd == 0x10 && panel.sleep_cmd_out && since < SLEEP_OUT_HOLD_US) {
+        ESP_LOGW(TAG, "Sleep in %lld us after sleep out", (long long)since);
+        timing_violations++;
+    }
+    if (cmd == 0x10 || cmd == 0x11) {
+        panel.sleep_cmd_us = esp_timer_get_time();
+        panel.sleep_cmd_out = (cmd == 0x11);
+    }
+}
+
+static void panel_command(uint8_t cmd) {
+    panel.cmd = cmd;
+    panel.param_count = 0;
+    panel.pixel_fill = 0;
+    panel_check_sleep_timing(cmd);
+
+    switch (cmd) {
+    case 0x01: // Software reset
+        panel_reset();
+        break;
+    case 0x10: // Sleep in
+        panel.sleeping = true;
+        break;
+    case 0x11: // Sleep out
+        panel.sleeping = false;
+        break;
+    case 0x12: // Partial mode on
+        panel.partial = true;
+        break;
+    case 0x13: // Normal display mode on
+        panel.partial = false;
+        break;
+    case 0x20: // Inversion off
+        panel.inverted = false;
+        break;
+    case 0x21: // Inversion on
+        panel.inverted = true;
+        break;
+    case 0x28: // Display off
+        panel.display_on = false;
+        break;
+    case 0x29: // Display on
+        panel.display_on = true;
+        break;
+    case 0x2C: // Memory write restarts at the window origin
+        panel.cur_col = panel.col_start;
+        panel.cur_page = panel.page_start;
+        break;
+    case 0x38: // Idle off
+        panel.idle = false;
+        break;
+    case 0x39: // Idle on
+        panel.idle = true;
+        break;
+    default:
+        break;
+    }
+}
+
+// A command's parameter block is complete
+static void panel_apply_params(void) {
+    const uint8_t *p = panel.params;
+
+    switch (panel.cmd) {
+    case 0x2A: // Column address set
+        if (panel.param_count == 4) {
+            panel.col_start = (p[0] << 8) | p[1];
+            panel.col_end = (p[2] << 8) | p[3];
+        }
+        break;
+    case 0x2B: // Page address set
+        if (panel.param_count == 4) {
+            panel.page_start = (p[0] << 8) | p[1];
+            panel.page_end = (p[2] << 8) | p[3];
+        }
+        break;
+    case 0x30: // Partial area
+        if (panel.param_count == 4) {
+            panel.ptl_start = (p[0] << 8) | p[1];
+            panel.ptl_end = (p[2] << 8) | p[3];
+        }
+        break;
+    case 0x33: // Vertical scrolling definition
+        if (panel.param_count == 6) {
+            panel.tfa = (p[0] << 8) | p[1];
+            panel.vsa = (p[2] << 8) | p[3];
+            panel.bfa = (p[4] << 8) | p[5];
+        }
+        break;
+    case 0x36: // Memory access control
+        if (panel.param_count == 1) {
+            panel.madctl = p[0];
+        }
+        break;
+    case 0x37: // Vertical scrolling start address
+        if (panel.param_count == 2) {
+            panel.vsp = (p[0] << 8) | p[1];
+        }
+        break;
+    case 0x3A: // Pixel format
+        if (panel.param_count == 1) {
+            panel.colmod = p[0];
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+static void panel_data(const uint8_t *data, size_t len) {
+    if (panel.cmd == 0x2C || panel.cmd == 0x3C) {
+        // Memory write: RGB565 MSB first, or RGB666 as one byte per channel
+        // (kept as RGB565 in GRAM)
+        int size = (panel.colmod == 0x55) ? 2 : 3;
+        for (size_t i = 0; i < len; i++) {
+            panel.pixel_bytes[panel.pixel_fill++] = data[i];
+            if (panel.pixel_fill < size) {
+                continue;
+            }
+            const uint8_t *b = panel.pixel_bytes;
+            if (size == 2) {
+                panel_write_pixel((b[0] << 8) | b[1]);
+            } else {
+                panel_write_pixel(((b[0] & 0xF8) << 8) | ((b[1] & 0xFC) << 3) | (b[2] >> 3));
+            }
+            panel.pixel_fill = 0;
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < len && panel.param_count < MAX_PARAMS; i++) {
+        panel.params[panel.param_count++] = data[i];
+        panel_apply_params();
+    }
+}
+
+static void panel_transfer(bool dc, const void *data, size_t len) {
+    if (panel.dc != (int)dc) {
+        panel.dc = dc;
+        gpio_toggles++;
+    }
+    transaction_count++;
+    byte_count += len;
+    wire_ns += len * 8 * 1000000000ULL / clock_hz;
+
+    // Hold the caller until the bytes would be off a rate-capped wire
+    if (bus_limit_hz > 0) {
+        int hz = (clock_hz < bus_limit_hz) ? clock_hz : bus_limit_hz;
+        int64_t now = esp_timer_get_time();
+        bus_free_us = ((bus_free_us > now) ? bus_free_us : now) + len * 8 * 1000000LL / hz;
+        while (esp_timer_get_time() < bus_free_us) {
+        }
+    }
+
+    if (dc == ILI9341_DC_CMD) {
+        const uint8_t *bytes = data;
+        for (size_t i = 0; i < len; i++) {
+            panel_command(bytes[i]);
+        }
+    } else {
+        panel_data(data, len);
+    }
+}
+
+// ==== Transport Interface ====
+esp_err_t ili9341_transport_init(const ili9341_config_t *config) {
+    display_config = config;
+    clock_hz = ili9341_config_clock_hz(config);
+    max_transfer = ili9341_config_max_transfer(config);
+    queue_depth = ili9341_config_queue_depth(config);
+    memset(gram, 0, sizeof(gram));
+    panel_reset();
+    panel.dc = 0;
+    panel.outstanding = 0;
+    panel.sleep_cmd_us = 0;
+    timing_violations = 0;
+    backlight = (config->pin_bckl >= 0) ? 100 : 0;
+    ESP_LOGI(TAG, "Virtual %s %dx%d panel ready (%d kHz, %d-byte transfers, queue depth %d)",
+             ILI9341_PANEL_NAME, GRAM_COLS, GRAM_ROWS, clock_hz / 1000, (int)max_transfer, queue_depth);
+    return ESP_OK;
+}
+
+void ili9341_transport_deinit(void) {
+    display_config = NULL;
+}
+
+// Any clock is accepted; only the rate cap decides how fast bytes move
+esp_err_t ili9341_transport_set_clock(int hz, int *actual_hz) {
+    if (display_config == NULL || hz <= 0 || panel.outstanding > 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    clock_hz = hz;
+    if (actual_hz != NULL) {
+        *actual_hz = clock_hz;
+    }
+    return ESP_OK;
+}
+
+int ili9341_transport_get_clock(void) {
+    return display_config ? clock_hz : 0;
+}
+
+void ili9341_transport_select(void) {
+    if (!display_config->hw_cs) {
+        gpio_toggles++;
+    }
+}
+
+void ili9341_transport_deselect(void) {
+    if (!display_config->hw_cs) {
+        gpio_toggles++;
+    }
+}
+
+esp_err_t ili9341_transport_write(bool dc, const void *data, size_t len) {
+    const uint8_t *p = data;
+    do {
+        size_t n = (len > max_transfer) ? max_transfer : len;
+        panel_transfer(dc, p, n);
+        p += n;
+        len -= n;
+    } while (len > 0);
+    return ESP_OK;
+}
+
+esp_err_t ili9341_transport_write_cmd(uint8_t cmd, const uint8_t *params, size_t len) {
+    panel_transfer(ILI9341_DC_CMD, &cmd, 1);
+    if (len > 0) {
+        panel_transfer(ILI9341_DC_DATA, params, len);
+    }
+    return ESP_OK;
+}
+
+// Transfers complete immediately; only the queue bookkeeping is modelled
+esp_err_t ili9341_transport_queue(const void *data, size_t len) {
+    if (panel.outstanding >= queue_depth) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (len > max_transfer) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    panel_transfer(ILI9341_DC_DATA, data, len);
+    panel.outstanding++;
+    return ESP_OK;
+}
+
+esp_err_t ili9341_transport_wait(void) {
+    if (panel.outstanding == 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    panel.outstanding--;
+    return ESP_OK;
+}
+
+void ili9341_transport_set_reset(int level) {
+    static int rst_level = 1;
+
+    if (level != rst_level) {
+        gpio_toggles++;
+        // Rising edge ends a hardware reset
+        if (level && !rst_level) {
+            panel_reset();
+        }
+        rst_level = level;
+    }
+}
+
+void ili9341_transport_set_backlight(uint8_t percent) {
+    if (display_config == NULL || display_config->pin_bckl < 0) {
+        return;
+    }
+    if (percent > 100) {
+        percent = 100;
+    }
+
+#ifndef CONFIG_ILI9341_BCKL_PWM
+    // A plain GPIO only has on and off
+    percent = percent ? 100 : 0;
+    if (percent != backlight) {
+        gpio_toggles++;
+    }
+#endif
+    backlight = percent;
+}
+
+void ili9341_transport_get_stats(ili9341_bus_stats_t *stats) {
+    stats->transactions = transaction_count;
+    stats->bytes = byte_count;
+    stats->gpio_toggles = gpio_toggles;
+    stats->wire_time_us = wire_ns / 1000;
+}
+
+void ili9341_transport_reset_stats(void) {
+    transaction_count = 0;
+    byte_count = 0;
+    wire_ns = 0;
+    gpio_toggles = 0;
+}
+
+// ==== Virtual Panel Inspection ====
+void ili9341_virtual_set_bus_limit(int max_hz) {
+    bus_limit_hz = (max_hz > 0) ? max_hz : 0;
+    bus_free_us = 0;
+}
+
+uint8_t ili9341_virtual_get_backlight(void) {
+    return backlight;
+}
+
+uint32_t ili9341_virtual_get_timing_violations(void) {
+    return timing_violations;
+}
+
+void ili9341_virtual_get_size(uint16_t *width, uint16_t *height) {
+    bool landscape = panel.madctl & MADCTL_MV;
+    *width = landscape ? GRAM_ROWS : GRAM_COLS;
+    *height = landscape ? GRAM_COLS : GRAM_ROWS;
+}
+
+uint16_t ili9341_virtual_get_pixel(uint16_t x, uint16_t y) {
+    int row, col;
+
+    if (!panel.display_on || panel.sleeping || !panel_map(x, y, &row, &col)) {
+        return 0x0000;
+    }
+
+    // Partial mode only scans the lines of the partial area
+    if (panel.partial && (row < panel.ptl_start || row > panel.ptl_end)) {
+        return 0x0000;
+    }
+
+    // Rows inside the scroll area show GRAM shifted by the start address
+    if (row >= panel.tfa && row < panel.tfa + panel.vsa && panel.vsa > 0) {
+        int offset = (panel.vsp >= panel.tfa) ? panel.vsp - panel.tfa : 0;
+        row = panel.tfa + (row - panel.tfa + offset) % panel.vsa;
+    }
+
+    // Inverted glass shows true colours only with inversion on
+    uint16_t value = gram[row][col];
+    if (panel.inverted != ILI9341_PANEL_INVERTED) {
+        value = ~value;
+    }
+    if (panel.idle) {
+        // 8-colour mode: only the MSB of each channel survives
+        value = ((value & 0x8000) ? 0xF800 : 0) |
+                ((value & 0x0400) ? 0x07E0 : 0) |
+                ((value & 0x0010) ? 0x001F : 0);
+    }
+    return value;
+}
+
+esp_err_t ili9341_virtual_dump_ppm(const char *path) {
+    uint16_t width, height;
+    ili9341_virtual_get_size(&width, &height);
+
+    FILE *f = fopen(path, "wb");
+    if (f == NULL) {
+        ESP_LOGE(TAG, "Can't open %s", path);
+        return ESP_FAIL;
+    }
+
+    fprintf(f, "P6\n%d %d\n255\n", width, height);
+    for (uint16_t y = 0; y < height; y++) {
+        for (uint16_t x = 0; x < width; x++) {
+            uint16_t v = ili9341_virtual_get_pixel(x, y);
+            uint8_t rgb[3] = {
+                (uint8_t)(((v >> 11) & 0x1F) * 255 / 31),
+                (uint8_t)(((v >> 5) & 0x3F) * 255 / 63),
+                (uint8_t)((v & 0x1F) * 255 / 31),
+            };
+            fwrite(rgb, 1, sizeof(rgb), f);
+        }
+    }
+
+    bool ok = (fclose(f) == 0);
+    return ok ? ESP_OK : ESP_FAIL;
+}
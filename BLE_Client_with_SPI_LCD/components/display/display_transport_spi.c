@@ -0,0 +1,395 @@
+#include "display_transport.h"
+#include "sdkconfig.h"
+#include "driver/spi_master.h"
+#include "driver/gpio.h"
+#include "driver/ledc.h"
+#include "esp_log.h"
+#include "esp_attr.h"
+#include <string.h>
+
+static const char *TAG = "ILI9341_SPI";
+
+// ==== Private Variables ====
+static spi_device_handle_t spi_device = NULL;
+static const ili9341_config_t *display_config = NULL;
+static int clock_hz = 0;
+static size_t max_transfer = 0;
+static int queue_depth = 0;
+
+// DC level for each transaction travels in spi_transaction_t.user and is
+// applied by the pre-transfer callback, which may run from the SPI ISR.
+#define DC_CMD  ((void *)0)
+#define DC_DATA ((void *)1)
+static DRAM_ATTR int dc_pin = -1;
+static DRAM_ATTR int dc_level = -1;
+
+// Pre-built descriptors for short command writes: the command byte and up
+// to four parameter bytes, both sent inline through tx_data
+static spi_transaction_t cmd_trans;
+static spi_transaction_t param_trans;
+
+// Descriptors for queued data phases, used round-robin
+static spi_transaction_t queue_trans[ILI9341_MAX_QUEUE_DEPTH];
+static int queue_head = 0;
+
+// Bus counters
+static uint32_t transaction_count = 0;
+static uint64_t byte_count = 0;
+static uint64_t wire_ns = 0;
+static volatile uint32_t gpio_toggles = 0;
+
+// Backlight PWM: 10-bit duty, where 1 << 10 is fully on
+#define BCKL_DUTY_BITS LEDC_TIMER_10_BIT
+#define BCKL_DUTY_FULL (1 << 10)
+
+static inline void count_transfer(size_t len) {
+    transaction_count++;
+    byte_count += len;
+    wire_ns += len * 8 * 1000000000ULL / clock_hz;
+}
+
+static void IRAM_ATTR ili9341_spi_pre_cb(spi_transaction_t *t) {
+    int level = (int)(intptr_t)t->user;
+    if (level != dc_level) {
+        gpio_set_level(dc_pin, level);
+        dc_level = level;
+        gpio_toggles++;
+    }
+}
+
+static esp_err_t ili9341_gpio_init(void) {
+    gpio_config_t io_conf = {
+        .pin_bit_mask = (1ULL << display_config->pin_dc) |
+                       (1ULL << display_config->pin_rst),
+        .mode = GPIO_MODE_OUTPUT,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_DISABLE,
+    };
+
+    // CS is a plain GPIO only when it is toggled by hand
+    if (!display_config->hw_cs) {
+        io_conf.pin_bit_mask |= (1ULL << display_config->pin_cs);
+    }
+
+#ifndef CONFIG_ILI9341_BCKL_PWM
+    // Add backlight pin if configured (with PWM, LEDC takes the pin)
+    if (display_config->pin_bckl >= 0) {
+        io_conf.pin_bit_mask |= (1ULL << display_config->pin_bckl);
+    }
+#endif
+
+    esp_err_t ret = gpio_config(&io_conf);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "GPIO config failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    // Set initial pin states
+    if (!display_config->hw_cs) {
+        gpio_set_level(display_config->pin_cs, 1);
+    }
+    gpio_set_level(display_config->pin_dc, 0);
+    dc_level = 0;
+    gpio_set_level(display_config->pin_rst, 1);
+
+#ifndef CONFIG_ILI9341_BCKL_PWM
+    if (display_config->pin_bckl >= 0) {
+        gpio_set_level(display_config->pin_bckl, 1);
+    }
+#endif
+
+    return ESP_OK;
+}
+
+#ifdef CONFIG_ILI9341_BCKL_PWM
+// Backlight on an LEDC channel, starting fully on like the GPIO version
+static esp_err_t ili9341_bckl_pwm_init(void) {
+    if (display_config->pin_bckl < 0) {
+        return ESP_OK;
+    }
+
+    ledc_timer_config_t timer = {
+        .speed_mode = LEDC_LOW_SPEED_MODE,
+        .duty_resolution = BCKL_DUTY_BITS,
+        .timer_num = CONFIG_ILI9341_BCKL_LEDC_TIMER,
+        .freq_hz = CONFIG_ILI9341_BCKL_PWM_FREQ_HZ,
+        .clk_cfg = LEDC_AUTO_CLK,
+    };
+    esp_err_t ret = ledc_timer_config(&timer);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Backlight timer config failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    ledc_channel_config_t channel = {
+        .gpio_num = display_config->pin_bckl,
+        .speed_mode = LEDC_LOW_SPEED_MODE,
+        .channel = CONFIG_ILI9341_BCKL_LEDC_CHANNEL,
+        .timer_sel = CONFIG_ILI9341_BCKL_LEDC_TIMER,
+        .duty = BCKL_DUTY_FULL,
+        .hpoint = 0,
+    };
+    ret = ledc_channel_config(&channel);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Backlight channel config failed: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
+#endif
+
+static esp_err_t ili9341_spi_add_device(int hz) {
+    spi_device_interface_config_t devcfg = {
+        .clock_speed_hz = hz,
+        .mode = 0,
+        .spics_io_num = display_config->hw_cs ? display_config->pin_cs : -1,
+        .queue_size = queue_depth,
+        .pre_cb = ili9341_spi_pre_cb, // Drives DC from transaction user field
+        .post_cb = NULL
+    };
+
+    esp_err_t ret = spi_bus_add_device(display_config->spi_host, &devcfg, &spi_device);
+    if (ret != ESP_OK) {
+        spi_device = NULL;
+        return ret;
+    }
+
+    // The peripheral divides its source clock, so report what it really got
+    int khz = 0;
+    clock_hz = (spi_device_get_actual_freq(spi_device, &khz) == ESP_OK && khz > 0) ? khz * 1000 : hz;
+    return ESP_OK;
+}
+
+esp_err_t ili9341_transport_init(const ili9341_config_t *config) {
+    display_config = config;
+    dc_pin = config->pin_dc;
+    max_transfer = ili9341_config_max_transfer(config);
+    queue_depth = ili9341_config_queue_depth(config);
+
+    esp_err_t ret = ili9341_gpio_init();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+#ifdef CONFIG_ILI9341_BCKL_PWM
+    ret = ili9341_bckl_pwm_init();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+#endif
+
+    // Initialize SPI
+    spi_bus_config_t buscfg = {
+        .miso_io_num = display_config->pin_miso,
+        .mosi_io_num = display_config->pin_mosi,
+        .sclk_io_num = display_config->pin_clk,
+        .quadwp_io_num = -1,
+        .quadhd_io_num = -1,
+        .max_transfer_sz = max_transfer
+    };
+
+    // Initialize SPI bus
+    ret = spi_bus_initialize(display_config->spi_host, &buscfg, SPI_DMA_CH_AUTO);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "SPI bus init failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    // Add SPI device
+    ret = ili9341_spi_add_device(ili9341_config_clock_hz(display_config));
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "SPI device add failed: %s", esp_err_to_name(ret));
+        spi_bus_free(display_config->spi_host);
+        return ret;
+    }
+    ESP_LOGI(TAG, "SPI at %d kHz, %d-byte transfers, queue depth %d",
+             clock_hz / 1000, (int)max_transfer, queue_depth);
+
+    cmd_trans = (spi_transaction_t) {
+        .flags = SPI_TRANS_USE_TXDATA,
+        .length = 8,
+        .user = DC_CMD,
+    };
+    param_trans = (spi_transaction_t) {
+        .flags = SPI_TRANS_USE_TXDATA,
+        .user = DC_DATA,
+    };
+    queue_head = 0;
+
+    return ESP_OK;
+}
+
+esp_err_t ili9341_transport_set_clock(int hz, int *actual_hz) {
+    if (spi_device == NULL || hz <= 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    int old_hz = clock_hz;
+    spi_bus_remove_device(spi_device);
+    spi_device = NULL;
+
+    esp_err_t ret = ili9341_spi_add_device(hz);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "%d kHz rejected: %s", hz / 1000, esp_err_to_name(ret));
+        if (ili9341_spi_add_device(old_hz) != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to restore %d kHz", old_hz / 1000);
+        }
+    }
+    if (actual_hz != NULL) {
+        *actual_hz = clock_hz;
+    }
+    return ret;
+}
+
+int ili9341_transport_get_clock(void) {
+    return spi_device ? clock_hz : 0;
+}
+
+void ili9341_transport_deinit(void) {
+    // Remove SPI device if it was added
+    if (spi_device) {
+        spi_bus_remove_device(spi_device);
+        spi_device = NULL;
+    }
+
+    // Free SPI bus if it was initialized
+    if (display_config) {
+        spi_bus_free(display_config->spi_host);
+    }
+    display_config = NULL;
+}
+
+// With hardware CS the SPI peripheral frames every transaction itself
+void ili9341_transport_select(void) {
+    if (!display_config->hw_cs) {
+        gpio_set_level(display_config->pin_cs, 0);
+        gpio_toggles++;
+    }
+}
+
+void ili9341_transport_deselect(void) {
+    if (!display_config->hw_cs) {
+        gpio_set_level(display_config->pin_cs, 1);
+        gpio_toggles++;
+    }
+}
+
+// All blocking transfers go through here so they are counted in one place.
+// They are polled: the caller waits for them anyway, and polling skips the
+// interrupt and semaphore round trip of spi_device_transmit().
+static esp_err_t ili9341_spi_transmit(spi_transaction_t *t) {
+    if (spi_device == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    count_transfer(t->length / 8);
+    return spi_device_polling_transmit(spi_device, t);
+}
+
+esp_err_t ili9341_transport_write(bool dc, const void *data, size_t len) {
+    // Up to 4 bytes go inline instead of through DMA
+    if (len <= 4) {
+        spi_transaction_t t = {
+            .flags = SPI_TRANS_USE_TXDATA,
+            .length = len * 8,
+            .user = dc ? DC_DATA : DC_CMD,
+        };
+        memcpy(t.tx_data, data, len);
+        return ili9341_spi_transmit(&t);
+    }
+
+    // The bus was sized for max_transfer: anything longer goes in pieces
+    const uint8_t *p = data;
+    esp_err_t ret = ESP_OK;
+    while (len > 0 && ret == ESP_OK) {
+        size_t n = (len > max_transfer) ? max_transfer : len;
+        spi_transaction_t t = {
+            .length = n * 8,
+            .user = dc ? DC_DATA : DC_CMD,
+            .tx_buffer = p
+        };
+        ret = ili9341_spi_transmit(&t);
+        p += n;
+        len -= n;
+    }
+    return ret;
+}
+
+esp_err_t ili9341_transport_write_cmd(uint8_t cmd, const uint8_t *params, size_t len) {
+    cmd_trans.tx_data[0] = cmd;
+    esp_err_t ret = ili9341_spi_transmit(&cmd_trans);
+    if (ret != ESP_OK || len == 0) {
+        return ret;
+    }
+
+    if (len > 4) {
+        return ili9341_transport_write(ILI9341_DC_DATA, params, len);
+    }
+    param_trans.length = len * 8;
+    memcpy(param_trans.tx_data, params, len);
+    return ili9341_spi_transmit(&param_trans);
+}
+
+esp_err_t ili9341_transport_queue(const void *data, size_t len) {
+    if (spi_device == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (len > max_transfer) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    spi_transaction_t *t = &queue_trans[queue_head];
+    *t = (spi_transaction_t) {
+        .length = len * 8,
+        .user = DC_DATA,
+        .tx_buffer = data
+    };
+
+    esp_err_t ret = spi_device_queue_trans(spi_device, t, portMAX_DELAY);
+    if (ret == ESP_OK) {
+        queue_head = (queue_head + 1) % queue_depth;
+        count_transfer(len);
+    }
+    return ret;
+}
+
+esp_err_t ili9341_transport_wait(void) {
+    spi_transaction_t *done;
+    return spi_device_get_trans_result(spi_device, &done, portMAX_DELAY);
+}
+
+void ili9341_transport_set_reset(int level) {
+    gpio_set_level(display_config->pin_rst, level);
+    gpio_toggles++;
+}
+
+void ili9341_transport_set_backlight(uint8_t percent) {
+    if (display_config == NULL || display_config->pin_bckl < 0) {
+        return;
+    }
+    if (percent > 100) {
+        percent = 100;
+    }
+
+#ifdef CONFIG_ILI9341_BCKL_PWM
+    ledc_set_duty(LEDC_LOW_SPEED_MODE, CONFIG_ILI9341_BCKL_LEDC_CHANNEL,
+                  BCKL_DUTY_FULL * percent / 100);
+    ledc_update_duty(LEDC_LOW_SPEED_MODE, CONFIG_ILI9341_BCKL_LEDC_CHANNEL);
+#else
+    gpio_set_level(display_config->pin_bckl, percent > 0);
+    gpio_toggles++;
+#endif
+}
+
+void ili9341_transport_get_stats(ili9341_bus_stats_t *stats) {
+    stats->transactions = transaction_count;
+    stats->bytes = byte_count;
+    stats->gpio_toggles = gpio_toggles;
+    stats->wire_time_us = wire_ns / 1000;
+}
+
+void ili9341_transport_reset_stats(void) {
+    transaction_count = 0;
+    byte_count = 0;
+    wire_ns = 0;
+    gpio_toggles = 0;
+}
@@ -0,0 +1,86 @@
+#ifndef DISPLAY_VIRTUAL_H
+#define DISPLAY_VIRTUAL_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ==== Virtual Panel (Linux target only) ====
+//
+// On the Linux target the display component talks to an in-memory model
+// of the configured panel controller instead of the SPI bus. The model
+// decodes the command stream (CASET/PASET/RAMWR, MADCTL, COLMOD,
+// scrolling, partial and idle modes, sleep/display on/off, ...) into a
+// GRAM of the panel's size, so rendering can be inspected and compared
+// off hardware. Bus counters and the wire-time estimate are available
+// from ili9341_get_bus_stats() as on the target.
+
+/**
+ * @brief Cap the rate of the modelled bus
+ *
+ * Normally transfers complete as soon as the model has decoded them. With
+ * a cap, each one holds the caller for its wire time at the lower of the
+ * SPI clock and max_hz, like a board whose wiring or pin routing can't
+ * follow a faster clock. This is what clock calibration (spi_clock_max_hz)
+ * measures against; set it before ili9341_init() and clear it afterwards
+ * to keep later drawing fast.
+ *
+ * @param max_hz Highest effective clock, 0 to remove the cap
+ */
+void ili9341_virtual_set_bus_limit(int max_hz);
+
+/**
+ * @brief Get the backlight level last set
+ * @return 0 (off) to 100 (fully on); 0 without pin_bckl
+ */
+uint8_t ili9341_virtual_get_backlight(void);
+
+/**
+ * @brief Count commands that broke the sleep-in/out timing rules
+ *
+ * The datasheet requires 5 ms after SLPIN or SLPOUT before the next
+ * command and 120 ms after SLPOUT before SLPIN. The model logs and counts
+ * every command sent sooner.
+ *
+ * @return Violations since ili9341_init()
+ */
+uint32_t ili9341_virtual_get_timing_violations(void);
+
+/**
+ * @brief Get the size of the image as currently displayed
+ *
+ * Depends on MADCTL: the panel's long side is the width in landscape
+ * (row/column exchange set), the height in portrait.
+ *
+ * @param width Receives the width in pixels
+ * @param height Receives the height in pixels
+ */
+void ili9341_virtual_get_size(uint16_t *width, uint16_t *height);
+
+/**
+ * @brief Read a pixel as the viewer would see it
+ *
+ * Applies MADCTL orientation, vertical scrolling, partial and idle modes
+ * and display on/off. The backlight is not applied.
+ *
+ * @param x X coordinate in the current orientation
+ * @param y Y coordinate in the current orientation
+ * @return RGB565 value (0 outside the panel or while the display is off)
+ */
+uint16_t ili9341_virtual_get_pixel(uint16_t x, uint16_t y);
+
+/**
+ * @brief Write the displayed image to a binary PPM (P6) file
+ * @param path Output file path
+ * @return ESP_OK on success, ESP_FAIL if the file can't be written
+ */
+esp_err_t ili9341_virtual_dump_ppm(const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DISPLAY_VIRTUAL_H
@@ -0,0 +1,172 @@
+#include "display_widget.h"
+#include "display.h"
+#include "display_priv.h"
+#include <stdio.h>
+#include <string.h>
+
+// ==== Label ====
+void ili9341_label_init(ili9341_label_t *label, uint16_t x, uint16_t y, uint8_t cells,
+                        uint16_t fg, uint16_t bg, uint8_t scale) {
+    if (label == NULL) {
+        return;
+    }
+    if (cells > ILI9341_WIDGET_TEXT_MAX) {
+        cells = ILI9341_WIDGET_TEXT_MAX;
+    }
+
+    memset(label, 0, sizeof(*label));
+    label->x = x;
+    label->y = y;
+    label->fg = fg;
+    label->bg = bg;
+    label->scale = scale ? scale : 1;
+    label->cells = cells;
+}
+
+void ili9341_label_set(ili9341_label_t *label, const char *str) {
+    if (label == NULL || str == NULL) {
+        return;
+    }
+
+    // New content, padded to the label width
+    char next[ILI9341_WIDGET_TEXT_MAX + 1];
+    size_t len = strnlen(str, label->cells);
+    memcpy(next, str, len);
+    memset(next + len, ' ', label->cells - len);
+    next[label->cells] = '\0';
+
+    const uint16_t cell_w = (ILI9341_FONT_WIDTH + ILI9341_FONT_SPACING) * label->scale;
+
+    // Redraw each run of changed cells as one opaque burst
+    int i = 0;
+    while (i < label->cells) {
+        if (label->drawn && next[i] == label->shown[i]) {
+            i++;
+            continue;
+        }
+
+        int start = i;
+        while (i < label->cells && !(label->drawn && next[i] == label->shown[i])) {
+            i++;
+        }
+
+        char run[ILI9341_WIDGET_TEXT_MAX + 1];
+        memcpy(run, &next[start], i - start);
+        run[i - start] = '\0';
+        ili9341_text_bg(run, label->x + start * cell_w, label->y, label->fg, label->bg, label->scale);
+    }
+
+    memcpy(label->shown, next, sizeof(next));
+    label->drawn = true;
+}
+
+void ili9341_label_set_color(ili9341_label_t *label, uint16_t fg, uint16_t bg) {
+    if (label == NULL) {
+        return;
+    }
+    if (label->fg != fg || label->bg != bg) {
+        label->fg = fg;
+        label->bg = bg;
+        label->drawn = false;
+    }
+}
+
+void ili9341_label_invalidate(ili9341_label_t *label) {
+    if (label != NULL) {
+        label->drawn = false;
+    }
+}
+
+// ==== Numeric Value ====
+void ili9341_value_init(ili9341_value_t *value, uint16_t x, uint16_t y, uint8_t digits,
+                        uint16_t fg, uint16_t bg, uint8_t scale) {
+    if (value == NULL) {
+        return;
+    }
+    ili9341_label_init(&value->label, x, y, digits, fg, bg, scale);
+    value->value = 0;
+}
+
+void ili9341_value_set(ili9341_value_t *value, int32_t v) {
+    if (value == NULL) {
+        return;
+    }
+    if (value->label.drawn && value->value == v) {
+        return;
+    }
+
+    char text[ILI9341_WIDGET_TEXT_MAX + 1];
+    const int cells = value->label.cells;
+    int n = snprintf(text, sizeof(text), "%*ld", cells, (long)v);
+    if (n > cells) {
+        memset(text, '#', cells);
+        text[cells] = '\0';
+    }
+
+    ili9341_label_set(&value->label, text);
+    value->value = v;
+}
+
+// ==== Bar ====
+void ili9341_bar_init(ili9341_bar_t *bar, uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                      int32_t min, int32_t max, uint16_t fg, uint16_t bg) {
+    if (bar == NULL) {
+        return;
+    }
+
+    // An empty range becomes one unit wide, ending at min if there is no
+    // room above it
+    if (max <= min) {
+        if (min == INT32_MAX) {
+            min = INT32_MAX - 1;
+        }
+        max = min + 1;
+    }
+
+    memset(bar, 0, sizeof(*bar));
+    bar->x = x;
+    bar->y = y;
+    bar->w = w;
+    bar->h = h;
+    bar->min = min;
+    bar->max = max;
+    bar->fg = fg;
+    bar->bg = bg;
+}
+
+void ili9341_bar_set(ili9341_bar_t *bar, int32_t v) {
+    if (bar == NULL || bar->w == 0 || bar->h == 0) {
+        return;
+    }
+
+    if (v < bar->min) {
+        v = bar->min;
+    }
+    if (v > bar->max) {
+        v = bar->max;
+    }
+    uint16_t filled = (uint16_t)(((int64_t)v - bar->min) * bar->w /
+                                 ((int64_t)bar->max - bar->min));
+
+    if (!bar->drawn) {
+        if (filled > 0) {
+            ili9341_fill_rect(bar->x, bar->y, filled, bar->h, bar->fg);
+        }
+        if (filled < bar->w) {
+            ili9341_fill_rect(bar->x + filled, bar->y, bar->w - filled, bar->h, bar->bg);
+        }
+        bar->drawn = true;
+    } else if (filled > bar->filled) {
+        ili9341_fill_rect(bar->x + bar->filled, bar->y, filled - bar->filled, bar->h, bar->fg);
+    } else if (filled < bar->filled) {
+        ili9341_fill_rect(bar->x + filled, bar->y, bar->filled - filled, bar->h, bar->bg);
+    }
+
+    bar->filled = filled;
+}
+
+void ili9341_bar_invalidate(ili9341_bar_t *bar) {
+    if (bar != NULL) {
+        bar->drawn = false;
+    }
+}
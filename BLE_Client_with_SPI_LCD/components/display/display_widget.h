@@ -0,0 +1,142 @@
+#ifndef DISPLAY_WIDGET_H
+#define DISPLAY_WIDGET_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ==== Retained-Mode Widgets ====
+//
+// Each widget remembers what it last put on the panel. An update compares
+// the new content with that and sends only what changed: labels and values
+// redraw the runs of character cells that differ, bars fill only the
+// strip between the old and new level. Widgets draw straight to the panel
+// with the calls in display.h, so they must be updated from the task that
+// owns the display. Widget structs are owned by the caller.
+
+// Longest label, in character cells
+#define ILI9341_WIDGET_TEXT_MAX 40
+
+typedef struct {
+    uint16_t x;
+    uint16_t y;
+    uint16_t fg;
+    uint16_t bg;
+    uint8_t scale;
+    uint8_t cells;                             // Width in character cells
+    bool drawn;                                // shown[] matches the panel
+    char shown[ILI9341_WIDGET_TEXT_MAX + 1];
+} ili9341_label_t;
+
+typedef struct {
+    ili9341_label_t label;
+    int32_t value;
+} ili9341_value_t;
+
+typedef struct {
+    uint16_t x;
+    uint16_t y;
+    uint16_t w;
+    uint16_t h;
+    uint16_t fg;                               // Filled part
+    uint16_t bg;                               // Empty part
+    int32_t min;
+    int32_t max;
+    bool drawn;
+    uint16_t filled;                           // Filled width on the panel
+} ili9341_bar_t;
+
+/**
+ * @brief Set up a label; nothing is drawn until the first set
+ * @param label Label to initialize
+ * @param x X coordinate
+ * @param y Y coordinate
+ * @param cells Width in character cells (at most ILI9341_WIDGET_TEXT_MAX)
+ * @param fg 16-bit RGB565 text color
+ * @param bg 16-bit RGB565 background color
+ * @param scale Size multiplier
+ */
+void ili9341_label_init(ili9341_label_t *label, uint16_t x, uint16_t y, uint8_t cells,
+                        uint16_t fg, uint16_t bg, uint8_t scale);
+
+/**
+ * @brief Show a string, redrawing only the cells that changed
+ *
+ * The string is padded with spaces (or truncated) to the label width, so
+ * a shorter string erases the tail of a longer one.
+ *
+ * @param label Label to update
+ * @param str New text
+ */
+void ili9341_label_set(ili9341_label_t *label, const char *str);
+
+/**
+ * @brief Change colors; the next set redraws the whole label
+ */
+void ili9341_label_set_color(ili9341_label_t *label, uint16_t fg, uint16_t bg);
+
+/**
+ * @brief Forget what is on the panel, e.g. after a full-screen fill
+ *
+ * The next set redraws the whole label.
+ */
+void ili9341_label_invalidate(ili9341_label_t *label);
+
+/**
+ * @brief Set up a right-aligned integer display
+ * @param value Widget to initialize
+ * @param x X coordinate
+ * @param y Y coordinate
+ * @param digits Width in character cells, sign included
+ * @param fg 16-bit RGB565 text color
+ * @param bg 16-bit RGB565 background color
+ * @param scale Size multiplier
+ */
+void ili9341_value_init(ili9341_value_t *value, uint16_t x, uint16_t y, uint8_t digits,
+                        uint16_t fg, uint16_t bg, uint8_t scale);
+
+/**
+ * @brief Show a number, redrawing only the digits that changed
+ *
+ * Numbers that don't fit are shown as '#' in every cell.
+ *
+ * @param value Widget to update
+ * @param v New value
+ */
+void ili9341_value_set(ili9341_value_t *value, int32_t v);
+
+/**
+ * @brief Set up a horizontal bar; nothing is drawn until the first set
+ * @param bar Bar to initialize
+ * @param x X coordinate
+ * @param y Y coordinate
+ * @param w Width in pixels
+ * @param h Height in pixels
+ * @param min Value shown as an empty bar
+ * @param max Value shown as a full bar; at most min gives a one unit range
+ * @param fg 16-bit RGB565 color of the filled part
+ * @param bg 16-bit RGB565 color of the empty part
+ */
+void ili9341_bar_init(ili9341_bar_t *bar, uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                      int32_t min, int32_t max, uint16_t fg, uint16_t bg);
+
+/**
+ * @brief Show a level, filling only the columns between old and new
+ * @param bar Bar to update
+ * @param v New value (clamped to min..max)
+ */
+void ili9341_bar_set(ili9341_bar_t *bar, int32_t v);
+
+/**
+ * @brief Forget what is on the panel; the next set redraws the whole bar
+ */
+void ili9341_bar_invalidate(ili9341_bar_t *bar);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DISPLAY_WIDGET_H
@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+"""Generate the row-major font and scale lookup tables from font5x8.h.
+
+font5x8.h stores each glyph as 5 column bytes (bit n = row n). Rendering
+works a scanline at a time, so this emits:
+
+  font5x8_rows[96][8]        one byte per row, bit c = column c
+  font_scaled_masks[S][64]   for each scale 1..S and each 6-bit column
+                             mask (5 glyph columns + the spacing column),
+                             the mask with every bit repeated 'scale'
+                             times: bit p = pixel p of the scanline
+
+Usage: gen_font_rows.py <font5x8.h> <output.h>
+"""
+
+import re
+import sys
+
+GLYPHS = 96
+ROWS = 8
+COLS = 5
+MASK_BITS = 6          # Glyph columns plus the spacing column
+LUT_SCALES = 8         # 6 * 8 = 48 pixel bits, fits in a uint64_t
+
+
+def parse_font(path):
+    with open(path) as f:
+        text = f.read()
+    body = text[text.index('font5x8[96][5]'):]
+    glyphs = re.findall(r'\{\s*(0x[0-9A-Fa-f]{2}(?:\s*,\s*0x[0-9A-Fa-f]{2}){4})\s*\}', body)
+    if len(glyphs) != GLYPHS:
+        sys.exit('%s: expected %d glyphs, found %d' % (path, GLYPHS, len(glyphs)))
+    return [[int(v, 16) for v in g.split(',')] for g in glyphs]
+
+
+def transpose(columns):
+    rows = []
+    for row in range(ROWS):
+        mask = 0
+        for col in range(COLS):
+            if columns[col] & (1 << row):
+                mask |= 1 << col
+        rows.append(mask)
+    return rows
+
+
+def scale_mask(mask, scale):
+    out = 0
+    for col in range(MASK_BITS):
+        if mask & (1 << col):
+            out |= ((1 << scale) - 1) << (col * scale)
+    return out
+
+
+def glyph_name(code):
+    ch = chr(code)
+    if code == 127:
+        return 'DEL'
+    return "'%s'" % ch
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit(__doc__)
+    font = parse_font(sys.argv[1])
+
+    out = []
+    out.append('// Generated by gen_font_rows.py from font5x8.h. Do not edit.')
+    out.append('#ifndef FONT5X8_ROWS_H')
+    out.append('#define FONT5X8_ROWS_H')
+    out.append('')
+    out.append('#include <stdint.h>')
+    out.append('')
+    out.append('#define ILI9341_FONT_LUT_SCALES %d' % LUT_SCALES)
+    out.append('')
+    out.append('// Row-major glyphs: bit c of row r set means column c is lit')
+    out.append('static const uint8_t font5x8_rows[%d][%d] = {' % (GLYPHS, ROWS))
+    for i, columns in enumerate(font):
+        rows = ', '.join('0x%02X' % r for r in transpose(columns))
+        out.append('    {%s}, // %-3d %s' % (rows, i + 32, glyph_name(i + 32)))
+    out.append('};')
+    out.append('')
+    out.append('// Column mask -> pixel mask with every column repeated scale times')
+    out.append('static const uint64_t font_scaled_masks[%d][%d] = {' % (LUT_SCALES, 1 << MASK_BITS))
+    for scale in range(1, LUT_SCALES + 1):
+        out.append('    { // Scale %d' % scale)
+        values = ['0x%012XULL' % scale_mask(m, scale) for m in range(1 << MASK_BITS)]
+        for i in range(0, len(values), 4):
+            out.append('        ' + ', '.join(values[i:i + 4]) + ',')
+        out.append('    },')
+    out.append('};')
+    out.append('')
+    out.append('#endif // FONT5X8_ROWS_H')
+
+    with open(sys.argv[2], 'w') as f:
+        f.write('\n'.join(out) + '\n')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,155 @@
+#!/usr/bin/env python3
+"""Convert XPM images into palette-indexed RLE images for ili9341_draw_image().
+
+XPM is plain text and palette based, so icons can be drawn and reviewed
+in any editor (or exported from GIMP) and kept in git. Colours must be
+'#RRGGBB'; 'None' (transparent) becomes black, as the panel has no alpha.
+
+For each input <name>.xpm this emits a const ili9341_image_t called
+image_<name> into <output.c>, declared extern in <output.h>. The stream
+format is documented next to ili9341_image_t in display.h.
+
+Usage: gen_image.py <output.c> <output.h> <image.xpm>...
+"""
+
+import os
+import re
+import sys
+
+MAX_PACKET = 128
+MIN_REPEAT = 3         # Shorter runs are cheaper inside a literal packet
+
+
+def parse_xpm(path):
+    with open(path) as f:
+        strings = re.findall(r'"((?:[^"\\]|\\.)*)"', f.read())
+    if not strings:
+        sys.exit('%s: not an XPM file' % path)
+
+    width, height, ncolors, cpp = (int(v) for v in strings[0].split()[:4])
+    if ncolors > 256:
+        sys.exit('%s: %d colours, at most 256 supported' % (path, ncolors))
+    if len(strings) < 1 + ncolors + height:
+        sys.exit('%s: truncated' % path)
+
+    keys = {}
+    palette = []
+    for line in strings[1:1 + ncolors]:
+        key = line[:cpp]
+        fields = line[cpp:].split()
+        if 'c' not in fields:
+            sys.exit('%s: colour %r has no "c" entry' % (path, key))
+        colour = fields[fields.index('c') + 1]
+        keys[key] = len(palette)
+        palette.append(rgb565(path, colour))
+
+    pixels = []
+    for row, line in enumerate(strings[1 + ncolors:1 + ncolors + height]):
+        if len(line) != width * cpp:
+            sys.exit('%s: row %d is %d characters, expected %d' % (path, row, len(line), width * cpp))
+        for i in range(0, len(line), cpp):
+            pixels.append(keys[line[i:i + cpp]])
+    return width, height, palette, pixels
+
+
+def rgb565(path, colour):
+    if colour.lower() == 'none':
+        return 0
+    m = re.fullmatch(r'#([0-9A-Fa-f]{2})([0-9A-Fa-f]{2})([0-9A-Fa-f]{2})', colour)
+    if not m:
+        sys.exit('%s: unsupported colour %r, use #RRGGBB' % (path, colour))
+    r, g, b = (int(v, 16) for v in m.groups())
+    return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3)
+
+
+def encode(pixels):
+    out = []
+    literal = []
+
+    def flush_literal():
+        while literal:
+            chunk = literal[:MAX_PACKET]
+            del literal[:MAX_PACKET]
+            out.append(len(chunk) - 1)
+            out.extend(chunk)
+
+    i = 0
+    while i < len(pixels):
+        run = 1
+        while i + run < len(pixels) and run < MAX_PACKET and pixels[i + run] == pixels[i]:
+            run += 1
+        if run >= MIN_REPEAT:
+            flush_literal()
+            out.extend((0x80 | (run - 1), pixels[i]))
+            i += run
+        else:
+            literal.extend(pixels[i:i + run])
+            i += run
+    flush_literal()
+    return out
+
+
+def swap16(v):
+    return ((v << 8) | (v >> 8)) & 0xFFFF
+
+
+def c_array(values, fmt, per_line):
+    lines = []
+    for i in range(0, len(values), per_line):
+        lines.append('    ' + ', '.join(fmt % v for v in values[i:i + per_line]) + ',')
+    return lines
+
+
+def main():
+    if len(sys.argv) < 4:
+        sys.exit(__doc__)
+    out_c, out_h, inputs = sys.argv[1], sys.argv[2], sys.argv[3:]
+    guard = re.sub(r'\W', '_', os.path.basename(out_h)).upper()
+
+    c = ['// Generated by gen_image.py. Do not edit.',
+         '#include "%s"' % os.path.basename(out_h),
+         '']
+    h = ['// Generated by gen_image.py. Do not edit.',
+         '#ifndef %s' % guard,
+         '#define %s' % guard,
+         '',
+         '#include "display.h"',
+         '']
+
+    for path in inputs:
+        name = re.sub(r'\W', '_', os.path.splitext(os.path.basename(path))[0])
+        width, height, palette, pixels = parse_xpm(path)
+        data = encode(pixels)
+
+        c.append('// %s: %dx%d, %d colours, %d bytes encoded (%d raw RGB565)'
+                 % (os.path.basename(path), width, height, len(palette),
+                    len(data) + 2 * len(palette), 2 * width * height))
+        c.append('static const uint16_t %s_palette[%d] = {' % (name, len(palette)))
+        c.extend(c_array([swap16(v) for v in palette], '0x%04X', 8))
+        c.append('};')
+        c.append('static const uint8_t %s_data[%d] = {' % (name, len(data)))
+        c.extend(c_array(data, '0x%02X', 16))
+        c.append('};')
+        c.append('const ili9341_image_t image_%s = {' % name)
+        c.append('    .width = %d,' % width)
+        c.append('    .height = %d,' % height)
+        c.append('    .palette_len = %d,' % len(palette))
+        c.append('    .palette = %s_palette,' % name)
+        c.append('    .data = %s_data,' % name)
+        c.append('    .data_len = sizeof(%s_data),' % name)
+        c.append('};')
+        c.append('')
+
+        h.append('extern const ili9341_image_t image_%s;' % name)
+
+    h.append('')
+    h.append('#endif // %s' % guard)
+
+    with open(out_c, 'w') as f:
+        f.write('\n'.join(c))
+    with open(out_h, 'w') as f:
+        f.write('\n'.join(h) + '\n')
+
+
+if __name__ == '__main__':
+    main()
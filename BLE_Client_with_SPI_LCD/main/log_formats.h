@@ -0,0 +1,64 @@
+#ifndef LOG_FORMATS_H
+#define LOG_FORMATS_H
+
+#include "binlog.h"
+
+// Binary log formats for the BLE callbacks, X(id, "format"); see binlog.h
+// for the conversions. Only string literals here: binlog_decode.py reads
+// this list to decode raw captures. Keep the four UUID formats of each
+// kind together and in this order, log_uuid() relies on it.
+#define CLIENT_LOG_FORMATS(X) \
+    X(LOG_HOST_SYNC,       "BLE: Host sync started") \
+    X(LOG_ADDR_FAIL,       "BLE: Failed to ensure address: %d") \
+    X(LOG_ADDR_COPY_FAIL,  "BLE: Failed to copy address: %d") \
+    X(LOG_OWN_ADDR,        "BLE: Scanner started, address: %02x:%02x:%02x:%02x:%02x:%02x") \
+    X(LOG_HOST_RESET,      "BLE reset: %d") \
+    X(LOG_ADV_REPORT,      "MAC: %02x:%02x:%02x:%02x:%02x:%02x  | Name: %s") \
+    X(LOG_TARGET_FOUND,    "Target device found %u ms into the scan! Attempting to connect...") \
+    X(LOG_SCAN_STARTED,    "Scanning for BLE devices...") \
+    X(LOG_SCAN_START_FAIL, "Error starting scan: %d") \
+    X(LOG_SCAN_ENDED,      "\nScan ended (reason %d), restarting") \
+    X(LOG_SCAN_POLICY,     "Scan policy: interval %u window %u (%u%% duty)") \
+    X(LOG_CONNECTING,      "Attempting to connect to %02x:%02x:%02x:%02x:%02x:%02x...") \
+    X(LOG_SCAN_STOP_FAIL,  "Error stopping scan: %d") \
+    X(LOG_CONNECT_FAIL,    "Error: Failed to connect to device: %d. Will retry...") \
+    X(LOG_CONNECT_STARTED, "Connection initiated...") \
+    X(LOG_CONNECTED,       "Connection established. Connection handle: %u") \
+    X(LOG_CONNECT_ERROR,   "Error: Connection failed, status: %d") \
+    X(LOG_DISCONNECTED,    "Disconnected. Reason: %d") \
+    X(LOG_SVC_DISC_START,  "Discovering services...") \
+    X(LOG_SVC_DISC_FAIL,   "Failed to start service discovery: %d") \
+    X(LOG_SVC_DONE,        "Service discovery complete") \
+    X(LOG_SVC_ERROR,       "Service discovery failed: %d") \
+    X(LOG_SVC_FOUND,       "\nService found: start_handle=0x%04x, end_handle=0x%04x") \
+    X(LOG_SVC_UUID16,      "  UUID: 0x%04x") \
+    X(LOG_SVC_UUID32,      "  UUID: 0x%08x") \
+    X(LOG_SVC_UUID128,     "  UUID: 0x%02x%02x...%02x%02x") \
+    X(LOG_SVC_UUID_OTHER,  "  UUID: (unknown type %d)") \
+    X(LOG_CHR_DISC_FAIL,   "Failed to discover characteristics: %d") \
+    X(LOG_CHR_DONE,        "  Characteristics discovery complete") \
+    X(LOG_CHR_ERROR,       "  Characteristic discovery failed: %d") \
+    X(LOG_CHR_FOUND,       "  Characteristic: handle=0x%04x, def_handle=0x%04x, val_handle=0x%04x, props=%s") \
+    X(LOG_CHR_UUID16,      "    UUID: 0x%04x") \
+    X(LOG_CHR_UUID32,      "    UUID: 0x%08x") \
+    X(LOG_CHR_UUID128,     "    UUID: 0x%02x%02x...%02x%02x") \
+    X(LOG_CHR_UUID_OTHER,  "    UUID: (unknown type %d)") \
+    X(LOG_CHR_TARGET,      "\n=== Found target characteristic in last service ===\nHandle: 0x%04x, Properties: %s") \
+    X(LOG_READING,         "Reading characteristic value from handle 0x%04x...") \
+    X(LOG_READ_FAIL,       "Failed to read characteristic: %d") \
+    X(LOG_SUBSCRIBING,     "Subscribing to notifications for handle 0x%04x (CCCD: 0x%04x)...") \
+    X(LOG_CCCD_FAIL,       "Failed to write to CCCD: %d") \
+    X(LOG_NOTIFY_ERROR,    "Notification error: %d") \
+    X(LOG_NOTIFY_NULL,     "Notification received: NULL attribute") \
+    X(LOG_NOTIFY_DATA,     "Notification received (handle=0x%04x): %H (%u bytes)") \
+    X(LOG_NOTIFY_EMPTY,    "Notification received (handle=0x%04x): No data") \
+    X(LOG_SENSOR_VALUE,    "First byte (decimal): %u") \
+    X(LOG_ALCOHOL,         "ALCOHOL DETECTED! (Value: %u < 40)") \
+    X(LOG_NO_ALCOHOL,      "No alcohol detected (Value: %u >= 40)")
+
+enum { CLIENT_LOG_FORMATS(BINLOG_FORMAT_ID) LOG_FORMAT_COUNT };
+
+// Arguments for a "%02x:...:%02x" address, most significant byte first
+#define LOG_ADDR_ARGS(a) (a)[5], (a)[4], (a)[3], (a)[2], (a)[1], (a)[0]
+
+#endif // LOG_FORMATS_H
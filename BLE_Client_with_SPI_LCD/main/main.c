@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <stdarg.h>
 #include <string.h>
 #include <inttypes.h>
 #include "nvs_flash.h"
@@ -6,10 +7,17 @@
 #include "nimble/nimble_port.h"
 #include "nimble/nimble_port_freertos.h"
 #include "host/ble_hs.h"
-#include "host/ble_hs_adv.h"
 #include "host/util/util.h"
 #include "services/gap/ble_svc_gap.h"
+#include "client_core.h"
+#include "scan_policy.h"
+#include "binlog.h"
+#include "log_formats.h"
 #include "display.h"
+#include "display_fb.h"
+#include "display_task.h"
+#include "display_console.h"
+#include "icons.h"              // Generated from icons/*.xpm by gen_image.py
 #include "driver/spi_master.h"
 
 // LCD Function Prototypes
@@ -20,21 +28,20 @@ void ili9341_text_medium(const char *str, uint16_t x, uint16_t y, uint16_t color
 void ili9341_text_large(const char *str, uint16_t x, uint16_t y, uint16_t color);
 void ili9341_text_xlarge(const char *str, uint16_t x, uint16_t y, uint16_t color);
 #include "driver/gpio.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
 // Forward declarations
 static void start_scan(void);
 static int gap_event_cb(struct ble_gap_event *event, void *arg);
-static void rescan_task(void *arg);
 static int discover_services(uint16_t conn_handle);
-static void print_uuid(const ble_uuid_any_t *uuid);
+static void log_uuid(uint16_t fmt, const ble_uuid_any_t *uuid);
 static const char *chr_props_to_str(uint8_t props);
 static int read_characteristic(uint16_t conn_handle, uint16_t val_handle);
 static int subscribe_to_notifications(uint16_t conn_handle, uint16_t val_handle, uint16_t ccc_handle);
 static int on_notify(uint16_t conn_handle, const struct ble_gatt_error *error,
                     struct ble_gatt_attr *attr, void *arg);
-static void periodic_read_task(void *arg);
 
 // Target device address to connect to
 static const uint8_t TARGET_ADDR[6] = {0xa6, 0x32, 0x0e, 0xe3, 0x85, 0xa0}; // a0:85:e3:0e:32:a6 in little-endian
@@ -44,6 +51,169 @@ static uint16_t conn_handle = BLE_HS_CONN_HANDLE_NONE;
 // Scan parameters
 static uint8_t own_addr_type;
 
+// The BLE callbacks below log through the binary log, so a slow console
+// never holds up the host task; see log_formats.h
+static const char *const log_formats[] = { CLIENT_LOG_FORMATS(BINLOG_FORMAT_STR) };
+
+// Scanning runs continuously. The controller's duplicate filter would
+// only forget a device when a scan starts, so it is off and client_core
+// filters in software instead, printing each advertiser once per
+// CLIENT_CORE_DUP_RESET_MS; it also spots the target and times each
+// search. Pauses before scanning again are timers, so the host task never
+// sleeps inside a GAP event.
+#define SCAN_RESTART_DELAY_MS 1000
+
+static client_core_t client;
+static struct ble_npl_callout scan_restart_timer;
+
+// Scan duty comes from the adaptive policy: full duty when a search
+// starts, backing off while the helmet stays away (never so far that it
+// takes more than a second to find) and hunting again on a surge of
+// traffic. Every search resets it; it runs every SCAN_POLICY_PERIOD_MS on
+// the reports heard since, and a change of parameters restarts the scan.
+#define SCAN_POLICY_PERIOD_MS 1000
+
+static scan_policy_t scan_policy;
+static scan_adaptive_t scan_policy_state;
+static struct ble_npl_callout scan_policy_timer;
+static scan_params_t scan_params;     // Parameters of the running scan
+static bool scan_active = false;
+static uint32_t scan_reports = 0;     // Reports since the policy last ran
+static int64_t scan_policy_us = 0;    // When it last ran
+
+// While connected the sensor is also read every PERIODIC_READ_MS, from a
+// callout on the host task like the scan timers
+#define PERIODIC_READ_MS     3000
+#define SENSOR_VALUE_HANDLE  0x0022
+
+static struct ble_npl_callout read_timer;
+
+// LCD line slots drawn by the display render task
+#define LCD_SLOT_STATUS  0
+#define LCD_SLOT_DETAIL  1
+#define LCD_VALUE_SENSOR 0
+
+// LCD image slots
+#define LCD_IMAGE_STATUS  0
+#define LCD_IMAGE_WARNING 1
+
+// Text anchor for centred lines
+#define LCD_CENTER_X     (ILI9341_WIDTH / 2)
+
+// 1 = mirror scan results, connection events and notifications on a
+// scrolling LCD console instead of showing the status screen
+#define LCD_CONSOLE      0
+
+// Power saving while searching: after LCD_IDLE_TIMEOUT_MS on the same
+// status the panel drops to 8-colour idle mode, only drives the scan
+// lines under the status text and dims the backlight. The next status
+// wakes it up.
+#define LCD_IDLE_TIMEOUT_MS (30 * 1000)
+#define LCD_IDLE_BACKLIGHT  20
+#define LCD_STATUS_Y        120
+#define LCD_STATUS_SCALE    2
+
+// The timeout is a callout on the host task's event queue, like the scan
+// timers, so it never runs while a BLE callback is changing the status.
+static struct ble_npl_callout lcd_idle_timer;
+static bool lcd_idle_timer_ready = false;   // Set once NimBLE is initialised
+static bool lcd_idle_armed = false;
+static int64_t lcd_idle_at_us = 0;
+static ili9341_rect_t lcd_status_area;
+
+static void lcd_idle_timer_cb(struct ble_npl_event *ev)
+{
+    // Stopping the callout doesn't take back an expiry already waiting in
+    // the event queue, so check this one is for the status on screen and
+    // wait out the rest of its timeout if it came early
+    if (!lcd_idle_armed) {
+        return;
+    }
+    int64_t left_us = lcd_idle_at_us - esp_timer_get_time();
+    if (left_us > 0) {
+        ble_npl_callout_reset(&lcd_idle_timer, ble_npl_time_ms_to_ticks32(left_us / 1000 + 1));
+        return;
+    }
+    lcd_idle_armed = false;
+    ili9341_task_set_power(ILI9341_POWER_IDLE | ILI9341_POWER_PARTIAL, &lcd_status_area);
+    ili9341_task_set_backlight(LCD_IDLE_BACKLIGHT);
+}
+
+// Enter power saving if the current status is still shown after the timeout
+static void lcd_power_save_arm(void)
+{
+    if (!lcd_idle_timer_ready) {
+        return;
+    }
+    lcd_idle_armed = true;
+    lcd_idle_at_us = esp_timer_get_time() + (int64_t)LCD_IDLE_TIMEOUT_MS * 1000;
+    ble_npl_callout_reset(&lcd_idle_timer, ble_npl_time_ms_to_ticks32(LCD_IDLE_TIMEOUT_MS));
+}
+
+// Replace the status line and the icon above it (this also clears any
+// warning and leaves power saving). Only posts the update, so it is safe
+// and cheap to call from BLE callbacks. icon may be NULL.
+static void lcd_show_status(const char *msg, uint16_t color, const ili9341_image_t *icon)
+{
+    lcd_idle_armed = false;
+    if (lcd_idle_timer_ready) {
+        ble_npl_callout_stop(&lcd_idle_timer);
+    }
+    ili9341_task_set_power(ILI9341_POWER_NORMAL, NULL);
+    ili9341_task_set_backlight(100);
+
+    uint16_t width = ili9341_text_measure(msg, LCD_STATUS_SCALE);
+    lcd_status_area = (ili9341_rect_t) {
+        LCD_CENTER_X - width / 2, LCD_STATUS_Y, width, 8 * LCD_STATUS_SCALE
+    };
+    ili9341_task_set_line_aligned(LCD_SLOT_STATUS, msg, LCD_CENTER_X, LCD_STATUS_Y,
+                                  ILI9341_ALIGN_CENTER, color, LCD_STATUS_SCALE);
+    if (icon != NULL) {
+        ili9341_task_set_image(LCD_IMAGE_STATUS, icon, LCD_CENTER_X - icon->width / 2, 70);
+    } else {
+        ili9341_task_clear_image(LCD_IMAGE_STATUS);
+    }
+    ili9341_task_clear_line(LCD_SLOT_DETAIL);
+    ili9341_task_clear_image(LCD_IMAGE_WARNING);
+    ili9341_task_clear_value(LCD_VALUE_SENSOR);
+}
+
+// Live sensor reading in the bottom right corner; only changed digits are sent
+static void lcd_show_sensor_value(uint8_t value)
+{
+    ili9341_task_set_value(LCD_VALUE_SENSOR, value, 260, 220, 3, ILI9341_CYAN, 2);
+}
+
+// Append a line to the LCD console (no-op unless LCD_CONSOLE is set)
+static void lcd_log(uint16_t color, const char *fmt, ...)
+{
+#if LCD_CONSOLE
+    char line[ILI9341_TASK_TEXT_MAX + 1];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(line, sizeof(line), fmt, args);
+    va_end(args);
+    ili9341_task_console_print(line, color);
+#else
+    (void)color;
+    (void)fmt;
+#endif
+}
+
+// Show or hide the alcohol warning at the bottom of the screen
+static void lcd_show_alcohol_warning(bool show)
+{
+    if (show) {
+        ili9341_task_set_image(LCD_IMAGE_WARNING, &image_alcohol_warning,
+                               LCD_CENTER_X - image_alcohol_warning.width / 2, 150);
+        ili9341_task_set_line_aligned(LCD_SLOT_DETAIL, "WARNING ALCOHOL DETECTED", LCD_CENTER_X, 200,
+                                      ILI9341_ALIGN_CENTER, ILI9341_RED, 1);
+    } else {
+        ili9341_task_clear_image(LCD_IMAGE_WARNING);
+        ili9341_task_clear_line(LCD_SLOT_DETAIL);
+    }
+}
+
 // Convert BLE address to string
 static char* addr_str(const void *addr)
 {
@@ -57,34 +227,101 @@ static char* addr_str(const void *addr)
 }
 
 // Print advertising data (simplified to show only name and MAC)
-static void print_adv_data(const struct ble_hs_adv_fields *fields, const uint8_t *addr)
+static void print_adv_data(const uint8_t *name, uint8_t name_len, const uint8_t *addr)
 {
-    // Print MAC address
-    printf("MAC: %s ", addr_str(addr));
+    bool has_name = (name != NULL);
+    
+    // MAC address and device name if available
+    if (has_name) {
+        BINLOG_BLOB(LOG_ADV_REPORT, name, name_len, LOG_ADDR_ARGS(addr));
+    } else {
+        BINLOG_BLOB(LOG_ADV_REPORT, "(unknown)", 9, LOG_ADDR_ARGS(addr));
+    }
     
-    // Print device name if available
-    if (fields->name != NULL) {
-        printf(" | Name: %s", fields->name);
+    if (has_name) {
+        lcd_log(ILI9341_WHITE, "%s %.*s", addr_str(addr), name_len, (const char *)name);
     } else {
-        printf(" | Name: (unknown)");
+        lcd_log(ILI9341_WHITE, "%s", addr_str(addr));
+    }
+}
+
+// ==== Scan Timers ====
+// All run in the host task, like the GAP events
+static void scan_restart_cb(struct ble_npl_event *ev)
+{
+    start_scan();
+}
+
+// Scan again after SCAN_RESTART_DELAY_MS
+static void schedule_rescan(void)
+{
+    ble_npl_callout_reset(&scan_restart_timer, ble_npl_time_ms_to_ticks32(SCAN_RESTART_DELAY_MS));
+}
+
+// Start discovery with scan_params, until cancelled
+static int scan_begin(void)
+{
+    struct ble_gap_disc_params disc_params = {
+        .itvl = scan_params.itvl,
+        .window = scan_params.window,
+        .filter_policy = 0,  // Accept all advertisements
+        .limited = 0,        // Not limited discovery
+        .passive = 0,        // Active scanning (to get scan response data)
+        .filter_duplicates = 0,  // Filtered in software, see client_core
+    };
+    
+    int rc = ble_gap_disc(own_addr_type, BLE_HS_FOREVER, &disc_params,
+                         gap_event_cb, NULL);
+    scan_active = (rc == 0);
+    return rc;
+}
+
+static void scan_policy_cb(struct ble_npl_event *ev)
+{
+    // A connection attempt has the radio; start_scan() rearms the policy
+    if (!scan_active) {
+        return;
+    }
+    
+    int64_t now = esp_timer_get_time();
+    scan_observation_t obs = {
+        .now_ms = (uint32_t)(now / 1000),
+        .reports = scan_reports,
+        .listen_ms = scan_params_listen_ms(&scan_params, (uint32_t)((now - scan_policy_us) / 1000)),
+    };
+    scan_reports = 0;
+    scan_policy_us = now;
+    
+    scan_params_t next;
+    scan_policy.decide(scan_policy.ctx, &obs, &next);
+    if (next.enabled != scan_params.enabled || next.itvl != scan_params.itvl ||
+        next.window != scan_params.window) {
+        BINLOG(LOG_SCAN_POLICY, next.itvl, next.window,
+               next.itvl ? 100 * next.window / next.itvl : 0);
+        ble_gap_disc_cancel();
+        scan_active = false;
+        scan_params = next;
+        if (scan_params.enabled && scan_begin() != 0) {
+            schedule_rescan();
+        }
     }
     
-    printf("\n");
+    if (scan_active) {
+        ble_npl_callout_reset(&scan_policy_timer, ble_npl_time_ms_to_ticks32(SCAN_POLICY_PERIOD_MS));
+    }
 }
 
 // Function to connect to a BLE device
 static void connect_to_device(const ble_addr_t *addr) {
-    printf("Attempting to connect to %s...\n", addr_str(addr->val));
+    BINLOG(LOG_CONNECTING, LOG_ADDR_ARGS(addr->val));
     
-    // First, stop any ongoing scan
+    // First, stop any ongoing scan (returns once the controller has)
     int rc = ble_gap_disc_cancel();
     if (rc != 0 && rc != BLE_HS_EALREADY) {
-        printf("Error stopping scan: %d\n", rc);
+        BINLOG(LOG_SCAN_STOP_FAIL, rc);
         return;
     }
-    
-    // Small delay to ensure scan is fully stopped
-    vTaskDelay(pdMS_TO_TICKS(100));
+    scan_active = false;
     
     struct ble_gap_conn_params conn_params = {
         .scan_itvl = 0x60,
@@ -101,48 +338,44 @@ static void connect_to_device(const ble_addr_t *addr) {
     rc = ble_gap_connect(own_addr_type, addr, 30000, &conn_params, 
                         gap_event_cb, NULL);
     if (rc != 0) {
-        printf("Error: Failed to connect to device: %d. Will retry...\n", rc);
-        // Schedule a rescan after a delay using a static function
-        static TaskHandle_t rescan_task_handle = NULL;
-        if (rescan_task_handle == NULL) {  // Only create if not already running
-            xTaskCreatePinnedToCore(
-                rescan_task,
-                "rescan_task",
-                2048,
-                NULL,
-                5,
-                &rescan_task_handle,
-                0
-            );
-        }
+        BINLOG(LOG_CONNECT_FAIL, rc);
+        schedule_rescan();
         return;
     }
     
-    printf("Connection initiated...\n");
+    BINLOG(LOG_CONNECT_STARTED);
 }
 
 // Called when an advertisement is received
 static int gap_event_cb(struct ble_gap_event *event, void *arg)
 {
-    // Remove unused variable
-    struct ble_hs_adv_fields fields;
-    int rc;
+    adv_report_t report;
+    client_core_action_t action;
     
     switch (event->type) {
     case BLE_GAP_EVENT_DISC:
-        // Parse the advertising data
-        rc = ble_hs_adv_parse_fields(&fields, event->disc.data,
-                                    event->disc.length_data);
-        if (rc != 0) {
-            return 0;
-        }
+        // The filtering and target match live in client_core, shared
+        // with the Linux trace replay
+        scan_reports++;
+        report = (adv_report_t) {
+            .time_ms = (uint32_t)(esp_timer_get_time() / 1000),
+            .addr_type = event->disc.addr.type,
+            .event_type = event->disc.event_type,
+            .rssi = event->disc.rssi,
+            .data_len = event->disc.length_data,
+            .data = event->disc.data,
+        };
+        memcpy(report.addr, event->disc.addr.val, 6);
+        client_core_report(&client, &report, device_connected, &action);
         
-        // Print simplified device info
-        print_adv_data(&fields, event->disc.addr.val);
+        // Print simplified device info, once per duplicate filter period
+        if (action.print) {
+            print_adv_data(action.name, action.name_len, event->disc.addr.val);
+        }
         
-        // Check if this is our target device
-        if (memcmp(event->disc.addr.val, TARGET_ADDR, 6) == 0 && !device_connected) {
-            printf("Target device found! Attempting to connect...\n");
+        // Our target device
+        if (action.connect) {
+            BINLOG(LOG_TARGET_FOUND, action.detect_ms);
             connect_to_device(&event->disc.addr);
             // Don't set device_connected yet - wait for connection success
         }
@@ -152,61 +385,50 @@ static int gap_event_cb(struct ble_gap_event *event, void *arg)
         // A new connection was established or a connection attempt failed
         if (event->connect.status == 0) {
             // Connection successful
-            printf("Connection established. Connection handle: %d\n", event->connect.conn_handle);
+            BINLOG(LOG_CONNECTED, event->connect.conn_handle);
+            lcd_log(ILI9341_GREEN, "Connected, handle %d", event->connect.conn_handle);
             conn_handle = event->connect.conn_handle;
             device_connected = true; // Only set this on successful connection
+            ble_npl_callout_reset(&read_timer, ble_npl_time_ms_to_ticks32(PERIODIC_READ_MS));
             // Show connected message on LCD
-            ili9341_fill(0x0000);
-            ili9341_text_medium("Rider Helmet Detected", 30, 120, 0xFFE0);
-            // Start service discovery
-            printf("Starting service discovery...\n");
-            int rc = discover_services(conn_handle);
-            if (rc != 0) {
-                printf("Failed to start service discovery: %d\n", rc);
-            }
+            lcd_show_status("Rider Helmet Detected", ILI9341_YELLOW, &image_helmet);
+            // Start service discovery (logs its own failure)
+            discover_services(conn_handle);
         } else {
             // Connection attempt failed
-            printf("Error: Connection failed, status: %d\n", event->connect.status);
+            BINLOG(LOG_CONNECT_ERROR, event->connect.status);
+            lcd_log(ILI9341_RED, "Connect failed: %d", event->connect.status);
             device_connected = false; // Allow reconnection attempt
-            // Restart scanning after a short delay
             // Show searching message on LCD
-ili9341_fill(0x0000);
-ili9341_text_medium("Looking for helmet", 30, 120, 0xFFE0);
-            vTaskDelay(pdMS_TO_TICKS(1000));
-            start_scan();
+            lcd_show_status("Looking for helmet", ILI9341_YELLOW, NULL);
+            lcd_power_save_arm();
+            // Restart scanning after a short delay
+            schedule_rescan();
         }
         break;
         
     case BLE_GAP_EVENT_DISCONNECT:
         // Handle disconnection
-        printf("Disconnected. Reason: %d\n", event->disconnect.reason);
+        BINLOG(LOG_DISCONNECTED, event->disconnect.reason);
+        lcd_log(ILI9341_YELLOW, "Disconnected: %d", event->disconnect.reason);
         device_connected = false;
         conn_handle = BLE_HS_CONN_HANDLE_NONE;
-        // Restart scanning after a short delay
-        vTaskDelay(pdMS_TO_TICKS(1000));
         // Show searching message on LCD
-        ili9341_fill(0x0000);
-        ili9341_text_medium("Looking for helmet", 30, 120, 0xFFE0);
-        start_scan();
+        lcd_show_status("Looking for helmet", ILI9341_YELLOW, NULL);
+        lcd_power_save_arm();
+        // Restart scanning after a short delay
+        schedule_rescan();
         break;
         
     case BLE_GAP_EVENT_DISC_COMPLETE:
+        // Scanning runs until cancelled; if the stack ends it anyway,
+        // pick it straight back up with the same parameters
+        scan_active = false;
         if (!device_connected) {
-            printf("\nScan complete. Waiting before next scan...\n");
-            
-            // Add a delay before restarting scan
-            vTaskDelay(pdMS_TO_TICKS(2000));
-            
-            // Restart scanning with same parameters
-            struct ble_gap_disc_params disc_params = {
-                .itvl = 0x60,
-                .window = 0x30,
-                .filter_policy = 0,
-                .limited = 0,
-                .passive = 0,
-                .filter_duplicates = 1,
-            };
-            ble_gap_disc(own_addr_type, 3000, &disc_params, gap_event_cb, NULL);
+            BINLOG(LOG_SCAN_ENDED, event->disc_complete.reason);
+            if (scan_begin() != 0) {
+                schedule_rescan();
+            }
         }
         break;
         
@@ -217,22 +439,22 @@ ili9341_text_medium("Looking for helmet", 30, 120, 0xFFE0);
     return 0;
 }
 
-// Convert BLE UUID to string
-static void print_uuid(const ble_uuid_any_t *uuid) {
+// Log a BLE UUID. fmt is the first of four formats in a row: 16, 32 and
+// 128 bit, then unknown type (see log_formats.h)
+static void log_uuid(uint16_t fmt, const ble_uuid_any_t *uuid) {
     switch (uuid->u.type) {
         case BLE_UUID_TYPE_16:
-            printf("0x%04" PRIx16, BLE_UUID16(uuid)->value);
+            BINLOG(fmt, BLE_UUID16(uuid)->value);
             break;
         case BLE_UUID_TYPE_32:
-            printf("0x%08" PRIx32, BLE_UUID32(uuid)->value);
+            BINLOG(fmt + 1, BLE_UUID32(uuid)->value);
             break;
         case BLE_UUID_TYPE_128:
-            printf("0x%02" PRIx8 "%02" PRIx8 "...%02" PRIx8 "%02" PRIx8,
-                   uuid->u128.value[15], uuid->u128.value[14],
+            BINLOG(fmt + 2, uuid->u128.value[15], uuid->u128.value[14],
                    uuid->u128.value[1], uuid->u128.value[0]);
             break;
         default:
-            printf("(unknown type %d)", uuid->u.type);
+            BINLOG(fmt + 3, uuid->u.type);
             break;
     }
 }
@@ -265,42 +487,40 @@ static int on_notify(uint16_t conn_handle, const struct ble_gatt_error *error,
                    struct ble_gatt_attr *attr, void *arg) {
     if (error != NULL) {
         if (error->status != 0) {
-            printf("Notification error: %d\n", error->status);
+            BINLOG(LOG_NOTIFY_ERROR, error->status);
             return error->status;
         }
     }
 
     if (attr == NULL) {
-        printf("Notification received: NULL attribute\n");
+        BINLOG(LOG_NOTIFY_NULL);
         return 0;
     }
 
-    printf("Notification received (handle=0x%04x): ", attr->handle);
-    
     if (attr->om != NULL) {
-        // Print all bytes
-        for (int i = 0; i < attr->om->om_len && i < 32; i++) {  // Limit to first 32 bytes
-            printf("%02x ", attr->om->om_data[i]);
-        }
-        printf("(%d bytes)\n", attr->om->om_len);
+        // Dump the first 32 bytes
+        BINLOG_BLOB(LOG_NOTIFY_DATA, attr->om->om_data, attr->om->om_len < 32 ? attr->om->om_len : 32,
+                    attr->handle, attr->om->om_len);
         
         // Check if this is the 0x0022 handle and has at least 1 byte of data
-        if (attr->handle == 0x0022 && attr->om->om_len >= 1) {
+        if (attr->handle == SENSOR_VALUE_HANDLE && attr->om->om_len >= 1) {
             uint8_t first_byte = attr->om->om_data[0];
-            printf("First byte (decimal): %u\n", first_byte);
+            BINLOG(LOG_SENSOR_VALUE, first_byte);
+            lcd_log(first_byte < 40 ? ILI9341_RED : ILI9341_CYAN, "0x%04x: %u", attr->handle, first_byte);
+            lcd_show_sensor_value(first_byte);
             
             if (first_byte < 40) {
-                printf("ALCOHOL DETECTED! (Value: %u < 40)\n", first_byte);
+                BINLOG(LOG_ALCOHOL, first_byte);
                 // Show red warning at the bottom of the screen
-                ili9341_text_small("WARNING ALCOHOL DETECTED", 40, 200, 0xF800); // 0xF800 is red
+                lcd_show_alcohol_warning(true);
             } else {
-                printf("No alcohol detected (Value: %u >= 40)\n", first_byte);
+                BINLOG(LOG_NO_ALCOHOL, first_byte);
                 // Clear the warning if it was previously shown
-                ili9341_text_small("WARNING ALCOHOL DETECTED", 40, 200, 0x0000); // 0xF800 is red
+                lcd_show_alcohol_warning(false);
             }
         }
     } else {
-        printf("No data\n");
+        BINLOG(LOG_NOTIFY_EMPTY, attr->handle);
     }
     
     return 0;
@@ -308,10 +528,10 @@ static int on_notify(uint16_t conn_handle, const struct ble_gatt_error *error,
 
 // Read characteristic value
 static int read_characteristic(uint16_t conn_handle, uint16_t val_handle) {
-    printf("Reading characteristic value from handle 0x%04x...\n", val_handle);
+    BINLOG(LOG_READING, val_handle);
     int rc = ble_gattc_read(conn_handle, val_handle, on_notify, NULL);
     if (rc != 0) {
-        printf("Failed to read characteristic: %d\n", rc);
+        BINLOG(LOG_READ_FAIL, rc);
     }
     return rc;
 }
@@ -319,13 +539,13 @@ static int read_characteristic(uint16_t conn_handle, uint16_t val_handle) {
 
 // Subscribe to notifications
 static int subscribe_to_notifications(uint16_t conn_handle, uint16_t val_handle, uint16_t ccc_handle) {
-    printf("Subscribing to notifications for handle 0x%04x (CCCD: 0x%04x)...\n", val_handle, ccc_handle);
+    BINLOG(LOG_SUBSCRIBING, val_handle, ccc_handle);
     
     // Write to CCCD to enable notifications (0x0001) or indications (0x0002)
     uint16_t cccd_val = 0x0001;  // 0x0001 for notifications, 0x0002 for indications
     int rc = ble_gattc_write_flat(conn_handle, ccc_handle, &cccd_val, sizeof(cccd_val), on_notify, NULL);
     if (rc != 0) {
-        printf("Failed to write to CCCD: %d\n", rc);
+        BINLOG(LOG_CCCD_FAIL, rc);
         return rc;
     }
     
@@ -338,27 +558,23 @@ static int disc_svc_chrs_cb(uint16_t conn_handle, const struct ble_gatt_error *e
     (void)arg;  // Unused parameter
     
     if (error->status == BLE_HS_EDONE) {
-        printf("  Characteristics discovery complete\n");
+        BINLOG(LOG_CHR_DONE);
         return 0;
     }
     
     if (error->status != 0) {
-        printf("  Characteristic discovery failed: %d\n", error->status);
+        BINLOG(LOG_CHR_ERROR, error->status);
         return error->status;
     }
     
-    printf("  Characteristic: handle=0x%04x, def_handle=0x%04x, val_handle=0x%04x, props=",
-           chr->val_handle - 1, chr->def_handle, chr->val_handle);
-    printf("%s\n", chr_props_to_str(chr->properties));
-    
-    printf("    UUID: ");
-    print_uuid((const ble_uuid_any_t *)&chr->uuid);
-    printf("\n");
+    const char *props = chr_props_to_str(chr->properties);
+    BINLOG_BLOB(LOG_CHR_FOUND, props, strlen(props),
+                chr->val_handle - 1, chr->def_handle, chr->val_handle);
+    log_uuid(LOG_CHR_UUID16, (const ble_uuid_any_t *)&chr->uuid);
     
     // Check if this is from the last service (0x4444...0000)
     if (chr->def_handle >= 0x0020) {
-        printf("\n=== Found target characteristic in last service ===\n");
-        printf("Handle: 0x%04x, Properties: %s\n", chr->val_handle, chr_props_to_str(chr->properties));
+        BINLOG_BLOB(LOG_CHR_TARGET, props, strlen(props), chr->val_handle);
           
 
         // If it supports READ, read its value
@@ -380,27 +596,23 @@ static int disc_svc_chrs_cb(uint16_t conn_handle, const struct ble_gatt_error *e
 static int disc_svc_cb(uint16_t conn_handle, const struct ble_gatt_error *error,
                       const struct ble_gatt_svc *service, void *arg) {
     if (error->status == BLE_HS_EDONE) {
-        printf("Service discovery complete\n");
+        BINLOG(LOG_SVC_DONE);
         return 0;
     }
     
     if (error->status != 0) {
-        printf("Service discovery failed: %d\n", error->status);
+        BINLOG(LOG_SVC_ERROR, error->status);
         return error->status;
     }
     
-    printf("\nService found: start_handle=0x%04x, end_handle=0x%04x\n",
-           service->start_handle, service->end_handle);
-    
-    printf("  UUID: ");
-    print_uuid((const ble_uuid_any_t *)&service->uuid);
-    printf("\n");
+    BINLOG(LOG_SVC_FOUND, service->start_handle, service->end_handle);
+    log_uuid(LOG_SVC_UUID16, (const ble_uuid_any_t *)&service->uuid);
     
     // Discover characteristics for this service
     int rc = ble_gattc_disc_all_chrs(conn_handle, service->start_handle, 
                                     service->end_handle, disc_svc_chrs_cb, NULL);
     if (rc != 0) {
-        printf("Failed to discover characteristics: %d\n", rc);
+        BINLOG(LOG_CHR_DISC_FAIL, rc);
         return rc;
     }
     
@@ -409,58 +621,55 @@ static int disc_svc_cb(uint16_t conn_handle, const struct ble_gatt_error *error,
 
 // Start service discovery
 static int discover_services(uint16_t conn_handle) {
-    printf("Discovering services...\n");
+    BINLOG(LOG_SVC_DISC_START);
     
     // Start discovering all services
     int rc = ble_gattc_disc_all_svcs(conn_handle, disc_svc_cb, NULL);
     if (rc != 0) {
-        printf("Failed to start service discovery: %d\n", rc);
+        BINLOG(LOG_SVC_DISC_FAIL, rc);
         return rc;
     }
     
     return 0;
 }
 
-// Task to handle rescan after delay
-static void rescan_task(void *arg) {
-    vTaskDelay(pdMS_TO_TICKS(1000));
-    start_scan();
-    vTaskDelete(NULL);
-}
-
-// Task to periodically read the characteristic
-static void periodic_read_task(void *arg) {
-    while (1) {
-        if (device_connected && conn_handle != BLE_HS_CONN_HANDLE_NONE) {
-            printf("\n[Periodic Read] ");
-            read_characteristic(conn_handle, 0x0022);  // Read handle 0x0022
-        }
-        vTaskDelay(3000 / portTICK_PERIOD_MS);  // 3 second delay
+// Read the sensor every PERIODIC_READ_MS until the connection drops
+static void read_timer_cb(struct ble_npl_event *ev)
+{
+    if (!device_connected || conn_handle == BLE_HS_CONN_HANDLE_NONE) {
+        return;
     }
+    read_characteristic(conn_handle, SENSOR_VALUE_HANDLE);
+    ble_npl_callout_reset(&read_timer, ble_npl_time_ms_to_ticks32(PERIODIC_READ_MS));
 }
 
-// Start BLE scanning
+// Start BLE scanning: a new search for the helmet
 void start_scan(void)
 {
-    // Set scan parameters
-    struct ble_gap_disc_params disc_params = {
-        .itvl = 0x60,    // Scan interval: 60ms (slower to reduce CPU load)
-        .window = 0x30,  // Scan window: 30ms (50% duty cycle)
-        .filter_policy = 0,  // Accept all advertisements
-        .limited = 0,        // Not limited discovery
-        .passive = 0,        // Active scanning (to get scan response data)
-        .filter_duplicates = 1,  // Filter duplicates to reduce output
-    };
-    
-    // Start scanning
-    int rc = ble_gap_disc(own_addr_type, 3000, &disc_params,  // Scan for 3 seconds
-                         gap_event_cb, NULL);
+    // The policy hunts from the start of every search
+    int64_t now = esp_timer_get_time();
+    scan_observation_t obs = { .now_ms = (uint32_t)(now / 1000) };
+    scan_policy.reset(scan_policy.ctx, obs.now_ms);
+    scan_policy.decide(scan_policy.ctx, &obs, &scan_params);
+    
+    // Start scanning until a connection attempt cancels it
+    int rc = scan_begin();
     if (rc != 0) {
-        printf("Error starting scan: %d\n", rc);
+        BINLOG(LOG_SCAN_START_FAIL, rc);
+        if (rc != BLE_HS_EALREADY) {
+            schedule_rescan();
+        }
         return;
     }
     
-    printf("Scanning for BLE devices...\n");
+    // A new scan forgets what the last one saw, as the controller would
+    client_core_search(&client, obs.now_ms);
+    
+    scan_policy_us = now;
+    scan_reports = 0;
+    ble_npl_callout_reset(&scan_policy_timer, ble_npl_time_ms_to_ticks32(SCAN_POLICY_PERIOD_MS));
+    
+    BINLOG(LOG_SCAN_STARTED);
 }
 
 // Called when BLE host task starts
@@ -476,12 +685,12 @@ static void ble_host_task(void *param)
 // Application callback for BLE host sync
 static int ble_app_on_sync(void)
 {
-    printf("BLE: Host sync started\n");
+    BINLOG(LOG_HOST_SYNC);
     
     // Figure out address to use
     int rc = ble_hs_util_ensure_addr(0);
     if (rc != 0) {
-        printf("BLE: Failed to ensure address: %d\n", rc);
+        BINLOG(LOG_ADDR_FAIL, rc);
         return rc;
     }
     
@@ -489,17 +698,15 @@ static int ble_app_on_sync(void)
     uint8_t addr_val[6] = {0};
     rc = ble_hs_id_copy_addr(own_addr_type, addr_val, NULL);
     if (rc != 0) {
-        printf("BLE: Failed to copy address: %d\n", rc);
+        BINLOG(LOG_ADDR_COPY_FAIL, rc);
         return rc;
     }
     
-    printf("BLE: Scanner started, address: %s\n", addr_str(addr_val));
-    
+    BINLOG(LOG_OWN_ADDR, LOG_ADDR_ARGS(addr_val));
     
     // Start scanning
-    printf("BLE: Starting scan...\n");
-    ili9341_fill(0x0000); 
-    ili9341_text_medium("Searching for Helmet", 30, 120, 0xFFFF);
+    lcd_show_status("Searching for Helmet", ILI9341_WHITE, NULL);
+    lcd_power_save_arm();
     start_scan();
     
     return 0;
@@ -508,7 +715,7 @@ static int ble_app_on_sync(void)
 // Application callback for BLE host reset
 static void ble_app_on_reset(int reason)
 {
-    printf("BLE reset: %d\n", reason);
+    BINLOG(LOG_HOST_RESET, reason);
 }
 
 // Application callbacks
@@ -531,7 +738,8 @@ void app_main(void)
     printf("App: NVS init status: %s\n", esp_err_to_name(ret));
     
     // Initialize display configuration
-    ili9341_config_t display_config = {
+    // Static: the driver keeps a pointer to it after app_main() returns
+    static ili9341_config_t display_config = {
         .spi_host = SPI2_HOST,
         .pin_miso = -1,  // Not used for display
         .pin_mosi = 6,   // GPIO6 for MOSI/SDA (changed from 13)
@@ -540,29 +748,61 @@ void app_main(void)
         .pin_dc = 5,     // GPIO5 for DC (changed from 11)
         .pin_rst = 4,    // GPIO4 for RESET (changed from 9)
         .pin_bckl = 15,  // GPIO15 for backlight control (changed from 14)
-        .spi_clock_speed_hz = 40 * 1000 * 1000  // 40MHz
+        .spi_clock_speed_hz = 40 * 1000 * 1000,  // 40MHz
+        .hw_cs = true    // SPI peripheral drives CS, DC set from pre_cb
     };
     
     // Initialize display
     ili9341_init(&display_config);
-    ili9341_fill(0x0000); // Black background
+    
+    // Strip renderer: 320x40 (25 KB) strips, only changed regions are sent
+    if (ili9341_fb_init(40) != ESP_OK) {
+        printf("App: Failed to allocate LCD strip buffer\n");
+    }
+    
+    // From here on only the render task touches the display
+    if (ili9341_task_start() != ESP_OK) {
+        printf("App: Failed to start LCD render task\n");
+    }
+    if (LCD_CONSOLE) {
+        ili9341_task_console_start();
+    }
 
     // Display welcome message
-    ili9341_text_medium("WELCOME", 40, 100, 0xFFFF);        // White text
-    ili9341_text_small("DEVICE STARTING...", 20, 130, 0x07E0); // Green text
+    ili9341_task_set_line_aligned(LCD_SLOT_STATUS, "WELCOME", LCD_CENTER_X, 100, ILI9341_ALIGN_CENTER, ILI9341_WHITE, 2);
+    ili9341_task_set_line_aligned(LCD_SLOT_DETAIL, "DEVICE STARTING...", LCD_CENTER_X, 130, ILI9341_ALIGN_CENTER, ILI9341_GREEN, 1);
     // Initialize BLE controller and NimBLE host
 
     vTaskDelay(pdMS_TO_TICKS(1000)); // one second delay
-    ili9341_fill(0x0000); 
     printf("App: Initializing BLE...\n");
-    ili9341_fill(0x0000); 
-    ili9341_text_medium("Initializing BLE", 30, 120, 0xFFFF);        // 3x size (15x24 pixels)
+    lcd_show_status("Initializing BLE", ILI9341_WHITE, NULL);
     
     esp_nimble_hci_init();
     
+    // Console output of the BLE callbacks, from here on
+    static const binlog_config_t log_config = {
+        .formats = log_formats,
+        .format_count = LOG_FORMAT_COUNT,
+    };
+    if (binlog_start(&log_config) != ESP_OK) {
+        printf("App: Failed to start the log task\n");
+    }
+    
     printf("App: Initializing NimBLE port...\n");
     nimble_port_init();
     
+    client_core_init(&client, TARGET_ADDR, 0);
+    
+    // Timers, delivered through the host task's event queue
+    ble_npl_callout_init(&scan_restart_timer, nimble_port_get_dflt_eventq(), scan_restart_cb, NULL);
+    ble_npl_callout_init(&scan_policy_timer, nimble_port_get_dflt_eventq(), scan_policy_cb, NULL);
+    ble_npl_callout_init(&lcd_idle_timer, nimble_port_get_dflt_eventq(), lcd_idle_timer_cb, NULL);
+    ble_npl_callout_init(&read_timer, nimble_port_get_dflt_eventq(), read_timer_cb, NULL);
+    lcd_idle_timer_ready = true;
+    
+    static const scan_adaptive_config_t scan_policy_config = SCAN_ADAPTIVE_DEFAULT_CONFIG;
+    scan_policy_adaptive_init(&scan_policy, &scan_policy_state, &scan_policy_config);
+    
     // Set the default device name
     printf("App: Setting device name...\n");
     ble_svc_gap_device_name_set("ESP32-BLE-Scanner");
@@ -588,9 +828,6 @@ void app_main(void)
     printf("App: Starting BLE host task...\n");
     nimble_port_freertos_init(ble_host_task);
     
-    // Create a task for periodic reads
-    xTaskCreate(periodic_read_task, "periodic_read", 4096, NULL, 5, NULL);
-    
     // Keep the main task alive
     while (1) {
         vTaskDelay(1000 / portTICK_PERIOD_MS);
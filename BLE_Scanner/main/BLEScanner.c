@@ -6,13 +6,34 @@
 #include "nimble/nimble_port.h"
 #include "nimble/nimble_port_freertos.h"
 #include "host/ble_hs.h"
-#include "host/ble_hs_adv.h"
 #include "host/util/util.h"
 #include "services/gap/ble_svc_gap.h"
+#include "device_table.h"
+#include "adv_data.h"
+#include "adv_trace.h"
+#include "scan_core.h"
+#include "binlog.h"
+#include "log_formats.h"
 
 // Scan parameters
 static uint8_t own_addr_type;
 
+static void start_scan(void);
+
+// Device summary: printed every SUMMARY_PERIOD_MS instead of a line per
+// advertisement, which the UART can't keep up with in a crowded place
+#define SUMMARY_PERIOD_MS   5000
+#define SUMMARY_TOP_DEVICES 8
+
+// Only touched from the NimBLE host task (GAP events and the callout)
+static device_table_t devices;
+static struct ble_npl_callout summary_timer;
+static uint32_t summary_reports = 0;
+
+// The host task logs through the binary log, so the summary doesn't hold
+// it up for the time the UART takes to send it; see log_formats.h
+static const char *const log_formats[] = { SCANNER_LOG_FORMATS(BINLOG_FORMAT_STR) };
+
 // Convert BLE address to string
 static char* addr_str(const void *addr)
 {
@@ -25,60 +46,74 @@ static char* addr_str(const void *addr)
     return buf;
 }
 
-// Print advertising data (simplified to show only name and MAC)
-static void print_adv_data(const struct ble_hs_adv_fields *fields, const uint8_t *addr)
+static uint32_t now_ms(void)
+{
+    return ble_npl_time_ticks_to_ms32(ble_npl_time_get());
+}
+
+// Print the device count, report rate and the strongest devices
+static void summary_cb(struct ble_npl_event *ev)
 {
-    // Print MAC address
-    printf("MAC: %s ", addr_str(addr));
-    
-    // Print device name if available
-    if (fields->name != NULL) {
-        printf(" | Name: %s", fields->name);
-    } else {
-        printf(" | Name: (unknown)");
+    uint32_t now = now_ms();
+    size_t expired = scan_core_expire(&devices, now);
+    uint32_t reports = devices.reports - summary_reports;
+    summary_reports = devices.reports;
+    
+    BINLOG(LOG_SUMMARY, devices.entries, reports * 1000 / SUMMARY_PERIOD_MS, expired,
+           devices.dropped);
+    
+    const device_entry_t *top[SUMMARY_TOP_DEVICES];
+    size_t n = device_table_strongest(&devices, top, SUMMARY_TOP_DEVICES);
+    for (size_t i = 0; i < n; i++) {
+        const device_entry_t *e = top[i];
+        const char *name = e->name[0] ? e->name : "(unknown)";
+        BINLOG_BLOB(LOG_DEVICE, name, strlen(name), LOG_ADDR_ARGS(e->addr),
+                    device_entry_rssi(e), e->count, now - e->last_seen_ms);
     }
     
-    printf("\n");
+    ble_npl_callout_reset(&summary_timer, ble_npl_time_ms_to_ticks32(SUMMARY_PERIOD_MS));
+}
+
+#if CONFIG_SCANNER_TRACE_CAPTURE
+// Stream the report as a trace record (see adv_trace.h). Records the
+// console can't keep up with are dropped, and counted by the binary log.
+static void trace_report(const adv_report_t *report)
+{
+    uint8_t record[BINLOG_MAX_BLOB];
+    size_t len = adv_trace_encode(report, record, sizeof(record));
+    BINLOG_BLOB(LOG_TRACE, record, len);
 }
+#endif
 
 // Called when an advertisement is received
 static int gap_event_cb(struct ble_gap_event *event, void *arg)
 {
-    static uint32_t last_print = 0;
-    struct ble_hs_adv_fields fields;
-    int rc;
+    adv_report_t report;
     
     switch (event->type) {
     case BLE_GAP_EVENT_DISC:
-        // Parse the advertising data
-        rc = ble_hs_adv_parse_fields(&fields, event->disc.data,
-                                    event->disc.length_data);
-        if (rc != 0) {
-            return 0;
-        }
-        
-        // Print simplified device info
-        print_adv_data(&fields, event->disc.addr.val);
-        
-
+        // The device table work lives in scan_core, shared with the
+        // Linux trace replay
+        report = (adv_report_t) {
+            .time_ms = now_ms(),
+            .addr_type = event->disc.addr.type,
+            .event_type = event->disc.event_type,
+            .rssi = event->disc.rssi,
+            .data_len = event->disc.length_data,
+            .data = event->disc.data,
+        };
+        memcpy(report.addr, event->disc.addr.val, 6);
+#if CONFIG_SCANNER_TRACE_CAPTURE
+        trace_report(&report);
+#endif
+        scan_core_report(&devices, &report);
         break;
         
     case BLE_GAP_EVENT_DISC_COMPLETE:
-        printf("\nScan complete. Waiting before next scan...\n");
-        
-        // Add a delay before restarting scan
-        vTaskDelay(pdMS_TO_TICKS(2000));
-        
-        // Restart scanning with same parameters
-        struct ble_gap_disc_params disc_params = {
-            .itvl = 0x60,
-            .window = 0x30,
-            .filter_policy = 0,
-            .limited = 0,
-            .passive = 0,
-            .filter_duplicates = 1,
-        };
-        ble_gap_disc(own_addr_type, 3000, &disc_params, gap_event_cb, NULL);
+        // Scanning runs until cancelled; if the stack ends it anyway, pick
+        // it straight back up rather than going deaf
+        BINLOG(LOG_SCAN_ENDED, event->disc_complete.reason);
+        start_scan();
         break;
         
     default:
@@ -98,18 +133,18 @@ static void start_scan(void)
         .filter_policy = 0,  // Accept all advertisements
         .limited = 0,        // Not limited discovery
         .passive = 0,        // Active scanning (to get scan response data)
-        .filter_duplicates = 1,  // Filter duplicates to reduce output
+        .filter_duplicates = 0,  // Every report feeds the device table
     };
     
-    // Start scanning
-    int rc = ble_gap_disc(own_addr_type, 3000, &disc_params,  // Scan for 3 seconds
+    // Scan continuously; the device table stands in for the duplicate filter
+    int rc = ble_gap_disc(own_addr_type, BLE_HS_FOREVER, &disc_params,
                          gap_event_cb, NULL);
     if (rc != 0) {
-        printf("Error starting scan: %d\n", rc);
+        BINLOG(LOG_SCAN_START_FAIL, rc);
         return;
     }
     
-    printf("Scanning for BLE devices...\n");
+    BINLOG(LOG_SCAN_STARTED);
 }
 
 // Called when BLE host task starts
@@ -144,6 +179,9 @@ static int ble_app_on_sync(void)
     
     printf("BLE: Scanner started, address: %s\n", addr_str(addr_val));
     
+    // Start the periodic device summary
+    ble_npl_callout_reset(&summary_timer, ble_npl_time_ms_to_ticks32(SUMMARY_PERIOD_MS));
+    
     // Start scanning
     printf("BLE: Starting scan...\n");
     start_scan();
@@ -179,9 +217,22 @@ void app_main(void)
     printf("App: Initializing BLE...\n");
     esp_nimble_hci_init();
     
+    // Console output of the host task, from here on
+    static const binlog_config_t log_config = {
+        .formats = log_formats,
+        .format_count = LOG_FORMAT_COUNT,
+    };
+    if (binlog_start(&log_config) != ESP_OK) {
+        printf("App: Failed to start the log task\n");
+    }
+    
     printf("App: Initializing NimBLE port...\n");
     nimble_port_init();
     
+    // Device table, summarised from the host task's event queue
+    device_table_init(&devices);
+    ble_npl_callout_init(&summary_timer, nimble_port_get_dflt_eventq(), summary_cb, NULL);
+    
     // Set the default device name
     printf("App: Setting device name...\n");
     ble_svc_gap_device_name_set("ESP32-BLE-Scanner");
@@ -0,0 +1,22 @@
+#ifndef LOG_FORMATS_H
+#define LOG_FORMATS_H
+
+#include "binlog.h"
+
+// Binary log formats for the host task, X(id, "format"); see binlog.h for
+// the conversions. Only string literals here: binlog_decode.py reads this
+// list to decode raw captures. LOG_TRACE starts with ADV_TRACE_LINE_PREFIX.
+#define SCANNER_LOG_FORMATS(X) \
+    X(LOG_SUMMARY,         "\nDevices: %u | %u reports/s | %u expired | %u dropped") \
+    X(LOG_DEVICE,          "MAC: %02x:%02x:%02x:%02x:%02x:%02x | RSSI: %4d dBm | Adv: %6u | Seen: %5u ms ago | Name: %s") \
+    X(LOG_SCAN_STARTED,    "Scanning for BLE devices...") \
+    X(LOG_SCAN_START_FAIL, "Error starting scan: %d") \
+    X(LOG_SCAN_ENDED,      "\nScan ended (reason %d), restarting") \
+    X(LOG_TRACE,           "#AT:%H")
+
+enum { SCANNER_LOG_FORMATS(BINLOG_FORMAT_ID) LOG_FORMAT_COUNT };
+
+// Arguments for a "%02x:...:%02x" address, most significant byte first
+#define LOG_ADDR_ARGS(a) (a)[5], (a)[4], (a)[3], (a)[2], (a)[1], (a)[0]
+
+#endif // LOG_FORMATS_H
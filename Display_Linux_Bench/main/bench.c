@@ -0,0 +1,328 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <malloc.h>
+#include "display.h"
+#include "display_virtual.h"
+#include "display_widget.h"
+#include "display_console.h"
+#include "display_priv.h"
+#include "display_fb.h"
+#include "display_pfb.h"
+#include "display_perf.h"
+#include "icons.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char *TAG = "DISPLAY_BENCH";
+
+// Same wiring as BLE_Client_with_SPI_LCD; only the bus settings matter here
+static const ili9341_config_t display_config = {
+    .pin_miso = -1,
+    .pin_mosi = 7,
+    .pin_clk = 6,
+    .pin_cs = 10,
+    .pin_dc = 2,
+    .pin_rst = 3,
+    .pin_bckl = 15,
+    .spi_host = SPI2_HOST,
+    .spi_clock_speed_hz = 20 * 1000 * 1000,
+    .spi_clock_max_hz = 80 * 1000 * 1000,
+    .hw_cs = true,
+    .glyph_cache_bytes = 16 * 1024,
+};
+
+static void report(const char *name) {
+    ili9341_bus_stats_t stats;
+    ili9341_get_bus_stats(&stats);
+    printf("%-16s %8lu trans %10llu bytes %6lu gpio %8llu us\n",
+           name,
+           (unsigned long)stats.transactions,
+           (unsigned long long)stats.bytes,
+           (unsigned long)stats.gpio_toggles,
+           (unsigned long long)stats.wire_time_us);
+    ili9341_reset_bus_stats();
+}
+
+// Glyph expansion throughput: the original per-pixel column bit test
+// against the row-major table + lookup kernel, on the same string
+#define KERNEL_ROUNDS 2000
+
+static uint16_t kernel_buf[ILI9341_FONT_WIDTH * 4 * ILI9341_FONT_HEIGHT * 4];
+
+static void expand_column_major(char c, uint8_t scale, uint16_t fg, uint16_t bg) {
+    const uint8_t *bitmap = ili9341_font_glyph(c);
+    uint16_t *p = kernel_buf;
+
+    for (int row = 0; row < 8; row++) {
+        for (int row_repeat = 0; row_repeat < scale; row_repeat++) {
+            for (int col = 0; col < 5; col++) {
+                uint16_t pixel = (bitmap[col] & (1 << row)) ? fg : bg;
+                for (int col_repeat = 0; col_repeat < scale; col_repeat++) {
+                    *p++ = pixel;
+                }
+            }
+        }
+    }
+}
+
+static void expand_row_major(char c, uint8_t scale, const uint32_t pair[4]) {
+    const uint8_t *rows = ili9341_font_rows(c);
+    const size_t width = ILI9341_FONT_WIDTH * scale;
+    uint16_t *p = kernel_buf;
+
+    for (int row = 0; row < 8; row++) {
+        ili9341_font_expand_row(p, rows[row], ILI9341_FONT_WIDTH, scale, pair);
+        for (int row_repeat = 1; row_repeat < scale; row_repeat++) {
+            memcpy(p + row_repeat * width, p, width * 2);
+        }
+        p += width * scale;
+    }
+}
+
+static void bench_glyph_kernel(void) {
+    const char *text = "WARNING ALCOHOL DETECTED Looking for helmet 0123456789";
+    uint32_t pair[4];
+    ili9341_font_pair_lut(pair, ili9341_swap16(ILI9341_WHITE), 0);
+
+    for (uint8_t scale = 1; scale <= 4; scale++) {
+        size_t pixels = 0;
+        int64_t t0 = esp_timer_get_time();
+        for (int r = 0; r < KERNEL_ROUNDS; r++) {
+            for (const char *c = text; *c; c++) {
+                expand_column_major(*c, scale, ili9341_swap16(ILI9341_WHITE), 0);
+                pixels += ILI9341_FONT_WIDTH * ILI9341_FONT_HEIGHT * scale * scale;
+            }
+        }
+        int64_t t1 = esp_timer_get_time();
+        for (int r = 0; r < KERNEL_ROUNDS; r++) {
+            for (const char *c = text; *c; c++) {
+                expand_row_major(*c, scale, pair);
+            }
+        }
+        int64_t t2 = esp_timer_get_time();
+
+        printf("glyph x%u         %8.1f Mpix/s loop %8.1f Mpix/s table\n", scale,
+               (double)pixels / (t1 - t0 > 0 ? t1 - t0 : 1),
+               (double)pixels / (t2 - t1 > 0 ? t2 - t1 : 1));
+    }
+}
+
+// Wiring the modelled board can carry; calibration should settle on it
+#define BENCH_BUS_LIMIT_HZ (40 * 1000 * 1000)
+
+void app_main(void) {
+    ili9341_virtual_set_bus_limit(BENCH_BUS_LIMIT_HZ);
+    esp_err_t ret = ili9341_init(&display_config);
+    ili9341_virtual_set_bus_limit(0);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Display init failed");
+        exit(1);
+    }
+    report("init");
+
+    ili9341_boot_timing_t boot;
+    ili9341_get_boot_timing(&boot);
+    printf("%-16s %8lld reset %8lld config %8lld calib %8lld clear %8lld total us\n", "boot",
+           (long long)boot.reset_us, (long long)boot.config_us, (long long)boot.calib_us,
+           (long long)boot.clear_us, (long long)boot.total_us);
+    printf("%-16s %8s %dx%d, %d bytes/pixel\n", "panel", ILI9341_PANEL_NAME,
+           ILI9341_WIDTH, ILI9341_HEIGHT, ILI9341_PANEL_BPP);
+    printf("%-16s %8d kHz (limit %d kHz)\n", "spi_clock",
+           ili9341_get_spi_clock() / 1000, BENCH_BUS_LIMIT_HZ / 1000);
+
+    ili9341_fill(ILI9341_BLUE);
+    report("fill");
+
+    ili9341_text_small("Small text 0123456789", 10, 10, ILI9341_WHITE);
+    report("text_small");
+
+    ili9341_text_medium("Medium text", 10, 40, ILI9341_YELLOW);
+    report("text_medium");
+
+    ili9341_text_large("Large", 10, 80, ILI9341_GREEN);
+    report("text_large");
+
+    ili9341_text_xlarge("XL", 10, 140, ILI9341_RED);
+    report("text_xlarge");
+
+    // Status screens repeat: the second pass is served from the glyph cache
+    ili9341_glyph_cache_stats_t cache;
+    for (int pass = 0; pass < 2; pass++) {
+        ili9341_glyph_cache_reset_stats();
+        ili9341_text_medium("Looking for helmet", 30, 180, ILI9341_WHITE);
+        ili9341_text_small("WARNING ALCOHOL DETECTED", 40, 210, ILI9341_RED);
+        report(pass == 0 ? "status_cold" : "status_warm");
+        ili9341_glyph_cache_get_stats(&cache);
+        printf("%-16s %8lu hits %8lu misses %6u entries %6u bytes\n", "glyph_cache",
+               (unsigned long)cache.hits, (unsigned long)cache.misses,
+               (unsigned)cache.entries, (unsigned)cache.bytes_used);
+    }
+
+    // Replacing a line in place: one windowed burst each, no clear needed
+    ili9341_text_bg("Connected         ", 30, 180, ILI9341_GREEN, ILI9341_BLACK, 2);
+    report("text_bg_replace");
+
+    ili9341_fill_rect(40, 210, 24 * 6, 8, ILI9341_BLACK);
+    report("fill_rect_clear");
+
+    // Live reading at 10+ Hz: each update resends only the digits that changed
+    ili9341_value_t reading;
+    ili9341_bar_t level;
+    ili9341_value_init(&reading, 260, 220, 3, ILI9341_CYAN, ILI9341_BLACK, 2);
+    ili9341_bar_init(&level, 40, 225, 200, 8, 0, 255, ILI9341_CYAN, ILI9341_BLACK);
+    ili9341_value_set(&reading, 42);
+    ili9341_bar_set(&level, 42);
+    report("widget_first");
+    for (int v = 43; v < 53; v++) {
+        ili9341_value_set(&reading, v);
+        ili9341_bar_set(&level, v);
+    }
+    report("widget_10_upd");
+
+    // Clipped and aligned text: only the pixels inside the clip go out
+    const ili9341_rect_t panel = { 200, 10, 100, 40 };
+    ili9341_set_clip(&panel);
+    ili9341_text_bg_aligned("Clipped panel text", 250, 14, ILI9341_ALIGN_CENTER,
+                            ILI9341_WHITE, ILI9341_MAGENTA, 2);
+    ili9341_text_aligned("right", 300, 36, ILI9341_ALIGN_RIGHT, ILI9341_YELLOW, 1);
+    report("text_clipped");
+    ili9341_text_medium("Outside the clip", 10, 200, ILI9341_WHITE);
+    report("text_offclip");
+    ili9341_set_clip(NULL);
+
+    // Icons: decoded from flash straight into the DMA buffers. heap_delta
+    // shows nothing is allocated while drawing.
+    const ili9341_image_t *icons[] = { &image_helmet, &image_alcohol_warning };
+    const char *icon_names[] = { "image_helmet", "image_warning" };
+    for (int i = 0; i < 2; i++) {
+        size_t heap_before = mallinfo2().uordblks;
+        int64_t t0 = esp_timer_get_time();
+        ili9341_draw_image(icons[i], 60 + i * 50, 60);
+        int64_t cpu_us = esp_timer_get_time() - t0;
+        long heap_delta = (long)(mallinfo2().uordblks - heap_before);
+        report(icon_names[i]);
+        printf("%-16s %8lld cpu us %6ld heap_delta %6lu encoded %6u raw bytes\n", "",
+               (long long)cpu_us, heap_delta,
+               (unsigned long)(icons[i]->data_len + icons[i]->palette_len * 2),
+               (unsigned)(icons[i]->width * icons[i]->height * 2));
+    }
+
+    // Reference image for spotting rendering regressions
+    const char *path = getenv("DISPLAY_BENCH_PPM");
+    if (path == NULL) {
+        path = "display_bench.ppm";
+    }
+    if (ili9341_virtual_dump_ppm(path) == ESP_OK) {
+        ESP_LOGI(TAG, "Wrote %s", path);
+    }
+
+    // Through the strip renderer, as the render task draws them
+    ili9341_fb_init(40);
+    ili9341_fb_begin();
+    ili9341_fb_fill(ILI9341_BLACK);
+    ili9341_fb_image(&image_helmet, 140, 70);
+    ili9341_fb_flush();
+    ili9341_reset_bus_stats();
+    ili9341_fb_begin();
+    ili9341_fb_fill(ILI9341_BLACK);
+    ili9341_fb_image(&image_helmet, 140, 70);
+    ili9341_fb_image(&image_alcohol_warning, 140, 150);
+    ili9341_fb_flush();
+    report("fb_image_add");
+    ili9341_fb_deinit();
+
+    // Full-frame flush: 4-bpp and 2-bpp palette framebuffers against
+    // streaming a full RGB565 frame from RAM
+    uint16_t *frame565 = malloc((size_t)ILI9341_WIDTH * ILI9341_HEIGHT * sizeof(uint16_t));
+    for (size_t i = 0; i < (size_t)ILI9341_WIDTH * ILI9341_HEIGHT; i++) {
+        frame565[i] = (i & 8) ? ILI9341_WHITE : ILI9341_BLUE;
+    }
+    int64_t t0 = esp_timer_get_time();
+    ili9341_draw_bitmap(0, 0, ILI9341_WIDTH, ILI9341_HEIGHT, frame565);
+    int64_t direct_us = esp_timer_get_time() - t0;
+    report("frame_rgb565");
+    printf("%-16s %8lld cpu us %6u KB buffer\n", "", (long long)direct_us,
+           (unsigned)(ILI9341_WIDTH * ILI9341_HEIGHT * 2 / 1024));
+    free(frame565);
+
+    static const uint8_t depths[] = { 4, 2 };
+    for (int i = 0; i < 2; i++) {
+        ili9341_pfb_init(depths[i]);
+        ili9341_pfb_clear(ili9341_pfb_index(ILI9341_BLUE));
+        ili9341_pfb_text("Palette framebuffer", 10, 100, ili9341_pfb_index(ILI9341_WHITE), 2);
+        t0 = esp_timer_get_time();
+        ili9341_pfb_flush();
+        int64_t flush_us = esp_timer_get_time() - t0;
+        report(depths[i] == 4 ? "frame_pfb4" : "frame_pfb2");
+        printf("%-16s %8lld cpu us %6u KB buffer\n", "", (long long)flush_us,
+               (unsigned)(ILI9341_WIDTH * ILI9341_HEIGHT * depths[i] / 8 / 1024));
+
+        // Small change: only its bounding box goes out
+        ili9341_pfb_fill_rect(10, 100, 60, 16, ili9341_pfb_index(ILI9341_BLUE));
+        ili9341_pfb_text("Label", 10, 100, ili9341_pfb_index(ILI9341_GREEN), 2);
+        ili9341_pfb_flush();
+        report(depths[i] == 4 ? "pfb4_update" : "pfb2_update");
+        ili9341_pfb_deinit();
+    }
+
+    // Power modes: commands sent, and time until the image is back
+    ili9341_fill(ILI9341_BLACK);
+    ili9341_text_aligned("Looking for helmet", ILI9341_WIDTH / 2, 120, ILI9341_ALIGN_CENTER,
+                         ILI9341_YELLOW, 2);
+    ili9341_reset_bus_stats();
+    uint16_t status_w = ili9341_text_measure("Looking for helmet", 2);
+    ili9341_rect_t status = { ILI9341_WIDTH / 2 - status_w / 2, 120, status_w, 16 };
+    ili9341_set_power_mode(ILI9341_POWER_IDLE | ILI9341_POWER_PARTIAL, &status);
+    ili9341_set_backlight_level(20);
+    report("power_save");
+    printf("%-16s %8u backlight %s edge %s text\n", "",
+           ili9341_virtual_get_backlight(),
+           ili9341_virtual_get_pixel(0, 120) == 0 &&
+           ili9341_virtual_get_pixel(ILI9341_WIDTH - 1, 120) == 0 ? "blank" : "LIT",
+           ili9341_virtual_get_pixel(status.x + 1, 121) == ILI9341_YELLOW ? "shown" : "MISSING");
+
+    ili9341_set_backlight_level(100);
+    ili9341_set_power_mode(ILI9341_POWER_NORMAL, NULL);
+    report("resume_idle");
+    printf("%-16s %8lu us to visible\n", "", (unsigned long)ili9341_get_resume_us());
+
+    ili9341_set_power_mode(ILI9341_POWER_SLEEP, NULL);
+    report("sleep");
+    vTaskDelay(pdMS_TO_TICKS(200));
+    ili9341_set_power_mode(ILI9341_POWER_NORMAL, NULL);
+    report("resume_sleep");
+    printf("%-16s %8lu us to visible %8lu timing violations\n", "",
+           (unsigned long)ili9341_get_resume_us(),
+           (unsigned long)ili9341_virtual_get_timing_violations());
+
+    // Console: once full, every line is one row burst plus a scroll write
+    ili9341_console_start(ILI9341_BLACK);
+    report("console_start");
+    char line[48];
+    for (int i = 0; i < ILI9341_CONSOLE_ROWS + 5; i++) {
+        snprintf(line, sizeof(line), "log line %d", i);
+        ili9341_console_print(line, ILI9341_GREEN);
+        if (i == ILI9341_CONSOLE_ROWS + 3) {
+            ili9341_reset_bus_stats();
+        }
+    }
+    report("console_line");
+
+    const char *console_path = getenv("DISPLAY_BENCH_CONSOLE_PPM");
+    if (console_path == NULL) {
+        console_path = "display_bench_console.ppm";
+    }
+    ili9341_virtual_dump_ppm(console_path);
+    ili9341_console_stop(ILI9341_BLACK);
+
+    bench_glyph_kernel();
+
+    // Per-primitive totals for the whole run (sdkconfig.defaults enables them)
+    ili9341_perf_dump();
+
+    ili9341_deinit();
+    exit(0);
+}
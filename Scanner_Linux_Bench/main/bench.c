@@ -0,0 +1,653 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "device_table.h"
+#include "adv_data.h"
+#include "scan_policy.h"
+#include "esp_timer.h"
+
+// Synthetic advertising traffic through the scanner's device table, and
+// through a plain array searched front to back for comparison; then the
+// advertising data extractors on recorded payloads, and a model of how
+// long a new advertiser goes unnoticed under each scan policy
+#define BENCH_REPORTS   2000000
+#define REPORTS_PER_MS  10          // 10k reports/s of simulated time
+
+static device_table_t table;
+
+static uint32_t rng_state = 0x12345678;
+
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static void random_addr(uint8_t addr[6]) {
+    uint32_t a = rng();
+    uint32_t b = rng();
+    memcpy(addr, &a, 4);
+    memcpy(addr + 4, &b, 2);
+}
+
+// ==== Linear Baseline ====
+static device_entry_t linear[DEVICE_TABLE_MAX_ENTRIES];
+static size_t linear_count;
+
+static device_entry_t *linear_update(const uint8_t addr[6], int8_t rssi, uint32_t now_ms) {
+    for (size_t i = 0; i < linear_count; i++) {
+        if (memcmp(linear[i].addr, addr, 6) == 0) {
+            linear[i].rssi_avg_q4 += (rssi * 16 - linear[i].rssi_avg_q4) / (1 << DEVICE_TABLE_RSSI_SHIFT);
+            linear[i].last_seen_ms = now_ms;
+            linear[i].count++;
+            return &linear[i];
+        }
+    }
+    if (linear_count == DEVICE_TABLE_MAX_ENTRIES) {
+        return NULL;
+    }
+    device_entry_t *e = &linear[linear_count++];
+    memcpy(e->addr, addr, 6);
+    e->rssi_avg_q4 = rssi * 16;
+    e->last_seen_ms = now_ms;
+    e->count = 1;
+    return e;
+}
+
+// ==== Steady Population ====
+static double rate(int64_t us) {
+    return (double)BENCH_REPORTS / (us > 0 ? us : 1);
+}
+
+static void bench_steady(size_t devices) {
+    static uint8_t addrs[DEVICE_TABLE_MAX_ENTRIES][6];
+    static uint16_t order[BENCH_REPORTS];
+    static int8_t rssi[BENCH_REPORTS];
+
+    for (size_t i = 0; i < devices; i++) {
+        random_addr(addrs[i]);
+    }
+    for (size_t i = 0; i < BENCH_REPORTS; i++) {
+        order[i] = rng() % devices;
+        rssi[i] = -40 - (int8_t)(rng() % 60);
+    }
+
+    device_table_init(&table);
+    int64_t t0 = esp_timer_get_time();
+    for (size_t i = 0; i < BENCH_REPORTS; i++) {
+        device_table_update(&table, addrs[order[i]], 1, rssi[i], i / REPORTS_PER_MS);
+    }
+    int64_t t1 = esp_timer_get_time();
+
+    linear_count = 0;
+    for (size_t i = 0; i < BENCH_REPORTS; i++) {
+        linear_update(addrs[order[i]], rssi[i], i / REPORTS_PER_MS);
+    }
+    int64_t t2 = esp_timer_get_time();
+
+    size_t missing = 0;
+    for (size_t i = 0; i < devices; i++) {
+        missing += (device_table_find(&table, addrs[i]) == NULL);
+    }
+
+    printf("steady %4u dev  %8.2f Mrep/s table %8.2f Mrep/s linear  %u entries %u missing\n",
+           (unsigned)devices, rate(t1 - t0), rate(t2 - t1), (unsigned)table.entries,
+           (unsigned)missing);
+}
+
+// ==== Address Churn ====
+// Phones rotate their random address every few minutes, so a car park
+// keeps producing devices that are never heard again. Each report comes
+// from one of a fixed number of advertisers, a few of which rotate;
+// expiry runs on the scanner's summary period.
+#define CHURN_ADVERTISERS  300
+#define CHURN_ROTATE_PPM   200      // Chance per report of a new address
+#define CHURN_SUMMARY_MS   5000
+#define CHURN_MAX_AGE_MS   10000
+
+static void bench_churn(void) {
+    static uint8_t addrs[CHURN_ADVERTISERS][6];
+    size_t expired = 0;
+    size_t peak = 0;
+    uint32_t next_summary = CHURN_SUMMARY_MS;
+
+    for (size_t i = 0; i < CHURN_ADVERTISERS; i++) {
+        random_addr(addrs[i]);
+    }
+
+    device_table_init(&table);
+    int64_t t0 = esp_timer_get_time();
+    for (size_t i = 0; i < BENCH_REPORTS; i++) {
+        uint32_t now = i / REPORTS_PER_MS;
+        size_t k = rng() % CHURN_ADVERTISERS;
+        if (rng() % 1000000 < CHURN_ROTATE_PPM) {
+            random_addr(addrs[k]);
+        }
+        device_table_update(&table, addrs[k], 1, -60, now);
+
+        if (table.entries > peak) {
+            peak = table.entries;
+        }
+        if (now >= next_summary) {
+            expired += device_table_expire(&table, now, CHURN_MAX_AGE_MS);
+            next_summary += CHURN_SUMMARY_MS;
+        }
+    }
+    int64_t t1 = esp_timer_get_time();
+
+    printf("churn  %4u adv  %8.2f Mrep/s table  %u entries %u peak %u expired %lu dropped\n",
+           CHURN_ADVERTISERS, rate(t1 - t0), (unsigned)table.entries, (unsigned)peak,
+           (unsigned)expired, (unsigned long)table.dropped);
+}
+
+// ==== Advertising Data ====
+// Recorded payloads of common advertisers, parsed by the lazy extractors
+// and by a full decode
+#define ADV_ROUNDS 200000
+
+typedef struct {
+    uint8_t len;
+    uint8_t data[31];
+} adv_payload_t;
+
+#define PAYLOAD(...) { sizeof((uint8_t[]) { __VA_ARGS__ }), { __VA_ARGS__ } }
+
+static const adv_payload_t payloads[] = {
+    // iBeacon
+    PAYLOAD(0x02, 0x01, 0x06, 0x1a, 0xff, 0x4c, 0x00, 0x02, 0x15, 0xe2, 0xc5, 0x6d,
+            0xb5, 0xdf, 0xfb, 0x48, 0xd2, 0xb0, 0x60, 0xd0, 0xf5, 0xa7, 0x10, 0x96,
+            0xe0, 0x00, 0x01, 0x00, 0x02, 0xc5),
+    // Eddystone-URL
+    PAYLOAD(0x02, 0x01, 0x06, 0x03, 0x03, 0xaa, 0xfe, 0x0e, 0x16, 0xaa, 0xfe, 0x10,
+            0xeb, 0x03, 0x65, 0x78, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x07),
+    // Apple continuity
+    PAYLOAD(0x02, 0x01, 0x1a, 0x0a, 0xff, 0x4c, 0x00, 0x10, 0x05, 0x01, 0x1c, 0x5a,
+            0x3b, 0x2e),
+    // Helmet advertisement
+    PAYLOAD(0x02, 0x01, 0x06, 0x05, 0x03, 0x0f, 0x18, 0x0a, 0x18, 0x02, 0x0a, 0x04,
+            0x0d, 0x09, 0x52, 0x69, 0x64, 0x65, 0x72, 0x20, 0x48, 0x65, 0x6c, 0x6d,
+            0x65, 0x74),
+    // NUS scan response
+    PAYLOAD(0x11, 0x07, 0x9e, 0xca, 0xdc, 0x24, 0x0e, 0xe5, 0xa9, 0xe0, 0x93, 0xf3,
+            0xa3, 0xb5, 0x01, 0x00, 0x40, 0x6e, 0x0b, 0x09, 0x45, 0x53, 0x50, 0x33,
+            0x32, 0x2d, 0x4e, 0x6f, 0x64, 0x65),
+    // Swift Pair
+    PAYLOAD(0x02, 0x01, 0x1a, 0x13, 0xff, 0x06, 0x00, 0x03, 0x00, 0x80, 0x53, 0x75,
+            0x72, 0x66, 0x61, 0x63, 0x65, 0x20, 0x4d, 0x6f, 0x75, 0x73, 0x65),
+    // Fast Pair
+    PAYLOAD(0x03, 0x03, 0x2c, 0xfe, 0x06, 0x16, 0x2c, 0xfe, 0x00, 0x00, 0x0a, 0x02,
+            0x0a, 0xf4),
+    // Heart rate strap
+    PAYLOAD(0x02, 0x01, 0x06, 0x03, 0x02, 0x0d, 0x18, 0x03, 0x19, 0x41, 0x03, 0x04,
+            0x08, 0x48, 0x52, 0x4d),
+};
+
+#define PAYLOAD_COUNT (sizeof(payloads) / sizeof(payloads[0]))
+
+// Stand-in for ble_hs_adv_parse_fields(), as NimBLE's host doesn't build
+// for the Linux target. Same shape of work: clear a fields struct of the
+// same layout, then decode every structure (UUID lists into UUID objects,
+// tx power, service and manufacturer data) before the caller looks at
+// the one field it wants.
+typedef struct {
+    uint8_t type;
+    uint8_t value[16];
+} full_uuid_t;
+
+typedef struct {
+    uint8_t flags;
+    const full_uuid_t *uuids16;
+    uint8_t num_uuids16;
+    bool uuids16_is_complete;
+    const full_uuid_t *uuids32;
+    uint8_t num_uuids32;
+    bool uuids32_is_complete;
+    const full_uuid_t *uuids128;
+    uint8_t num_uuids128;
+    bool uuids128_is_complete;
+    const uint8_t *name;
+    uint8_t name_len;
+    bool name_is_complete;
+    int8_t tx_pwr_lvl;
+    bool tx_pwr_lvl_is_present;
+    const uint8_t *slave_itvl_range;
+    const uint8_t *svc_data_uuid16;
+    uint8_t svc_data_uuid16_len;
+    uint16_t appearance;
+    bool appearance_is_present;
+    const uint8_t *uri;
+    uint8_t uri_len;
+    const uint8_t *mfg_data;
+    uint8_t mfg_data_len;
+} full_fields_t;
+
+static full_uuid_t full_uuids16[16];
+static full_uuid_t full_uuids32[8];
+static full_uuid_t full_uuids128[2];
+
+static int full_uuids(full_uuid_t *out, int max, uint8_t *num, const uint8_t *p, uint8_t len,
+                      uint8_t size) {
+    if (len % size != 0 || len / size > max) {
+        return -1;
+    }
+    *num = 0;
+    for (int i = 0; i < len; i += size) {
+        full_uuid_t *u = &out[(*num)++];
+        memset(u, 0, sizeof(*u));
+        u->type = size * 8;
+        memcpy(u->value, &p[i], size);
+    }
+    return 0;
+}
+
+static int full_parse(full_fields_t *f, const uint8_t *data, uint8_t len) {
+    memset(f, 0, sizeof(*f));
+
+    while (len > 0) {
+        if (data[0] == 0 || data[0] + 1 > len) {
+            return -1;
+        }
+        uint8_t type = data[1];
+        const uint8_t *v = &data[2];
+        uint8_t vlen = data[0] - 1;
+        int rc = 0;
+
+        switch (type) {
+        case ADV_DATA_TYPE_FLAGS:
+            f->flags = vlen ? v[0] : 0;
+            break;
+        case ADV_DATA_TYPE_UUID16_INCOMP:
+        case ADV_DATA_TYPE_UUID16_COMP:
+            rc = full_uuids(full_uuids16, 16, &f->num_uuids16, v, vlen, 2);
+            f->uuids16 = full_uuids16;
+            f->uuids16_is_complete = (type == ADV_DATA_TYPE_UUID16_COMP);
+            break;
+        case ADV_DATA_TYPE_UUID32_INCOMP:
+        case ADV_DATA_TYPE_UUID32_COMP:
+            rc = full_uuids(full_uuids32, 8, &f->num_uuids32, v, vlen, 4);
+            f->uuids32 = full_uuids32;
+            f->uuids32_is_complete = (type == ADV_DATA_TYPE_UUID32_COMP);
+            break;
+        case ADV_DATA_TYPE_UUID128_INCOMP:
+        case ADV_DATA_TYPE_UUID128_COMP:
+            rc = full_uuids(full_uuids128, 2, &f->num_uuids128, v, vlen, 16);
+            f->uuids128 = full_uuids128;
+            f->uuids128_is_complete = (type == ADV_DATA_TYPE_UUID128_COMP);
+            break;
+        case ADV_DATA_TYPE_NAME_SHORT:
+        case ADV_DATA_TYPE_NAME_COMPLETE:
+            f->name = v;
+            f->name_len = vlen;
+            f->name_is_complete = (type == ADV_DATA_TYPE_NAME_COMPLETE);
+            break;
+        case ADV_DATA_TYPE_TX_POWER:
+            f->tx_pwr_lvl = vlen ? (int8_t)v[0] : 0;
+            f->tx_pwr_lvl_is_present = true;
+            break;
+        case 0x12: // Peripheral connection interval range
+            f->slave_itvl_range = v;
+            break;
+        case ADV_DATA_TYPE_SVC_DATA16:
+            f->svc_data_uuid16 = v;
+            f->svc_data_uuid16_len = vlen;
+            break;
+        case 0x19: // Appearance
+            f->appearance = (vlen >= 2) ? (v[0] | (v[1] << 8)) : 0;
+            f->appearance_is_present = true;
+            break;
+        case 0x24: // URI
+            f->uri = v;
+            f->uri_len = vlen;
+            break;
+        case ADV_DATA_TYPE_MFG_DATA:
+            f->mfg_data = v;
+            f->mfg_data_len = vlen;
+            break;
+        default:
+            break;
+        }
+        if (rc != 0) {
+            return rc;
+        }
+        len -= data[0] + 1;
+        data += data[0] + 1;
+    }
+    return 0;
+}
+
+static bool full_has_uuid16(const full_fields_t *f, uint16_t uuid) {
+    for (int i = 0; i < f->num_uuids16; i++) {
+        if ((f->uuids16[i].value[0] | (f->uuids16[i].value[1] << 8)) == uuid) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static double ns_per_report(int64_t us) {
+    return (double)us * 1000 / ((double)ADV_ROUNDS * PAYLOAD_COUNT);
+}
+
+static void adv_report(const char *what, int64_t full_us, int64_t lazy_us) {
+    printf("adv %-12s %8.1f ns full %8.1f ns lazy %6.1fx\n", what, ns_per_report(full_us),
+           ns_per_report(lazy_us), (double)full_us / (lazy_us > 0 ? lazy_us : 1));
+}
+
+static void bench_adv_data(void) {
+    full_fields_t f;
+    const uint8_t *name;
+    uint8_t name_len;
+    uint16_t company;
+    adv_field_t mfg;
+    volatile size_t sink = 0;
+    size_t mismatches = 0;
+
+    // Both must agree before their speed means anything
+    for (size_t i = 0; i < PAYLOAD_COUNT; i++) {
+        const adv_payload_t *pl = &payloads[i];
+        full_parse(&f, pl->data, pl->len);
+        bool has_name = adv_data_name(pl->data, pl->len, &name, &name_len);
+        mismatches += (has_name != (f.name != NULL)) ||
+                      (has_name && (name != f.name || name_len != f.name_len));
+        bool has_mfg = adv_data_mfg(pl->data, pl->len, &company, &mfg);
+        mismatches += has_mfg != (f.mfg_data != NULL && f.mfg_data_len >= 2);
+        mismatches += adv_data_has_uuid16(pl->data, pl->len, 0x180F) != full_has_uuid16(&f, 0x180F);
+    }
+
+    int64_t t0 = esp_timer_get_time();
+    for (int r = 0; r < ADV_ROUNDS; r++) {
+        for (size_t i = 0; i < PAYLOAD_COUNT; i++) {
+            if (full_parse(&f, payloads[i].data, payloads[i].len) == 0 && f.name != NULL) {
+                sink += f.name_len;
+            }
+        }
+    }
+    int64_t t1 = esp_timer_get_time();
+    for (int r = 0; r < ADV_ROUNDS; r++) {
+        for (size_t i = 0; i < PAYLOAD_COUNT; i++) {
+            if (adv_data_name(payloads[i].data, payloads[i].len, &name, &name_len)) {
+                sink += name_len;
+            }
+        }
+    }
+    int64_t t2 = esp_timer_get_time();
+    adv_report("name", t1 - t0, t2 - t1);
+
+    t0 = esp_timer_get_time();
+    for (int r = 0; r < ADV_ROUNDS; r++) {
+        for (size_t i = 0; i < PAYLOAD_COUNT; i++) {
+            if (full_parse(&f, payloads[i].data, payloads[i].len) == 0 && f.mfg_data_len >= 2) {
+                sink += f.mfg_data[0];
+            }
+        }
+    }
+    t1 = esp_timer_get_time();
+    for (int r = 0; r < ADV_ROUNDS; r++) {
+        for (size_t i = 0; i < PAYLOAD_COUNT; i++) {
+            if (adv_data_mfg(payloads[i].data, payloads[i].len, &company, NULL)) {
+                sink += company & 0xFF;
+            }
+        }
+    }
+    t2 = esp_timer_get_time();
+    adv_report("mfg_data", t1 - t0, t2 - t1);
+
+    t0 = esp_timer_get_time();
+    for (int r = 0; r < ADV_ROUNDS; r++) {
+        for (size_t i = 0; i < PAYLOAD_COUNT; i++) {
+            if (full_parse(&f, payloads[i].data, payloads[i].len) == 0) {
+                sink += full_has_uuid16(&f, 0x180F);
+            }
+        }
+    }
+    t1 = esp_timer_get_time();
+    for (int r = 0; r < ADV_ROUNDS; r++) {
+        for (size_t i = 0; i < PAYLOAD_COUNT; i++) {
+            sink += adv_data_has_uuid16(payloads[i].data, payloads[i].len, 0x180F);
+        }
+    }
+    t2 = esp_timer_get_time();
+    adv_report("uuid16", t1 - t0, t2 - t1);
+
+    printf("adv %u payloads, %u mismatches\n", (unsigned)PAYLOAD_COUNT, (unsigned)mismatches);
+}
+
+// ==== Detection Latency ====
+// Time from a helmet powering up to the scanner's first report of it.
+// The helmet advertises every ADV_ITVL_US plus the random 0-10 ms
+// advDelay, on channels 37, 38 and 39 in turn. The scanner listens for
+// window_us of every itvl_us, moving to the next channel each interval
+// and starting again at 37 with each scan. A packet is heard if all of
+// it falls inside a window on its channel.
+#define ADV_ITVL_US        100000
+#define ADV_DELAY_MAX_US   10000
+#define ADV_PACKET_US      376      // 31-byte ADV_IND at 1 Mbit/s
+#define ADV_CHANNEL_GAP_US 500      // Start of one channel's packet to the next
+#define DETECT_TRIALS      20000
+#define DETECT_SPAN_US     10000000 // Power-up times spread over this
+
+typedef struct {
+    const char *name;
+    uint32_t itvl_us;
+    uint32_t window_us;
+    uint32_t scan_us;               // Length of one scan, 0 = continuous
+    uint32_t gap_us;                // Pause before the next scan
+} scan_model_t;
+
+static const scan_model_t scan_models[] = {
+    // 3 s scans, 2 s vTaskDelay in DISC_COMPLETE before the next one
+    { "3s/2s cycle", 60000, 30000, 3000000, 2000000 },
+    { "continuous", 60000, 30000, 0, 0 },
+};
+
+static bool scan_hears(const scan_model_t *m, uint64_t t, int channel) {
+    if (m->scan_us > 0) {
+        t %= m->scan_us + m->gap_us;
+        if (t + ADV_PACKET_US > m->scan_us) {
+            return false;
+        }
+    }
+    uint64_t phase = t % m->itvl_us;
+    return (t / m->itvl_us) % 3 == (uint64_t)channel &&
+           phase + ADV_PACKET_US <= m->window_us;
+}
+
+static uint32_t first_detection_us(const scan_model_t *m, uint64_t power_up) {
+    uint64_t t = power_up;
+
+    for (;;) {
+        for (int ch = 0; ch < 3; ch++) {
+            uint64_t packet = t + ch * ADV_CHANNEL_GAP_US;
+            if (scan_hears(m, packet, ch)) {
+                return packet + ADV_PACKET_US - power_up;
+            }
+        }
+        t += ADV_ITVL_US + rng() % ADV_DELAY_MAX_US;
+    }
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void bench_detection(void) {
+    static uint32_t latency[DETECT_TRIALS];
+
+    for (size_t i = 0; i < sizeof(scan_models) / sizeof(scan_models[0]); i++) {
+        const scan_model_t *m = &scan_models[i];
+        for (int k = 0; k < DETECT_TRIALS; k++) {
+            latency[k] = first_detection_us(m, rng() % DETECT_SPAN_US);
+        }
+        qsort(latency, DETECT_TRIALS, sizeof(latency[0]), cmp_u32);
+        printf("detect %-12s %7.1f p50 %7.1f p90 %7.1f p99 %7.1f max ms\n", m->name,
+               latency[DETECT_TRIALS / 2] / 1000.0, latency[DETECT_TRIALS * 9 / 10] / 1000.0,
+               latency[DETECT_TRIALS * 99 / 100] / 1000.0, latency[DETECT_TRIALS - 1] / 1000.0);
+    }
+}
+
+// ==== Scan Policy Simulation ====
+// A search starts when the helmet goes away, and it powers up again at a
+// random time within POLICY_SPAN_MS. Every POLICY_STEP_MS the policy is
+// shown the reports heard and sets the parameters for the next step, as
+// the client's policy timer does; a change restarts the scan. Other
+// advertisers send BG_RPS reports per second of listening. With the
+// arrival cue, people arriving with the rider add CUE_RPS from
+// CUE_LEAD_MS before the helmet powers up. Energy counts the receiver
+// only, at SIM_RX_MA while listening.
+#define POLICY_TRIALS  2000
+#define POLICY_STEP_MS 1000
+#define POLICY_SPAN_MS 600000
+#define BG_RPS         30
+#define CUE_RPS        60
+#define CUE_LEAD_MS    15000
+#define SIM_RX_MA      75
+
+enum { POLICY_FIXED_50, POLICY_FIXED_100, POLICY_ADAPTIVE, POLICY_ADAPTIVE_DEEP, POLICY_COUNT };
+
+static const char *policy_labels[POLICY_COUNT] = {
+    "fixed 50%", "fixed 100%", "adaptive", "adaptive deep"
+};
+
+typedef struct {
+    uint32_t latency_ms;
+    uint64_t listen_ms;
+    uint64_t search_ms;
+} policy_trial_t;
+
+static void policy_init(int which, scan_policy_t *policy) {
+    static scan_params_t fixed;
+    static scan_adaptive_t adaptive;
+    static const scan_adaptive_config_t config = SCAN_ADAPTIVE_DEFAULT_CONFIG;
+    static const scan_adaptive_config_t deep = SCAN_ADAPTIVE_DEEP_CONFIG;
+
+    switch (which) {
+    case POLICY_FIXED_50:
+        scan_policy_fixed_init(policy, &fixed, 0x60, 0x30);
+        break;
+    case POLICY_FIXED_100:
+        scan_policy_fixed_init(policy, &fixed, 0x30, 0x30);
+        break;
+    case POLICY_ADAPTIVE:
+        scan_policy_adaptive_init(policy, &adaptive, &config);
+        break;
+    default:
+        scan_policy_adaptive_init(policy, &adaptive, &deep);
+        break;
+    }
+}
+
+static bool sim_hears(const scan_params_t *p, uint64_t restart_us, uint64_t t, int channel) {
+    uint64_t itvl = SCAN_UNITS_TO_US(p->itvl);
+    uint64_t rel = t - restart_us;
+    return p->enabled && (rel / itvl) % 3 == (uint64_t)channel &&
+           rel % itvl + ADV_PACKET_US <= SCAN_UNITS_TO_US(p->window);
+}
+
+static policy_trial_t sim_search(const scan_policy_t *policy, uint32_t power_up_ms, bool cue) {
+    policy_trial_t r = { 0 };
+    scan_observation_t obs = { 0 };
+    scan_params_t params;
+    uint64_t restart_us = 0;
+    uint64_t adv_us = (uint64_t)power_up_ms * 1000;
+
+    policy->reset(policy->ctx, 0);
+    policy->decide(policy->ctx, &obs, &params);
+
+    for (uint32_t now = 0;; now += POLICY_STEP_MS) {
+        uint64_t end_us = (uint64_t)(now + POLICY_STEP_MS) * 1000;
+
+        // The helmet's advertising events in this step
+        for (; adv_us < end_us; adv_us += ADV_ITVL_US + rng() % ADV_DELAY_MAX_US) {
+            for (int ch = 0; ch < 3; ch++) {
+                uint64_t packet = adv_us + ch * ADV_CHANNEL_GAP_US;
+                if (sim_hears(&params, restart_us, packet, ch)) {
+                    uint32_t found_ms = (packet + ADV_PACKET_US) / 1000;
+                    r.latency_ms = found_ms - power_up_ms;
+                    r.listen_ms += scan_params_listen_ms(&params, found_ms - now);
+                    r.search_ms = found_ms;
+                    return r;
+                }
+            }
+        }
+
+        uint32_t listen = scan_params_listen_ms(&params, POLICY_STEP_MS);
+        uint32_t rps = BG_RPS + ((cue && now + CUE_LEAD_MS >= power_up_ms) ? CUE_RPS : 0);
+        r.listen_ms += listen;
+        obs = (scan_observation_t) {
+            .now_ms = now + POLICY_STEP_MS,
+            .reports = rps * listen / 1000,
+            .listen_ms = listen,
+        };
+
+        scan_params_t next;
+        policy->decide(policy->ctx, &obs, &next);
+        if (next.enabled != params.enabled || next.itvl != params.itvl ||
+            next.window != params.window) {
+            params = next;
+            restart_us = end_us;
+        }
+    }
+}
+
+static void bench_scan_policies(void) {
+    static uint32_t power_up[POLICY_TRIALS];
+    static uint32_t latency[POLICY_TRIALS];
+
+    for (int k = 0; k < POLICY_TRIALS; k++) {
+        power_up[k] = rng() % POLICY_SPAN_MS;
+    }
+
+    for (int cue = 0; cue < 2; cue++) {
+        for (int which = 0; which < POLICY_COUNT; which++) {
+            uint64_t listen_ms = 0;
+            uint64_t search_ms = 0;
+            uint64_t latency_sum = 0;
+
+            for (int k = 0; k < POLICY_TRIALS; k++) {
+                scan_policy_t policy;
+                policy_init(which, &policy);
+                policy_trial_t r = sim_search(&policy, power_up[k], cue);
+                latency[k] = r.latency_ms;
+                latency_sum += r.latency_ms;
+                listen_ms += r.listen_ms;
+                search_ms += r.search_ms;
+            }
+            qsort(latency, POLICY_TRIALS, sizeof(latency[0]), cmp_u32);
+
+            double mean_s = (double)latency_sum / POLICY_TRIALS / 1000;
+            double mah = (double)listen_ms * SIM_RX_MA / 3600000.0 / POLICY_TRIALS;
+            printf("policy %-13s %-6s %6.2f p50 %6.2f p90 %6.2f max %6.2f mean s "
+                   "%5.1f%% duty %6.3f mAh/search\n",
+                   policy_labels[which], cue ? "cue" : "no cue",
+                   latency[POLICY_TRIALS / 2] / 1000.0, latency[POLICY_TRIALS * 9 / 10] / 1000.0,
+                   latency[POLICY_TRIALS - 1] / 1000.0, mean_s, 100.0 * listen_ms / search_ms,
+                   mah);
+        }
+    }
+}
+
+void app_main(void) {
+    printf("device table: %d slots, %d entries max, %u bytes\n", DEVICE_TABLE_CAPACITY,
+           DEVICE_TABLE_MAX_ENTRIES, (unsigned)sizeof(device_table_t));
+
+    bench_steady(16);
+    bench_steady(100);
+    bench_steady(DEVICE_TABLE_MAX_ENTRIES / 2);
+    bench_steady(DEVICE_TABLE_MAX_ENTRIES);
+    bench_churn();
+    bench_adv_data();
+    bench_detection();
+    bench_scan_policies();
+
+    const device_entry_t *top[4];
+    size_t n = device_table_strongest(&table, top, 4);
+    for (size_t i = 0; i < n; i++) {
+        printf("strongest %u: %d dBm, %lu reports\n", (unsigned)i, device_entry_rssi(top[i]),
+               (unsigned long)top[i]->count);
+    }
+    exit(0);
+}
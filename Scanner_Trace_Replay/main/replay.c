@@ -0,0 +1,286 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include "adv_trace.h"
+#include "scan_core.h"
+#include "client_core.h"
+
+// Replays an advertisement trace recorded by BLEScanner (see adv_trace.h)
+// through scan_core, the scanner's own report handling, or client_core,
+// the helmet client's, and reports how many reports a second it gets
+// through and how long each one took, so parser and table changes can be
+// measured against real recordings. The client replay also reports how
+// long the client would have searched before connecting to its target.
+//
+// ADV_TRACE        Trace file, default trace.advt
+// ADV_TRACE_SPEED  "max" (default): back to back, once untimed for the
+//                  rate and once timing each report. "1": at the recorded
+//                  pace, also reporting how far each report finished
+//                  behind its recorded time.
+// ADV_TRACE_CORE   "scanner" (default) or "client"
+// ADV_TRACE_TARGET Client target address, default the helmet's
+//                  a0:85:e3:0e:32:a6
+#define REPLAY_EXPIRE_PERIOD_MS 5000    // BLEScanner's SUMMARY_PERIOD_MS
+#define REPLAY_TOP_DEVICES      8
+
+typedef struct {
+    uint8_t *data;              // The file; reports point into it
+    adv_report_t *reports;
+    size_t count;
+} trace_t;
+
+static device_table_t devices;
+
+// Client replay: the search starts with the trace, and the first connect
+// decision ends it, as the client stops scanning to connect
+static bool replay_client;
+static uint8_t client_target[6] = {0xa6, 0x32, 0x0e, 0xe3, 0x85, 0xa0};
+static client_core_t client;
+static bool client_found;
+static uint32_t client_detect_ms;
+static uint32_t client_prints;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+// ==== Trace ====
+static bool load_trace(const char *path, trace_t *trace) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        printf("%s: can't open\n", path);
+        return false;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    trace->data = malloc(size > 0 ? size : 1);
+    bool ok = trace->data != NULL && fread(trace->data, 1, size, f) == (size_t)size;
+    fclose(f);
+    if (!ok || !adv_trace_check_header(trace->data, size)) {
+        printf("%s: not an advertisement trace (version %d)\n", path, ADV_TRACE_VERSION);
+        return false;
+    }
+
+    // Count, then decode
+    const uint8_t *start = trace->data + ADV_TRACE_HEADER_SIZE;
+    const uint8_t *end = trace->data + size;
+    adv_report_t report;
+    size_t len;
+    trace->count = 0;
+    for (const uint8_t *p = start; (len = adv_trace_decode(p, end - p, &report)) > 0; p += len) {
+        trace->count++;
+    }
+    if (trace->count == 0) {
+        printf("%s: no reports\n", path);
+        return false;
+    }
+
+    trace->reports = malloc(trace->count * sizeof(adv_report_t));
+    if (trace->reports == NULL) {
+        return false;
+    }
+    const uint8_t *p = start;
+    for (size_t i = 0; i < trace->count; i++) {
+        p += adv_trace_decode(p, end - p, &trace->reports[i]);
+    }
+    if (p != end) {
+        printf("%s: %u bytes of truncated record at the end ignored\n", path, (unsigned)(end - p));
+    }
+    return true;
+}
+
+// ==== Replay ====
+static void client_report(const adv_report_t *report) {
+    client_core_action_t action;
+    client_core_report(&client, report, client_found, &action);
+    client_prints += action.print;
+    if (action.connect) {
+        client_found = true;
+        client_detect_ms = action.detect_ms;
+    }
+}
+
+// The core being replayed
+static void handle_report(const adv_report_t *report) {
+    if (replay_client) {
+        client_report(report);
+    } else {
+        scan_core_report(&devices, report);
+    }
+}
+
+// Feed every report to the core, expiring the scanner's devices on its
+// schedule. With realtime, each report waits for its recorded time.
+// service_ns and late_us (may be NULL) receive per-report times.
+static uint64_t replay(const trace_t *trace, bool realtime, uint32_t *service_ns,
+                       uint32_t *late_us) {
+    uint32_t first_ms = trace->reports[0].time_ms;
+    uint32_t next_expire_ms = first_ms + REPLAY_EXPIRE_PERIOD_MS;
+
+    device_table_init(&devices);
+    client_core_init(&client, client_target, first_ms);
+    client_found = false;
+    client_prints = 0;
+    uint64_t start = now_ns();
+
+    for (size_t i = 0; i < trace->count; i++) {
+        const adv_report_t *r = &trace->reports[i];
+        while (!replay_client && (int32_t)(r->time_ms - next_expire_ms) >= 0) {
+            scan_core_expire(&devices, next_expire_ms);
+            next_expire_ms += REPLAY_EXPIRE_PERIOD_MS;
+        }
+
+        uint64_t due = start + (uint64_t)(r->time_ms - first_ms) * 1000000;
+        if (realtime) {
+            struct timespec ts = { .tv_sec = due / 1000000000, .tv_nsec = due % 1000000000 };
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+        }
+
+        if (service_ns == NULL) {
+            handle_report(r);
+            continue;
+        }
+        uint64_t t0 = now_ns();
+        handle_report(r);
+        uint64_t t1 = now_ns();
+        service_ns[i] = (uint32_t)(t1 - t0);
+        if (late_us != NULL) {
+            late_us[i] = (uint32_t)((t1 - due) / 1000);
+        }
+    }
+
+    return now_ns() - start;
+}
+
+// Reports a second the handler alone would keep up with
+static double handler_rate(const uint32_t *service_ns, size_t n) {
+    uint64_t total = 0;
+    for (size_t i = 0; i < n; i++) {
+        total += service_ns[i];
+    }
+    return total ? n * 1e9 / total : 0.0;
+}
+
+static void print_percentiles(const char *name, uint32_t *samples, size_t n) {
+    qsort(samples, n, sizeof(samples[0]), cmp_u32);
+    printf("%-16s %7lu p50 %7lu p90 %7lu p99 %7lu p99.9 %7lu max\n", name,
+           (unsigned long)samples[n / 2], (unsigned long)samples[n * 9 / 10],
+           (unsigned long)samples[n * 99 / 100], (unsigned long)samples[n * 999 / 1000],
+           (unsigned long)samples[n - 1]);
+}
+
+// Device summary at the end of the trace, as the scanner prints it
+static void print_devices(uint32_t now_ms) {
+    printf("devices: %u | %lu reports | %lu dropped (table full)\n", (unsigned)devices.entries,
+           (unsigned long)devices.reports, (unsigned long)devices.dropped);
+
+    const device_entry_t *top[REPLAY_TOP_DEVICES];
+    size_t n = device_table_strongest(&devices, top, REPLAY_TOP_DEVICES);
+    for (size_t i = 0; i < n; i++) {
+        const device_entry_t *e = top[i];
+        printf("  %02x:%02x:%02x:%02x:%02x:%02x %4d dBm %7lu adv %6lu ms ago  %s\n",
+               e->addr[5], e->addr[4], e->addr[3], e->addr[2], e->addr[1], e->addr[0],
+               device_entry_rssi(e), (unsigned long)e->count,
+               (unsigned long)(now_ms - e->last_seen_ms), e->name[0] ? e->name : "(unknown)");
+    }
+}
+
+// What the client did with the trace
+static void print_client(const trace_t *trace) {
+    const uint8_t *t = client_target;
+    printf("client: %lu device lines printed\n", (unsigned long)client_prints);
+    if (client_found) {
+        printf("target %02x:%02x:%02x:%02x:%02x:%02x found %lu ms into the trace\n",
+               t[5], t[4], t[3], t[2], t[1], t[0], (unsigned long)client_detect_ms);
+    } else {
+        printf("target %02x:%02x:%02x:%02x:%02x:%02x not in the trace (%.1f s)\n",
+               t[5], t[4], t[3], t[2], t[1], t[0],
+               (trace->reports[trace->count - 1].time_ms - trace->reports[0].time_ms) / 1000.0);
+    }
+}
+
+// "aa:bb:cc:dd:ee:ff", most significant byte first, into little endian
+static bool parse_addr(const char *s, uint8_t addr[6]) {
+    unsigned b[6];
+    char end;
+    if (sscanf(s, "%2x:%2x:%2x:%2x:%2x:%2x%c", &b[5], &b[4], &b[3], &b[2], &b[1], &b[0],
+               &end) != 6) {
+        return false;
+    }
+    for (int i = 0; i < 6; i++) {
+        addr[i] = (uint8_t)b[i];
+    }
+    return true;
+}
+
+void app_main(void) {
+    const char *path = getenv("ADV_TRACE");
+    if (path == NULL) {
+        path = "trace.advt";
+    }
+    const char *speed = getenv("ADV_TRACE_SPEED");
+    bool realtime = speed != NULL && strcmp(speed, "1") == 0;
+    if (speed != NULL && !realtime && strcmp(speed, "max") != 0) {
+        printf("ADV_TRACE_SPEED must be 1 or max\n");
+        exit(1);
+    }
+    const char *core = getenv("ADV_TRACE_CORE");
+    replay_client = core != NULL && strcmp(core, "client") == 0;
+    if (core != NULL && !replay_client && strcmp(core, "scanner") != 0) {
+        printf("ADV_TRACE_CORE must be scanner or client\n");
+        exit(1);
+    }
+    const char *target = getenv("ADV_TRACE_TARGET");
+    if (target != NULL && !parse_addr(target, client_target)) {
+        printf("ADV_TRACE_TARGET must be an address like a0:85:e3:0e:32:a6\n");
+        exit(1);
+    }
+
+    trace_t trace;
+    if (!load_trace(path, &trace)) {
+        exit(1);
+    }
+    uint32_t span_ms = trace.reports[trace.count - 1].time_ms - trace.reports[0].time_ms;
+    printf("trace %s: %lu reports over %.1f s (%.0f reports/s recorded)\n", path,
+           (unsigned long)trace.count, span_ms / 1000.0,
+           span_ms ? trace.count * 1000.0 / span_ms : 0.0);
+
+    uint32_t *service_ns = malloc(trace.count * sizeof(uint32_t));
+    uint32_t *late_us = malloc(trace.count * sizeof(uint32_t));
+    if (service_ns == NULL || late_us == NULL) {
+        exit(1);
+    }
+
+    if (realtime) {
+        uint64_t ns = replay(&trace, true, service_ns, late_us);
+        printf("replay at 1x: %.2f s, %.0f reports/s (handler alone %.0f reports/s)\n", ns / 1e9,
+               ns ? trace.count * 1e9 / ns : 0.0, handler_rate(service_ns, trace.count));
+        print_percentiles("report ns", service_ns, trace.count);
+        print_percentiles("behind trace us", late_us, trace.count);
+    } else {
+        // Untimed for the rate, so reading the clock doesn't count
+        uint64_t ns = replay(&trace, false, NULL, NULL);
+        printf("replay at max: %.2f ms, %.0f reports/s\n", ns / 1e6,
+               ns ? trace.count * 1e9 / ns : 0.0);
+        replay(&trace, false, service_ns, NULL);
+        print_percentiles("report ns", service_ns, trace.count);
+    }
+
+    if (replay_client) {
+        print_client(&trace);
+    } else {
+        print_devices(trace.reports[trace.count - 1].time_ms);
+    }
+    exit(0);
+}
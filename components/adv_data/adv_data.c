@@ -0,0 +1,91 @@
+#include "adv_data.h"
+#include <string.h>
+
+// ==== Extractors ====
+bool adv_data_find(const uint8_t *data, size_t len, uint8_t type, adv_field_t *field) {
+    adv_data_iter_t it;
+    adv_data_iter_init(&it, data, len);
+
+    while (adv_data_next(&it, field)) {
+        if (field->type == type) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool adv_data_name(const uint8_t *data, size_t len, const uint8_t **name, uint8_t *name_len) {
+    adv_data_iter_t it;
+    adv_field_t f;
+    bool found = false;
+    adv_data_iter_init(&it, data, len);
+
+    while (adv_data_next(&it, &f)) {
+        if (f.type == ADV_DATA_TYPE_NAME_COMPLETE) {
+            *name = f.data;
+            *name_len = f.len;
+            return true;
+        }
+        if (f.type == ADV_DATA_TYPE_NAME_SHORT && !found) {
+            *name = f.data;
+            *name_len = f.len;
+            found = true;
+        }
+    }
+    return found;
+}
+
+bool adv_data_mfg(const uint8_t *data, size_t len, uint16_t *company, adv_field_t *field) {
+    adv_field_t f;
+
+    if (!adv_data_find(data, len, ADV_DATA_TYPE_MFG_DATA, &f) || f.len < 2) {
+        return false;
+    }
+    if (company != NULL) {
+        *company = f.data[0] | (f.data[1] << 8);
+    }
+    if (field != NULL) {
+        *field = (adv_field_t) {
+            .type = f.type,
+            .len = f.len - 2,
+            .data = f.data + 2,
+        };
+    }
+    return true;
+}
+
+bool adv_data_has_uuid16(const uint8_t *data, size_t len, uint16_t uuid) {
+    adv_data_iter_t it;
+    adv_field_t f;
+    adv_data_iter_init(&it, data, len);
+
+    while (adv_data_next(&it, &f)) {
+        if (f.type != ADV_DATA_TYPE_UUID16_COMP && f.type != ADV_DATA_TYPE_UUID16_INCOMP) {
+            continue;
+        }
+        for (int i = 0; i + 2 <= f.len; i += 2) {
+            if ((f.data[i] | (f.data[i + 1] << 8)) == uuid) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool adv_data_has_uuid128(const uint8_t *data, size_t len, const uint8_t uuid[16]) {
+    adv_data_iter_t it;
+    adv_field_t f;
+    adv_data_iter_init(&it, data, len);
+
+    while (adv_data_next(&it, &f)) {
+        if (f.type != ADV_DATA_TYPE_UUID128_COMP && f.type != ADV_DATA_TYPE_UUID128_INCOMP) {
+            continue;
+        }
+        for (int i = 0; i + 16 <= f.len; i += 16) {
+            if (memcmp(&f.data[i], uuid, 16) == 0) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,139 @@
+#ifndef ADV_DATA_H
+#define ADV_DATA_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ==== Advertising Data ====
+//
+// Zero-copy walk over the AD structures of an advertising or scan
+// response payload (length, type, data; Core Spec Vol 3 Part C 11). The
+// iterator yields views into the caller's buffer and decodes nothing, so
+// the extractors below touch only the bytes up to the field they look for
+// and return as soon as it turns up. A zero length byte ends the payload
+// early, as the spec allows; a field running past the end ends it too.
+//
+// Shared by the scanner and the clients in place of
+// ble_hs_adv_parse_fields(), which decodes every field of every report.
+
+// AD types used here (Assigned Numbers, Generic Access Profile)
+#define ADV_DATA_TYPE_FLAGS          0x01
+#define ADV_DATA_TYPE_UUID16_INCOMP  0x02
+#define ADV_DATA_TYPE_UUID16_COMP    0x03
+#define ADV_DATA_TYPE_UUID32_INCOMP  0x04
+#define ADV_DATA_TYPE_UUID32_COMP    0x05
+#define ADV_DATA_TYPE_UUID128_INCOMP 0x06
+#define ADV_DATA_TYPE_UUID128_COMP   0x07
+#define ADV_DATA_TYPE_NAME_SHORT     0x08
+#define ADV_DATA_TYPE_NAME_COMPLETE  0x09
+#define ADV_DATA_TYPE_TX_POWER       0x0A
+#define ADV_DATA_TYPE_SVC_DATA16     0x16
+#define ADV_DATA_TYPE_MFG_DATA       0xFF
+
+// One discovery report, as the scanner handles it and a trace records it
+// (see adv_trace.h)
+typedef struct {
+    uint32_t time_ms;
+    uint8_t addr[6];            // Little endian, as in ble_addr_t
+    uint8_t addr_type;
+    uint8_t event_type;         // BLE_HCI_ADV_RPT_EVTYPE_*
+    int8_t rssi;
+    uint8_t data_len;
+    const uint8_t *data;        // Payload, not owned
+} adv_report_t;
+
+typedef struct {
+    const uint8_t *p;
+    const uint8_t *end;
+} adv_data_iter_t;
+
+typedef struct {
+    uint8_t type;
+    uint8_t len;                // Length of data, without the type byte
+    const uint8_t *data;
+} adv_field_t;
+
+static inline void adv_data_iter_init(adv_data_iter_t *it, const uint8_t *data, size_t len) {
+    it->p = data;
+    it->end = data + len;
+}
+
+/**
+ * @brief Step to the next AD structure
+ * @param it Iterator set up by adv_data_iter_init()
+ * @param field Receives the type and a view of the data
+ * @return false at the end of the payload or at a malformed structure
+ */
+static inline bool adv_data_next(adv_data_iter_t *it, adv_field_t *field) {
+    if (it->end - it->p < 2 || it->p[0] == 0 || it->p[0] > it->end - it->p - 1) {
+        return false;
+    }
+    field->len = it->p[0] - 1;
+    field->type = it->p[1];
+    field->data = it->p + 2;
+    it->p += it->p[0] + 1;
+    return true;
+}
+
+/**
+ * @brief Find the first AD structure of a type
+ * @param data Payload
+ * @param len Payload length
+ * @param type AD type
+ * @param field Receives the structure if found
+ * @return true if found
+ */
+bool adv_data_find(const uint8_t *data, size_t len, uint8_t type, adv_field_t *field);
+
+/**
+ * @brief Get the device name
+ *
+ * The complete name is returned as soon as it is seen; a shortened name
+ * only if the payload has no complete one.
+ *
+ * @param data Payload
+ * @param len Payload length
+ * @param name Receives a view of the name (not terminated)
+ * @param name_len Receives the name length
+ * @return true if the payload carries a name
+ */
+bool adv_data_name(const uint8_t *data, size_t len, const uint8_t **name, uint8_t *name_len);
+
+/**
+ * @brief Get the manufacturer specific data
+ * @param data Payload
+ * @param len Payload length
+ * @param company Receives the company identifier (may be NULL)
+ * @param field Receives the data after the company identifier (may be NULL)
+ * @return true if the payload carries manufacturer data
+ */
+bool adv_data_mfg(const uint8_t *data, size_t len, uint16_t *company, adv_field_t *field);
+
+/**
+ * @brief Check whether a 16-bit service UUID is advertised
+ * @param data Payload
+ * @param len Payload length
+ * @param uuid Service UUID
+ * @return true if a complete or incomplete UUID16 list holds it
+ */
+bool adv_data_has_uuid16(const uint8_t *data, size_t len, uint16_t uuid);
+
+/**
+ * @brief Check whether a 128-bit service UUID is advertised
+ * @param data Payload
+ * @param len Payload length
+ * @param uuid Service UUID, little endian as on air
+ * @return true if a complete or incomplete UUID128 list holds it
+ */
+bool adv_data_has_uuid128(const uint8_t *data, size_t len, const uint8_t uuid[16]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ADV_DATA_H
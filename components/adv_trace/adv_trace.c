@@ -0,0 +1,49 @@
+#include "adv_trace.h"
+#include <string.h>
+
+void adv_trace_header(uint8_t out[ADV_TRACE_HEADER_SIZE]) {
+    memcpy(out, ADV_TRACE_MAGIC, 4);
+    out[4] = ADV_TRACE_VERSION;
+    memset(out + 5, 0, 3);
+}
+
+bool adv_trace_check_header(const uint8_t *data, size_t len) {
+    return len >= ADV_TRACE_HEADER_SIZE && memcmp(data, ADV_TRACE_MAGIC, 4) == 0 &&
+           data[4] == ADV_TRACE_VERSION;
+}
+
+size_t adv_trace_encode(const adv_report_t *report, uint8_t *out, size_t size) {
+    if (size < ADV_TRACE_RECORD_HEADER) {
+        return 0;
+    }
+    size_t data_len = report->data_len;
+    if (data_len > size - ADV_TRACE_RECORD_HEADER) {
+        data_len = size - ADV_TRACE_RECORD_HEADER;
+    }
+
+    out[0] = report->time_ms;
+    out[1] = report->time_ms >> 8;
+    out[2] = report->time_ms >> 16;
+    out[3] = report->time_ms >> 24;
+    memcpy(out + 4, report->addr, 6);
+    out[10] = (report->addr_type & 0x0F) | (report->event_type << 4);
+    out[11] = (uint8_t)report->rssi;
+    out[12] = data_len;
+    memcpy(out + ADV_TRACE_RECORD_HEADER, report->data, data_len);
+    return ADV_TRACE_RECORD_HEADER + data_len;
+}
+
+size_t adv_trace_decode(const uint8_t *data, size_t len, adv_report_t *report) {
+    if (len < ADV_TRACE_RECORD_HEADER || len < ADV_TRACE_RECORD_HEADER + (size_t)data[12]) {
+        return 0;
+    }
+
+    report->time_ms = data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+    memcpy(report->addr, data + 4, 6);
+    report->addr_type = data[10] & 0x0F;
+    report->event_type = data[10] >> 4;
+    report->rssi = (int8_t)data[11];
+    report->data_len = data[12];
+    report->data = data + ADV_TRACE_RECORD_HEADER;
+    return ADV_TRACE_RECORD_HEADER + report->data_len;
+}
@@ -0,0 +1,75 @@
+#ifndef ADV_TRACE_H
+#define ADV_TRACE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "adv_data.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ==== Advertisement Trace ====
+//
+// Compact recording of discovery reports, so a crowded car park or a
+// flaky helmet can be replayed on a desk (Scanner_Trace_Replay). A trace
+// file is a header followed by records, all little endian:
+//
+//   header  "ADVT", uint8 version, 3 reserved bytes
+//   record  uint32 time_ms       Device time of the report
+//           uint8  addr[6]       As in ble_addr_t
+//           uint8  type          Address type in bits 0-3, advertising
+//                                event type in bits 4-7
+//           int8   rssi
+//           uint8  data_len
+//           uint8  data[data_len]
+//
+// BLEScanner's capture mode prints each record as a line of hex after
+// ADV_TRACE_LINE_PREFIX; adv_trace_convert.py turns a console capture
+// into a trace file.
+
+#define ADV_TRACE_MAGIC          "ADVT"
+#define ADV_TRACE_VERSION        1
+#define ADV_TRACE_HEADER_SIZE    8
+#define ADV_TRACE_RECORD_HEADER  13
+#define ADV_TRACE_RECORD_MAX     (ADV_TRACE_RECORD_HEADER + 255)
+#define ADV_TRACE_LINE_PREFIX    "#AT:"
+
+/**
+ * @brief Write the file header
+ * @param out Receives ADV_TRACE_HEADER_SIZE bytes
+ */
+void adv_trace_header(uint8_t out[ADV_TRACE_HEADER_SIZE]);
+
+/**
+ * @brief Check a file header
+ * @param data Start of the file
+ * @param len Bytes available
+ * @return true if it is a trace of a version this code reads
+ */
+bool adv_trace_check_header(const uint8_t *data, size_t len);
+
+/**
+ * @brief Encode a report
+ * @param report Report to record
+ * @param out Output buffer
+ * @param size Its size; a payload that doesn't fit is truncated
+ * @return Record length, 0 if size is below ADV_TRACE_RECORD_HEADER
+ */
+size_t adv_trace_encode(const adv_report_t *report, uint8_t *out, size_t size);
+
+/**
+ * @brief Decode the next record
+ * @param data Record bytes
+ * @param len Bytes available
+ * @param report Receives the report; its payload points into data
+ * @return Record length, 0 if data holds no complete record
+ */
+size_t adv_trace_decode(const uint8_t *data, size_t len, adv_report_t *report);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ADV_TRACE_H
@@ -0,0 +1,59 @@
+#!/usr/bin/env python3
+"""Turn a BLEScanner console capture into an advertisement trace file.
+
+The scanner built with CONFIG_SCANNER_TRACE_CAPTURE prints every report
+as a #AT: line of hex bytes, one trace record each (the format is in
+adv_trace.h). This writes the trace header and those records, in order,
+and ignores every other line. Pass a capture taken with CONFIG_BINLOG_RAW
+through binlog_decode.py first.
+
+Reports the device had no room to print are counted on the device; the
+last count in the capture is shown, as the trace is missing them.
+
+Usage: adv_trace_convert.py <capture.log> <trace.advt>
+"""
+
+import re
+import sys
+
+PREFIX = '#AT:'                       # ADV_TRACE_LINE_PREFIX
+HEADER = b'ADVT\x01\x00\x00\x00'      # ADV_TRACE_MAGIC, ADV_TRACE_VERSION
+RECORD_HEADER = 13                    # ADV_TRACE_RECORD_HEADER
+DROPPED = re.compile(r'binlog: (\d+) records dropped')
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit(__doc__)
+
+    records = bad = dropped = 0
+    with open(sys.argv[1], errors='replace') as capture, open(sys.argv[2], 'wb') as trace:
+        trace.write(HEADER)
+        for line in capture:
+            m = DROPPED.search(line)
+            if m:
+                dropped = int(m.group(1))
+                continue
+            start = line.find(PREFIX)
+            if start < 0:
+                continue
+            try:
+                record = bytes.fromhex(line[start + len(PREFIX):])
+            except ValueError:
+                bad += 1
+                continue
+            if len(record) < RECORD_HEADER or len(record) != RECORD_HEADER + record[12]:
+                bad += 1
+                continue
+            trace.write(record)
+            records += 1
+
+    print('%s: %d reports' % (sys.argv[2], records))
+    if bad:
+        print('%d malformed #AT: lines skipped' % bad)
+    if dropped:
+        print('%d log records dropped on the device; the reports among them are missing' % dropped)
+
+
+if __name__ == '__main__':
+    main()
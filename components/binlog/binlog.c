@@ -0,0 +1,311 @@
+#include "binlog.h"
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+static const char *TAG = "binlog";
+
+// Record header; the arguments and the byte string follow it
+typedef struct {
+    uint16_t len;               // Whole record, padded to 4 bytes
+    uint16_t fmt;
+    uint32_t time_us;           // esp_timer_get_time(), low 32 bits
+    uint16_t seq;               // Counts records written, not dropped ones
+    uint8_t nargs;
+    uint8_t blob_len;
+} binlog_record_t;
+
+#define RECORD_MAX   (sizeof(binlog_record_t) + BINLOG_MAX_ARGS * 4 + BINLOG_MAX_BLOB)
+#define RING_MASK    (BINLOG_RING_SIZE - 1)
+#define ALIGN4(n)    (((n) + 3) & ~3u)
+
+_Static_assert(sizeof(binlog_record_t) == 12, "record header is part of the capture format");
+_Static_assert((BINLOG_RING_SIZE & RING_MASK) == 0, "BINLOG_RING_SIZE must be a power of two");
+_Static_assert(BINLOG_RING_SIZE >= 4 * RECORD_MAX, "BINLOG_RING_SIZE too small");
+
+// ==== Ring ====
+// head and the record sequence belong to the producer, tail to the task.
+// Both count bytes and wrap freely; a record never wraps, a pad record
+// fills the end of the ring instead.
+static uint8_t ring[BINLOG_RING_SIZE] __attribute__((aligned(4)));
+static _Atomic uint32_t ring_head = 0;
+static _Atomic uint32_t ring_tail = 0;
+static _Atomic uint32_t ring_dropped = 0;
+static uint16_t ring_seq = 0;
+
+static const binlog_config_t *log_config = NULL;
+static TaskHandle_t log_task = NULL;
+
+bool binlog_write(uint16_t fmt, const uint32_t *args, size_t nargs, const void *blob,
+                  size_t blob_len) {
+    if (nargs > BINLOG_MAX_ARGS) {
+        nargs = BINLOG_MAX_ARGS;
+    }
+    if (blob == NULL) {
+        blob_len = 0;
+    } else if (blob_len > BINLOG_MAX_BLOB) {
+        blob_len = BINLOG_MAX_BLOB;
+    }
+
+    uint32_t len = ALIGN4(sizeof(binlog_record_t) + nargs * 4 + blob_len);
+    uint32_t head = atomic_load_explicit(&ring_head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ring_tail, memory_order_acquire);
+    uint32_t to_end = BINLOG_RING_SIZE - (head & RING_MASK);
+    uint32_t need = (len <= to_end) ? len : len + to_end;
+
+    if (BINLOG_RING_SIZE - (head - tail) < need) {
+        // Only this task writes it; the drain task just reads
+        atomic_store_explicit(&ring_dropped,
+                              atomic_load_explicit(&ring_dropped, memory_order_relaxed) + 1,
+                              memory_order_relaxed);
+        return false;
+    }
+
+    if (len > to_end) {
+        binlog_record_t *pad = (binlog_record_t *)&ring[head & RING_MASK];
+        pad->len = to_end;
+        pad->fmt = BINLOG_FMT_PAD;
+        head += to_end;
+    }
+
+    uint8_t *p = &ring[head & RING_MASK];
+    binlog_record_t rec = {
+        .len = len,
+        .fmt = fmt,
+        .time_us = (uint32_t)esp_timer_get_time(),
+        .seq = ring_seq++,
+        .nargs = nargs,
+        .blob_len = blob_len,
+    };
+    memcpy(p, &rec, sizeof(rec));
+    memcpy(p + sizeof(rec), args, nargs * 4);
+    if (blob_len > 0) {
+        memcpy(p + sizeof(rec) + nargs * 4, blob, blob_len);
+    }
+
+    // Publish the record to the drain task
+    atomic_store_explicit(&ring_head, head + len, memory_order_release);
+    return true;
+}
+
+uint32_t binlog_dropped(void) {
+    return atomic_load_explicit(&ring_dropped, memory_order_relaxed);
+}
+
+// ==== Output ====
+#if !CONFIG_BINLOG_RAW
+// Expand a record's format; see binlog.h for the conversions
+static void format_record(const char *fmt, const uint32_t *args, size_t nargs,
+                          const uint8_t *blob, size_t blob_len, char *line, size_t size) {
+    size_t pos = 0;
+    size_t arg = 0;
+    char spec[16];
+
+    while (*fmt != '\0' && pos + 1 < size) {
+        if (*fmt != '%') {
+            line[pos++] = *fmt++;
+            continue;
+        }
+
+        // % [flags] [width] [.precision] conversion
+        const char *start = fmt++;
+        fmt += strspn(fmt, "-+ #0");
+        fmt += strspn(fmt, "0123456789");
+        const char *dot = NULL;
+        if (*fmt == '.') {
+            dot = fmt++;
+            fmt += strspn(fmt, "0123456789");
+        }
+        char type = *fmt;
+        if (type == '\0') {
+            break;
+        }
+        fmt++;
+
+        size_t spec_len = fmt - start;
+        if (spec_len + 3 > sizeof(spec)) {
+            continue;
+        }
+        memcpy(spec, start, spec_len);
+        spec[spec_len] = '\0';
+
+        size_t room = size - pos;
+        uint32_t value = (arg < nargs) ? args[arg] : 0;
+        int n = 0;
+
+        switch (type) {
+        case '%':
+            line[pos++] = '%';
+            break;
+
+        case 'd':
+        case 'i':
+            n = snprintf(line + pos, room, spec, (int)(int32_t)value);
+            arg++;
+            break;
+
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+        case 'c':
+            n = snprintf(line + pos, room, spec, (unsigned)value);
+            arg++;
+            break;
+
+        case 's': {
+            // The byte string isn't terminated, so always pass a precision
+            int prec = (int)blob_len;
+            size_t keep = (dot != NULL) ? (size_t)(dot - start) : spec_len - 1;
+            if (dot != NULL && atoi(dot + 1) < prec) {
+                prec = atoi(dot + 1);
+            }
+            memcpy(spec + keep, ".*s", 4);
+            n = snprintf(line + pos, room, spec, prec, blob_len ? (const char *)blob : "");
+            break;
+        }
+
+        case 'H':
+            for (size_t i = 0; i < blob_len && n + 3 < (int)room; i++) {
+                n += snprintf(line + pos + n, room - n, i ? " %02x" : "%02x", blob[i]);
+            }
+            break;
+
+        default:
+            // Not ours; leave it in the line as written
+            n = snprintf(line + pos, room, "%s", spec);
+            break;
+        }
+
+        if (n > 0) {
+            pos += ((size_t)n < room) ? (size_t)n : room - 1;
+        }
+    }
+    line[pos] = '\0';
+}
+
+static void print_record(const uint32_t *record) {
+    const binlog_record_t *rec = (const binlog_record_t *)record;
+    const uint32_t *args = record + sizeof(binlog_record_t) / 4;
+    char line[BINLOG_LINE_MAX + 1];
+
+    if (rec->fmt == BINLOG_FMT_DROPPED) {
+        snprintf(line, sizeof(line), "binlog: %" PRIu32 " records dropped", args[0]);
+    } else if (rec->fmt < log_config->format_count) {
+        format_record(log_config->formats[rec->fmt], args, rec->nargs,
+                      (const uint8_t *)(args + rec->nargs), rec->blob_len, line, sizeof(line));
+    } else {
+        snprintf(line, sizeof(line), "binlog: unknown format %u", rec->fmt);
+    }
+    puts(line);
+}
+
+#else
+// Base64 of a whole record, for binlog_decode.py
+static size_t encode_record(const uint8_t *data, size_t len, char *out) {
+    static const char digits[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    size_t n = 0;
+
+    for (size_t i = 0; i < len; i += 3) {
+        uint32_t v = data[i] << 16;
+        if (i + 1 < len) {
+            v |= data[i + 1] << 8;
+        }
+        if (i + 2 < len) {
+            v |= data[i + 2];
+        }
+        out[n++] = digits[v >> 18];
+        out[n++] = digits[(v >> 12) & 63];
+        out[n++] = (i + 1 < len) ? digits[(v >> 6) & 63] : '=';
+        out[n++] = (i + 2 < len) ? digits[v & 63] : '=';
+    }
+    out[n] = '\0';
+    return n;
+}
+
+_Static_assert(sizeof(BINLOG_RAW_PREFIX) - 1 + (RECORD_MAX + 2) / 3 * 4 <= BINLOG_LINE_MAX,
+               "BINLOG_LINE_MAX too small for a raw record");
+
+static void print_record(const uint32_t *record) {
+    const binlog_record_t *rec = (const binlog_record_t *)record;
+    char line[BINLOG_LINE_MAX + 1];
+
+    memcpy(line, BINLOG_RAW_PREFIX, sizeof(BINLOG_RAW_PREFIX) - 1);
+    encode_record((const uint8_t *)record, rec->len, line + sizeof(BINLOG_RAW_PREFIX) - 1);
+    puts(line);
+}
+#endif
+
+// ==== Drain Task ====
+// Print everything in the ring, then the drop count if it moved
+static void binlog_drain(void) {
+    static uint32_t reported = 0;
+    uint32_t record[RECORD_MAX / 4];
+    uint32_t tail = atomic_load_explicit(&ring_tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&ring_head, memory_order_acquire);
+
+    while (tail != head) {
+        const binlog_record_t *rec = (const binlog_record_t *)&ring[tail & RING_MASK];
+        uint16_t len = rec->len;
+        bool pad = (rec->fmt == BINLOG_FMT_PAD);
+        if (!pad) {
+            memcpy(record, rec, len);
+        }
+
+        // Hand the space back before the slow part
+        tail += len;
+        atomic_store_explicit(&ring_tail, tail, memory_order_release);
+        if (!pad) {
+            print_record(record);
+        }
+    }
+
+    uint32_t dropped = binlog_dropped();
+    if (dropped != reported) {
+        reported = dropped;
+        binlog_record_t *rec = (binlog_record_t *)record;
+        *rec = (binlog_record_t) {
+            .len = sizeof(binlog_record_t) + 4,
+            .fmt = BINLOG_FMT_DROPPED,
+            .time_us = (uint32_t)esp_timer_get_time(),
+            .nargs = 1,
+        };
+        record[sizeof(binlog_record_t) / 4] = dropped;
+        print_record(record);
+    }
+
+    fflush(stdout);
+}
+
+static void drain_task(void *arg) {
+    while (1) {
+        binlog_drain();
+        vTaskDelay(pdMS_TO_TICKS(BINLOG_DRAIN_PERIOD_MS));
+    }
+}
+
+esp_err_t binlog_start(const binlog_config_t *config) {
+    if (config == NULL || config->formats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (log_task != NULL) {
+        return ESP_OK; // Already running
+    }
+
+    log_config = config;
+    if (xTaskCreate(drain_task, "binlog", BINLOG_TASK_STACK_SIZE, NULL,
+                    BINLOG_TASK_PRIORITY, &log_task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create drain task");
+        log_task = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    return ESP_OK;
+}
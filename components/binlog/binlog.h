@@ -0,0 +1,122 @@
+#ifndef BINLOG_H
+#define BINLOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ==== Binary Log ====
+//
+// Deferred logging for code that must not wait on the console, the
+// NimBLE callbacks in particular: a printf() line at 115200 baud holds
+// the host task for milliseconds. A log call copies a format ID, its
+// integer arguments and at most one byte string into a ring and returns;
+// a low-priority task formats the records and prints them. When the ring
+// is full the record is dropped and counted, and the task reports the
+// count, so a slow console never slows the caller down.
+//
+// The ring is lock-free with a single producer: every binlog_write() must
+// come from the same task (in these projects, the NimBLE host task). Log
+// from anywhere else with printf().
+//
+// Formats are printf strings kept in an X-macro list by the application,
+// X(id, "format"), so the IDs, the table passed to binlog_start() and the
+// host decoder all come from one place:
+//
+//     #define APP_LOG_FORMATS(X)                          (continued
+//         X(LOG_CONNECTED, "Connected, handle %u")      with a backslash
+//         X(LOG_NAME,      "Name: %s")                  on each line)
+//     enum { APP_LOG_FORMATS(BINLOG_FORMAT_ID) LOG_FORMAT_COUNT };
+//
+// Each integer conversion (d i u x X o c) takes the next argument as a
+// 32-bit value; flags, width and precision work as usual but length
+// modifiers must not be used. %s prints the record's byte string and %H
+// prints it as space separated hex bytes.
+//
+// With CONFIG_BINLOG_RAW the task skips the formatting and prints each
+// record as a BINLOG_RAW_PREFIX line of base64, which survives the
+// console's line ending translation and mixes with other output.
+// binlog_decode.py turns a capture back into text, with timestamps and
+// any gaps in the sequence numbers.
+//
+// Record layout (little endian, padded to 4 bytes):
+//   uint16 len, uint16 fmt, uint32 time_us, uint16 seq, uint8 nargs,
+//   uint8 blob_len, uint32 args[nargs], uint8 blob[blob_len]
+
+#define BINLOG_RING_SIZE         CONFIG_BINLOG_RING_SIZE  // Power of two
+#define BINLOG_MAX_ARGS          12
+#define BINLOG_MAX_BLOB          64   // Longer byte strings are truncated
+#define BINLOG_LINE_MAX          192  // Formatted line, without the newline
+#define BINLOG_DRAIN_PERIOD_MS   20
+#define BINLOG_TASK_STACK_SIZE   3072
+#define BINLOG_TASK_PRIORITY     1
+#define BINLOG_RAW_PREFIX        "#BL:"
+
+// Reserved format IDs
+#define BINLOG_FMT_PAD           0xFFFF  // Filler up to the end of the ring
+#define BINLOG_FMT_DROPPED       0xFFFE  // One argument: total dropped so far
+
+#define BINLOG_FORMAT_ID(id, fmt)  id,
+#define BINLOG_FORMAT_STR(id, fmt) fmt,
+
+typedef struct {
+    const char *const *formats;   // Indexed by format ID
+    size_t format_count;
+} binlog_config_t;
+
+/**
+ * @brief Start the task that prints the log
+ *
+ * Records written earlier wait in the ring and come out first.
+ *
+ * @param config Format table; kept by pointer, so it must stay valid
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG without formats,
+ *         ESP_ERR_NO_MEM if the task can't be created
+ */
+esp_err_t binlog_start(const binlog_config_t *config);
+
+/**
+ * @brief Queue a record
+ *
+ * Never blocks. Use the BINLOG() and BINLOG_BLOB() macros rather than
+ * calling this directly.
+ *
+ * @param fmt Format ID
+ * @param args Integer arguments
+ * @param nargs Number of arguments (at most BINLOG_MAX_ARGS)
+ * @param blob Byte string for %s or %H (may be NULL)
+ * @param blob_len Its length; truncated to BINLOG_MAX_BLOB
+ * @return true if queued, false if the ring was full and the record was dropped
+ */
+bool binlog_write(uint16_t fmt, const uint32_t *args, size_t nargs, const void *blob,
+                  size_t blob_len);
+
+/**
+ * @brief Records dropped because the ring was full
+ * @return Count since boot
+ */
+uint32_t binlog_dropped(void);
+
+// Argument list as an array; the leading 0 lets it be empty
+#define BINLOG_ARGS(...) ((const uint32_t[]) { 0, ##__VA_ARGS__ })
+#define BINLOG_NARGS(...) (sizeof(BINLOG_ARGS(__VA_ARGS__)) / sizeof(uint32_t) - 1)
+
+// BINLOG(id, args...)
+#define BINLOG(fmt, ...) \
+    binlog_write((fmt), BINLOG_ARGS(__VA_ARGS__) + 1, BINLOG_NARGS(__VA_ARGS__), NULL, 0)
+
+// BINLOG_BLOB(id, bytes, len, args...)
+#define BINLOG_BLOB(fmt, blob, blob_len, ...) \
+    binlog_write((fmt), BINLOG_ARGS(__VA_ARGS__) + 1, BINLOG_NARGS(__VA_ARGS__), (blob), (blob_len))
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BINLOG_H
@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+"""Decode a binary log capture (CONFIG_BINLOG_RAW) into text.
+
+The formats come from the application's X-macro list, X(id, "format"), in
+the header given; an ID is the position of its entry, as in the firmware.
+Record lines (#BL: and the record in base64) are printed formatted, with
+the device time in seconds. Any other line is passed through unchanged, so
+a whole console log can be fed in.
+
+Records the device had no room for are reported by the device itself. A
+gap in the sequence numbers means records lost between the device and the
+capture, and is reported here.
+
+Usage: binlog_decode.py <formats.h> [capture]   (standard input if no capture)
+"""
+
+import base64
+import binascii
+import codecs
+import re
+import struct
+import sys
+
+PREFIX = '#BL:'                       # BINLOG_RAW_PREFIX
+HEADER = struct.Struct('<HHIHBB')     # len, fmt, time_us, seq, nargs, blob_len
+FMT_PAD = 0xFFFF
+FMT_DROPPED = 0xFFFE
+
+# Same conversions as format_record() in binlog.c
+CONVERSION = re.compile(r'%([-+ #0]*)(\d*)(\.\d*)?(.)', re.S)
+
+
+def parse_formats(path):
+    with open(path) as f:
+        text = f.read().replace('\\\n', ' ')
+    text = re.sub(r'/\*.*?\*/|//[^\n]*', '', text, flags=re.S)
+
+    formats = []
+    for m in re.finditer(r'\bX\(\s*\w+\s*,\s*((?:"(?:[^"\\]|\\.)*"\s*)+)\)', text):
+        parts = re.findall(r'"((?:[^"\\]|\\.)*)"', m.group(1))
+        formats.append(codecs.decode(''.join(parts), 'unicode_escape'))
+    if not formats:
+        sys.exit('%s: no X(id, "format") entries' % path)
+    return formats
+
+
+def format_record(fmt, args, blob):
+    args = iter(args)
+
+    def expand(m):
+        flags, width, prec, conv = m.groups()
+        prec = prec or ''
+        if conv == '%':
+            return '%'
+        if conv in 'di':
+            value = next(args, 0)
+            return ('%' + flags + width + prec + 'd') % (value - (1 << 32) if value >= 1 << 31 else value)
+        if conv in 'uxXoc':
+            return ('%' + flags + width + prec + ('d' if conv == 'u' else conv)) % next(args, 0)
+        if conv == 's':
+            text = blob.decode('latin-1')
+            if prec:
+                text = text[:int(prec[1:] or 0)]
+            return ('%' + flags + width + 's') % text
+        if conv == 'H':
+            return ' '.join('%02x' % b for b in blob)
+        return m.group(0)
+
+    return CONVERSION.sub(expand, fmt)
+
+
+class Decoder:
+    def __init__(self, formats):
+        self.formats = formats
+        self.seq = None
+        self.time_base = 0
+        self.last_time = None
+
+    def seconds(self, time_us):
+        # The device sends the low 32 bits of its microsecond clock
+        if self.last_time is not None and time_us < self.last_time:
+            self.time_base += 1 << 32
+        self.last_time = time_us
+        return (self.time_base + time_us) / 1e6
+
+    def record(self, data):
+        if len(data) < HEADER.size:
+            return '(short record)'
+        length, fmt, time_us, seq, nargs, blob_len = HEADER.unpack_from(data)
+        if length > len(data) or HEADER.size + 4 * nargs + blob_len > length:
+            return '(bad record)'
+        args = struct.unpack_from('<%dI' % nargs, data, HEADER.size)
+        blob = data[HEADER.size + 4 * nargs:HEADER.size + 4 * nargs + blob_len]
+        stamp = '[%11.6f] ' % self.seconds(time_us)
+
+        if fmt == FMT_DROPPED:
+            return stamp + '(binlog: %u records dropped)' % args[0]
+
+        lines = []
+        if self.seq is not None and seq != (self.seq + 1) & 0xFFFF:
+            lines.append('(%d records lost in the capture)' % ((seq - self.seq - 1) & 0xFFFF))
+        self.seq = seq
+
+        if fmt < len(self.formats):
+            lines.append(stamp + format_record(self.formats[fmt], args, blob))
+        else:
+            lines.append(stamp + '(unknown format %u)' % fmt)
+        return '\n'.join(lines)
+
+    def line(self, line):
+        start = line.find(PREFIX)
+        if start < 0:
+            return line
+        try:
+            data = base64.b64decode(line[start + len(PREFIX):].strip(), validate=True)
+        except (binascii.Error, ValueError):
+            return line
+        return line[:start] + self.record(data)
+
+
+def main():
+    if len(sys.argv) not in (2, 3):
+        sys.exit(__doc__)
+    decoder = Decoder(parse_formats(sys.argv[1]))
+    capture = open(sys.argv[2], errors='replace') if len(sys.argv) == 3 else sys.stdin
+
+    for line in capture:
+        print(decoder.line(line.rstrip('\r\n')))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,38 @@
+#include <string.h>
+#include "client_core.h"
+
+void client_core_init(client_core_t *core, const uint8_t target[6], uint32_t now_ms) {
+    memcpy(core->target, target, sizeof(core->target));
+    client_core_search(core, now_ms);
+}
+
+void client_core_search(client_core_t *core, uint32_t now_ms) {
+    device_table_init(&core->seen);
+    core->filter_ms = now_ms;
+    core->search_ms = now_ms;
+}
+
+void client_core_report(client_core_t *core, const adv_report_t *report, bool connected,
+                        client_core_action_t *action) {
+    memset(action, 0, sizeof(*action));
+
+    // Software duplicate filter, cleared on the next report once it is due
+    if ((uint32_t)(report->time_ms - core->filter_ms) >= CLIENT_CORE_DUP_RESET_MS) {
+        device_table_init(&core->seen);
+        core->filter_ms = report->time_ms;
+    }
+    device_entry_t *entry = device_table_update(&core->seen, report->addr, report->addr_type,
+                                                report->rssi, report->time_ms);
+    if (entry != NULL && entry->count == 1) {
+        action->print = true;
+        if (!adv_data_name(report->data, report->data_len, &action->name, &action->name_len)) {
+            action->name = NULL;
+        }
+    }
+
+    if (connected || memcmp(report->addr, core->target, sizeof(core->target)) != 0) {
+        return;
+    }
+    action->connect = true;
+    action->detect_ms = report->time_ms - core->search_ms;
+}
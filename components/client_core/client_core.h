@@ -0,0 +1,74 @@
+#ifndef CLIENT_CORE_H
+#define CLIENT_CORE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "device_table.h"
+#include "adv_data.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ==== Client Core ====
+//
+// What the helmet client does with each discovery report, without NimBLE,
+// so Scanner_Trace_Replay runs the same code over recorded traces. The
+// controller's duplicate filter is off while scanning, so a device table
+// stands in for it: a device is printed on its first report, and again
+// once the filter is cleared every CLIENT_CORE_DUP_RESET_MS. The target
+// address is matched on every report, and the time since the search
+// started comes with the connect decision.
+
+#define CLIENT_CORE_DUP_RESET_MS 10000   // Print each advertiser again this often
+
+typedef struct {
+    uint8_t target[6];          // Little endian, as in ble_addr_t
+    device_table_t seen;        // Devices printed since the filter was cleared
+    uint32_t filter_ms;         // When it was
+    uint32_t search_ms;         // Start of the current search
+} client_core_t;
+
+// What to do with a report
+typedef struct {
+    bool print;                 // First report of the device since the filter was cleared
+    const uint8_t *name;        // With print: the advertised name, NULL if none
+    uint8_t name_len;
+    bool connect;               // From the target: connect to it
+    uint32_t detect_ms;         // With connect: time since the search started
+} client_core_action_t;
+
+/**
+ * @brief Set the target and start a search
+ * @param core Client state
+ * @param target 6-byte address to connect to, little endian
+ * @param now_ms Current time
+ */
+void client_core_init(client_core_t *core, const uint8_t target[6], uint32_t now_ms);
+
+/**
+ * @brief Start a new search, as every scan start does
+ *
+ * Clears the duplicate filter, as the controller's would, and restarts
+ * the detection clock.
+ *
+ * @param core Client state
+ * @param now_ms Current time
+ */
+void client_core_search(client_core_t *core, uint32_t now_ms);
+
+/**
+ * @brief Handle a discovery report
+ * @param core Client state
+ * @param report Report from the GAP event or a trace
+ * @param connected Whether the client is already connected; no connect then
+ * @param action Receives what to do with the report
+ */
+void client_core_report(client_core_t *core, const adv_report_t *report, bool connected,
+                        client_core_action_t *action);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CLIENT_CORE_H
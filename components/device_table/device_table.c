@@ -0,0 +1,139 @@
+#include "device_table.h"
+#include <string.h>
+
+#define SLOT_MASK (DEVICE_TABLE_CAPACITY - 1)
+
+_Static_assert((DEVICE_TABLE_CAPACITY & SLOT_MASK) == 0, "DEVICE_TABLE_CAPACITY must be a power of two");
+
+// ==== Hashing ====
+static inline uint64_t addr_key(const uint8_t addr[6]) {
+    return (uint64_t)addr[0] | ((uint64_t)addr[1] << 8) | ((uint64_t)addr[2] << 16) |
+           ((uint64_t)addr[3] << 24) | ((uint64_t)addr[4] << 32) | ((uint64_t)addr[5] << 40);
+}
+
+// Fibonacci hashing: the top bits of the product mix every address byte,
+// so random and vendor-sequential addresses spread alike
+static inline size_t home_slot(uint64_t key) {
+    return (size_t)((key * 0x9E3779B97F4A7C15ULL) >> 32) & SLOT_MASK;
+}
+
+static inline bool addr_equal(const device_entry_t *e, const uint8_t addr[6]) {
+    return memcmp(e->addr, addr, 6) == 0;
+}
+
+// Slot holding addr, or the empty slot ending its probe run
+static size_t probe(const device_table_t *table, const uint8_t addr[6]) {
+    size_t i = home_slot(addr_key(addr));
+    while (table->slots[i].used && !addr_equal(&table->slots[i], addr)) {
+        i = (i + 1) & SLOT_MASK;
+    }
+    return i;
+}
+
+// ==== Table ====
+void device_table_init(device_table_t *table) {
+    memset(table, 0, sizeof(*table));
+}
+
+device_entry_t *device_table_update(device_table_t *table, const uint8_t addr[6],
+                                    uint8_t addr_type, int8_t rssi, uint32_t now_ms) {
+    device_entry_t *e = &table->slots[probe(table, addr)];
+
+    if (!e->used) {
+        if (table->entries >= DEVICE_TABLE_MAX_ENTRIES) {
+            table->dropped++;
+            return NULL;
+        }
+        memset(e, 0, sizeof(*e));
+        memcpy(e->addr, addr, 6);
+        e->used = true;
+        e->rssi_avg_q4 = rssi * 16;
+        e->first_seen_ms = now_ms;
+        table->entries++;
+    } else {
+        e->rssi_avg_q4 += (rssi * 16 - e->rssi_avg_q4) / (1 << DEVICE_TABLE_RSSI_SHIFT);
+    }
+
+    e->addr_type = addr_type;
+    e->rssi_last = rssi;
+    e->last_seen_ms = now_ms;
+    e->count++;
+    table->reports++;
+    return e;
+}
+
+void device_table_set_name(device_entry_t *entry, const uint8_t *name, size_t len) {
+    if (len >= DEVICE_TABLE_NAME_LEN) {
+        len = DEVICE_TABLE_NAME_LEN - 1;
+    }
+    memcpy(entry->name, name, len);
+    entry->name[len] = '\0';
+}
+
+const device_entry_t *device_table_find(const device_table_t *table, const uint8_t addr[6]) {
+    const device_entry_t *e = &table->slots[probe(table, addr)];
+    return e->used ? e : NULL;
+}
+
+// Empty slot i and move later members of its run back into the gap, so
+// every entry stays reachable from its home slot without tombstones
+static void remove_slot(device_table_t *table, size_t i) {
+    size_t j = i;
+
+    for (;;) {
+        j = (j + 1) & SLOT_MASK;
+        if (!table->slots[j].used) {
+            break;
+        }
+        // An entry may move to i only if i lies on its path from home to j
+        size_t home = home_slot(addr_key(table->slots[j].addr));
+        if (((j - home) & SLOT_MASK) >= ((j - i) & SLOT_MASK)) {
+            table->slots[i] = table->slots[j];
+            i = j;
+        }
+    }
+    table->slots[i].used = false;
+    table->entries--;
+}
+
+size_t device_table_expire(device_table_t *table, uint32_t now_ms, uint32_t max_age_ms) {
+    size_t removed = 0;
+
+    // A shift can pull an unvisited entry into slot i, so recheck it
+    for (size_t i = 0; i < DEVICE_TABLE_CAPACITY;) {
+        device_entry_t *e = &table->slots[i];
+        if (e->used && now_ms - e->last_seen_ms > max_age_ms) {
+            remove_slot(table, i);
+            removed++;
+        } else {
+            i++;
+        }
+    }
+    return removed;
+}
+
+size_t device_table_strongest(const device_table_t *table, const device_entry_t **out, size_t n) {
+    size_t found = 0;
+
+    // Insertion into a short sorted list; n is a handful of lines
+    for (size_t i = 0; i < DEVICE_TABLE_CAPACITY && n > 0; i++) {
+        const device_entry_t *e = &table->slots[i];
+        if (!e->used) {
+            continue;
+        }
+        size_t k;
+        if (found < n) {
+            k = found++;
+        } else if (e->rssi_avg_q4 > out[n - 1]->rssi_avg_q4) {
+            k = n - 1;
+        } else {
+            continue;
+        }
+        while (k > 0 && out[k - 1]->rssi_avg_q4 < e->rssi_avg_q4) {
+            out[k] = out[k - 1];
+            k--;
+        }
+        out[k] = e;
+    }
+    return found;
+}
@@ -0,0 +1,124 @@
+#ifndef DEVICE_TABLE_H
+#define DEVICE_TABLE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ==== Device Table ====
+//
+// Fixed-capacity table of the advertisers seen while scanning, keyed by
+// the 48-bit address. Open addressing with linear probing in a
+// power-of-two array that the caller owns, so nothing is allocated and an
+// update is a hash, a few compares and a store. Lookups stop at the first
+// empty slot; removal shifts the rest of the run back instead of leaving
+// tombstones, so a long-running scan doesn't slow down.
+//
+// Not thread safe: update, expire and iterate from one task (the NimBLE
+// host task in the scanner and the client).
+
+// Slots in the table; must be a power of two
+#ifndef DEVICE_TABLE_CAPACITY
+#define DEVICE_TABLE_CAPACITY 512
+#endif
+
+// New devices are refused above this many entries, keeping probe runs short
+#define DEVICE_TABLE_MAX_ENTRIES (DEVICE_TABLE_CAPACITY * 3 / 4)
+
+// Bytes kept of the advertised name, including the terminator
+#define DEVICE_TABLE_NAME_LEN 16
+
+// RSSI average weight of a new report, as a shift (1/8)
+#define DEVICE_TABLE_RSSI_SHIFT 3
+
+typedef struct {
+    uint8_t addr[6];            // Little endian, as in ble_addr_t
+    uint8_t addr_type;
+    bool used;
+    int8_t rssi_last;
+    int16_t rssi_avg_q4;        // RSSI moving average, dBm * 16
+    uint32_t first_seen_ms;
+    uint32_t last_seen_ms;
+    uint32_t count;             // Reports since the device was added
+    char name[DEVICE_TABLE_NAME_LEN];
+} device_entry_t;
+
+typedef struct {
+    device_entry_t slots[DEVICE_TABLE_CAPACITY];
+    size_t entries;
+    uint32_t reports;           // Reports accepted, including new devices
+    uint32_t dropped;           // Reports of new devices refused while full
+} device_table_t;
+
+/**
+ * @brief Empty the table and its counters
+ * @param table Table to initialize
+ */
+void device_table_init(device_table_t *table);
+
+/**
+ * @brief Record one advertising report
+ *
+ * Adds the device if it is new, then updates its count, last-seen time
+ * and RSSI average.
+ *
+ * @param table Table
+ * @param addr 6-byte device address
+ * @param addr_type Address type of the report
+ * @param rssi RSSI of the report in dBm
+ * @param now_ms Current time in milliseconds (any monotonic origin)
+ * @return The device's entry, or NULL if it is new and the table is full
+ */
+device_entry_t *device_table_update(device_table_t *table, const uint8_t addr[6],
+                                    uint8_t addr_type, int8_t rssi, uint32_t now_ms);
+
+/**
+ * @brief Store a device name
+ * @param entry Entry returned by device_table_update()
+ * @param name Name bytes (not necessarily terminated)
+ * @param len Length of the name; longer names are truncated
+ */
+void device_table_set_name(device_entry_t *entry, const uint8_t *name, size_t len);
+
+/**
+ * @brief Look a device up
+ * @param table Table
+ * @param addr 6-byte device address
+ * @return The entry, or NULL if the device isn't in the table
+ */
+const device_entry_t *device_table_find(const device_table_t *table, const uint8_t addr[6]);
+
+/**
+ * @brief Remove devices not heard from for a while
+ * @param table Table
+ * @param now_ms Current time in milliseconds
+ * @param max_age_ms Devices last seen longer ago than this are removed
+ * @return Number of devices removed
+ */
+size_t device_table_expire(device_table_t *table, uint32_t now_ms, uint32_t max_age_ms);
+
+/**
+ * @brief Find the devices with the strongest average RSSI
+ * @param table Table
+ * @param out Receives up to n entries, strongest first
+ * @param n Size of out
+ * @return Number of entries written
+ */
+size_t device_table_strongest(const device_table_t *table, const device_entry_t **out, size_t n);
+
+/**
+ * @brief RSSI average of an entry in whole dBm
+ */
+static inline int device_entry_rssi(const device_entry_t *entry) {
+    return (entry->rssi_avg_q4 - 8) / 16;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DEVICE_TABLE_H
@@ -0,0 +1,22 @@
+#include "scan_core.h"
+
+device_entry_t *scan_core_report(device_table_t *devices, const adv_report_t *report) {
+    const uint8_t *name;
+    uint8_t name_len;
+
+    device_entry_t *entry = device_table_update(devices, report->addr, report->addr_type,
+                                                report->rssi, report->time_ms);
+    if (entry == NULL || entry->name[0] != '\0') {
+        return entry;
+    }
+
+    // Look for the device's name until it turns up
+    if (adv_data_name(report->data, report->data_len, &name, &name_len)) {
+        device_table_set_name(entry, name, name_len);
+    }
+    return entry;
+}
+
+size_t scan_core_expire(device_table_t *devices, uint32_t now_ms) {
+    return device_table_expire(devices, now_ms, SCAN_CORE_MAX_AGE_MS);
+}
@@ -0,0 +1,42 @@
+#ifndef SCAN_CORE_H
+#define SCAN_CORE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "device_table.h"
+#include "adv_data.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ==== Scanner Core ====
+//
+// What BLEScanner does with each discovery report, without NimBLE, so
+// Scanner_Trace_Replay runs the same code over recorded traces. A report
+// updates the device's entry and the payload is searched for a name until
+// the device has one.
+
+#define SCAN_CORE_MAX_AGE_MS 60000   // Forget devices silent for this long
+
+/**
+ * @brief Handle a discovery report
+ * @param devices Device table
+ * @param report Report from the GAP event or a trace
+ * @return The device's entry, NULL if the table is full
+ */
+device_entry_t *scan_core_report(device_table_t *devices, const adv_report_t *report);
+
+/**
+ * @brief Forget devices not heard for SCAN_CORE_MAX_AGE_MS
+ * @param devices Device table
+ * @param now_ms Current time
+ * @return Number of devices forgotten
+ */
+size_t scan_core_expire(device_table_t *devices, uint32_t now_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SCAN_CORE_H
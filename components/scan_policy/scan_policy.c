@@ -0,0 +1,88 @@
+#include "scan_policy.h"
+#include <string.h>
+
+// ==== Fixed Policy ====
+static void fixed_reset(void *ctx, uint32_t now_ms) {
+}
+
+static void fixed_decide(void *ctx, const scan_observation_t *obs, scan_params_t *params) {
+    *params = *(const scan_params_t *)ctx;
+}
+
+void scan_policy_fixed_init(scan_policy_t *policy, scan_params_t *state, uint16_t itvl,
+                            uint16_t window) {
+    *state = (scan_params_t) {
+        .enabled = true,
+        .itvl = itvl,
+        .window = window,
+    };
+    *policy = (scan_policy_t) {
+        .name = "fixed",
+        .reset = fixed_reset,
+        .decide = fixed_decide,
+        .ctx = state,
+    };
+}
+
+// ==== Adaptive Policy ====
+static void adaptive_reset(void *ctx, uint32_t now_ms) {
+    scan_adaptive_t *s = (scan_adaptive_t *)ctx;
+    s->hunt_start_ms = now_ms;
+}
+
+// A surge of traffic restarts the hunt; the average then follows it
+static void adaptive_track_rate(scan_adaptive_t *s, const scan_observation_t *obs) {
+    const scan_adaptive_config_t *c = &s->config;
+
+    if (obs->listen_ms == 0) {
+        return;
+    }
+    uint32_t rate = (uint64_t)obs->reports * 1000 / obs->listen_ms;
+
+    if (!s->rate_valid) {
+        s->rate_avg = rate;
+        s->rate_valid = true;
+        return;
+    }
+    if (rate >= s->rate_avg + c->surge_min_rps &&
+        (uint64_t)rate * 100 >= (uint64_t)s->rate_avg * c->surge_pct) {
+        s->hunt_start_ms = obs->now_ms;
+    }
+    s->rate_avg += ((int32_t)rate - (int32_t)s->rate_avg) / 8;
+}
+
+static void adaptive_decide(void *ctx, const scan_observation_t *obs, scan_params_t *params) {
+    scan_adaptive_t *s = (scan_adaptive_t *)ctx;
+    const scan_adaptive_config_t *c = &s->config;
+
+    adaptive_track_rate(s, obs);
+
+    // Full duty while hunting, then the interval doubles each step
+    uint32_t elapsed = obs->now_ms - s->hunt_start_ms;
+    uint32_t itvl = c->window;
+    if (elapsed >= c->hunt_ms) {
+        uint32_t steps = (elapsed - c->hunt_ms) / c->backoff_step_ms + 1;
+        itvl = (steps < 16) ? (uint32_t)c->window << steps : c->max_itvl;
+        if (itvl > c->max_itvl) {
+            itvl = c->max_itvl;
+        }
+    }
+
+    *params = (scan_params_t) {
+        .enabled = true,
+        .itvl = itvl,
+        .window = c->window,
+    };
+}
+
+void scan_policy_adaptive_init(scan_policy_t *policy, scan_adaptive_t *state,
+                               const scan_adaptive_config_t *config) {
+    memset(state, 0, sizeof(*state));
+    state->config = *config;
+    *policy = (scan_policy_t) {
+        .name = "adaptive",
+        .reset = adaptive_reset,
+        .decide = adaptive_decide,
+        .ctx = state,
+    };
+}
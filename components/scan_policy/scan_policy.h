@@ -0,0 +1,143 @@
+#ifndef SCAN_POLICY_H
+#define SCAN_POLICY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ==== Scan Policy ====
+//
+// Decides the scan interval and window from what the scanner has seen.
+// The owner calls reset() whenever the target goes missing and a search
+// starts, then decide() periodically with an observation (reports heard,
+// time spent listening) and restarts the scan when the parameters change.
+// Once the target is found the owner stops scanning and stops asking.
+// Policies are a pair of functions and a state block, so the client and
+// the host simulation run the same code and a new policy needs no changes
+// to either.
+//
+// Intervals and windows are in 0.625 ms units, as in
+// struct ble_gap_disc_params.
+
+#define SCAN_UNITS_TO_US(units) ((uint32_t)(units) * 625)
+
+typedef struct {
+    bool enabled;               // false: don't scan at all
+    uint16_t itvl;
+    uint16_t window;
+} scan_params_t;
+
+typedef struct {
+    uint32_t now_ms;
+    uint32_t reports;           // Reports since the last decision
+    uint32_t listen_ms;         // Time the radio listened since then
+} scan_observation_t;
+
+typedef struct {
+    const char *name;
+    // Start of a new search for the target
+    void (*reset)(void *ctx, uint32_t now_ms);
+    void (*decide)(void *ctx, const scan_observation_t *obs, scan_params_t *params);
+    void *ctx;
+} scan_policy_t;
+
+/**
+ * @brief Listening time of a scan that ran for a while
+ * @param params Scan parameters
+ * @param elapsed_ms Time the scan ran
+ * @return Time spent inside scan windows, in ms
+ */
+static inline uint32_t scan_params_listen_ms(const scan_params_t *params, uint32_t elapsed_ms) {
+    if (!params->enabled || params->itvl == 0) {
+        return 0;
+    }
+    return (uint64_t)elapsed_ms * params->window / params->itvl;
+}
+
+// ==== Fixed Policy ====
+// Always the same parameters; the old fixed 50% duty is 0x60/0x30
+
+/**
+ * @brief Set up a policy that never changes the parameters
+ * @param policy Policy to fill in
+ * @param state Storage for the parameters, kept by the caller
+ * @param itvl Scan interval
+ * @param window Scan window
+ */
+void scan_policy_fixed_init(scan_policy_t *policy, scan_params_t *state, uint16_t itvl,
+                            uint16_t window);
+
+// ==== Adaptive Policy ====
+//
+// Hunts at full duty (window = interval) for hunt_ms after the search
+// starts. Then the window stays the same and the interval doubles every
+// backoff_step_ms, up to max_itvl.
+//
+// A window at least as long as the target's advertising interval always
+// holds one of its packets, so once backed off the target is still found
+// within about max_itvl. Shorter windows alias with the advertising
+// interval and can miss it for many intervals.
+//
+// A burst of new traffic usually means people arriving, and with them
+// the rider. When the arrival rate per second of listening goes above
+// surge_pct of its average, by at least surge_min_rps, the hunt starts
+// again.
+
+typedef struct {
+    uint32_t hunt_ms;
+    uint16_t window;
+    uint16_t max_itvl;
+    uint32_t backoff_step_ms;
+    uint16_t surge_pct;
+    uint16_t surge_min_rps;
+} scan_adaptive_config_t;
+
+// 30 s hunt, then a 112.5 ms window (the helmet advertises every 100 ms
+// plus up to 10 ms of random delay) backing off every 20 s to a 900 ms
+// interval (12.5% duty), so detection takes under a second; hunt again
+// on three times the usual traffic
+#define SCAN_ADAPTIVE_DEFAULT_CONFIG {  \
+    .hunt_ms = 30000,                   \
+    .window = 0xB4,                     \
+    .max_itvl = 0x5A0,                  \
+    .backoff_step_ms = 20000,           \
+    .surge_pct = 300,                   \
+    .surge_min_rps = 10,                \
+}
+
+// Opt-in deep back-off for when battery matters more than latency: a
+// 30 ms window at a 1.28 s interval (2.3% duty). Without an arrival cue
+// detection then takes seconds, up to 16 s in the bench simulation.
+#define SCAN_ADAPTIVE_DEEP_CONFIG {     \
+    .hunt_ms = 30000,                   \
+    .window = 0x30,                     \
+    .max_itvl = 0x800,                  \
+    .backoff_step_ms = 20000,           \
+    .surge_pct = 300,                   \
+    .surge_min_rps = 10,                \
+}
+
+typedef struct {
+    scan_adaptive_config_t config;
+    uint32_t hunt_start_ms;
+    uint32_t rate_avg;          // Reports per second of listening, average
+    bool rate_valid;
+} scan_adaptive_t;
+
+/**
+ * @brief Set up the adaptive policy
+ * @param policy Policy to fill in
+ * @param state Policy state, kept by the caller
+ * @param config Tuning; copied
+ */
+void scan_policy_adaptive_init(scan_policy_t *policy, scan_adaptive_t *state,
+                               const scan_adaptive_config_t *config);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SCAN_POLICY_H